@@ -52,6 +52,7 @@
  */
 #include "comdef.h"
 #include "OSAL.h"
+#include "hal_assert.h"
 
 #include "gatt.h"
 #include "gatt_uuid.h"
@@ -64,10 +65,28 @@
  * CONSTANTS
  */
 
+// Position of the 16-bit offset in a 128-bit UUID, as in TI_BASE_UUID_128()
+#define GATT_UUID_OFFSET_POS       12
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// 16-bit UUID record
+typedef struct
+{
+  uint16 uuid;        // 16-bit UUID
+  const uint8 *pRec;  // UUID record
+} gattUUIDRec_t;
+
+// Registered 128-bit UUID record, as its base and 16-bit offset
+typedef struct
+{
+  uint8 base;         // Index of the base in gattUUIDBase[]
+  uint16 uuid;        // Bytes 12 and 13 of the UUID
+  const uint8 *pRec;  // UUID record, NULL if registered more than once
+} gattUUID128Rec_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -218,9 +237,56 @@ CONST uint8 reportRefUUID[ATT_BT_UUID_SIZE] =
  * LOCAL VARIABLES
  */
 
+// 16-bit UUID records, sorted by UUID for the binary search in
+// GATT_FindUUIDRec(); keep them in order when adding one
+static CONST gattUUIDRec_t gattUUIDTbl[] =
+{
+  /*** GATT Services ***/
+  { GAP_SERVICE_UUID,            gapServiceUUID },       // 0x1800
+  { GATT_SERVICE_UUID,           gattServiceUUID },      // 0x1801
+
+  /*** GATT Declarations ***/
+  { GATT_PRIMARY_SERVICE_UUID,   primaryServiceUUID },   // 0x2800
+  { GATT_SECONDARY_SERVICE_UUID, secondaryServiceUUID }, // 0x2801
+  { GATT_INCLUDE_UUID,           includeUUID },          // 0x2802
+  { GATT_CHARACTER_UUID,         characterUUID },        // 0x2803
+
+  /*** GATT Descriptors ***/
+  { GATT_CHAR_EXT_PROPS_UUID,    charExtPropsUUID },     // 0x2900
+  { GATT_CHAR_USER_DESC_UUID,    charUserDescUUID },     // 0x2901
+  { GATT_CLIENT_CHAR_CFG_UUID,   clientCharCfgUUID },    // 0x2902
+  { GATT_SERV_CHAR_CFG_UUID,     servCharCfgUUID },      // 0x2903
+  { GATT_CHAR_FORMAT_UUID,       charFormatUUID },       // 0x2904
+  { GATT_CHAR_AGG_FORMAT_UUID,   charAggFormatUUID },    // 0x2905
+  { GATT_VALID_RANGE_UUID,       validRangeUUID },       // 0x2906
+  { GATT_EXT_REPORT_REF_UUID,    extReportRefUUID },     // 0x2907
+  { GATT_REPORT_REF_UUID,        reportRefUUID },        // 0x2908
+
+  /*** GATT Characteristics ***/
+  { DEVICE_NAME_UUID,            deviceNameUUID },       // 0x2A00
+  { APPEARANCE_UUID,             appearanceUUID },       // 0x2A01
+  { PERI_PRIVACY_FLAG_UUID,      periPrivacyFlagUUID },  // 0x2A02
+  { RECONNECT_ADDR_UUID,         reconnectAddrUUID },    // 0x2A03
+  { PERI_CONN_PARAM_UUID,        periConnParamUUID },    // 0x2A04
+  { SERVICE_CHANGED_UUID,        serviceChangedUUID }    // 0x2A05
+};
+
+#define GATT_UUID_TBL_SIZE         ( sizeof( gattUUIDTbl ) / sizeof( gattUUIDRec_t ) )
+
+// Registered 128-bit UUID bases; the first record registered with a base
+// stands for it, its bytes 12 and 13 ignored
+static const uint8 *gattUUIDBase[GATT_UUID_MAX_BASES];
+static uint8 gattUUIDNumBases = 0;
+
+// Registered 128-bit UUID records, sorted by base and 16-bit offset
+static gattUUID128Rec_t gattUUID128Tbl[GATT_UUID_MAX_RECS];
+static uint8 gattUUID128Num = 0;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
+static uint8 gattFindUUIDBase( const uint8 *pUUID );
+static uint8 gattFindUUID128( uint8 base, uint16 uuid );
 
 /*********************************************************************
  * API FUNCTIONS
@@ -229,7 +295,9 @@ CONST uint8 reportRefUUID[ATT_BT_UUID_SIZE] =
 /*********************************************************************
  * @fn      GATT_FindUUIDRec
  *
- * @brief   Find the UUID record for a given UUID.
+ * @brief   Find the UUID record for a given UUID: a binary search of
+ *          the 16-bit records, or of the registered 128-bit records
+ *          once the UUID is reduced to its base and 16-bit offset.
  *
  * @param   pUUID - UUID to look for.
  * @param   len - length of UUID.
@@ -238,118 +306,253 @@ CONST uint8 reportRefUUID[ATT_BT_UUID_SIZE] =
  */
 const uint8 *GATT_FindUUIDRec( const uint8 *pUUID, uint8 len )
 {
-  const uint8 *pRec = NULL;
+#if !defined HALNODEBUG
+  static uint8 gattUUIDTblChecked = FALSE;
+
+  // The binary search misses records once the table is out of order
+  if ( !gattUUIDTblChecked )
+  {
+    uint8 i;
+
+    for ( i = 1; i < GATT_UUID_TBL_SIZE; i++ )
+    {
+      HAL_ASSERT( gattUUIDTbl[i-1].uuid < gattUUIDTbl[i].uuid );
+    }
+
+    gattUUIDTblChecked = TRUE;
+  }
+#endif
 
   if ( len == ATT_BT_UUID_SIZE )
   {
     // 16-bit UUID
     uint16 uuid = BUILD_UINT16( pUUID[0], pUUID[1] );
-    switch ( uuid )
+    uint8 lo = 0;
+    uint8 hi = GATT_UUID_TBL_SIZE;
+
+    while ( lo < hi )
     {
-      /*** GATT Services ***/
+      uint8 mid = ( lo + hi ) / 2;
+
+      if ( gattUUIDTbl[mid].uuid < uuid )
+      {
+        lo = mid + 1;
+      }
+      else if ( gattUUIDTbl[mid].uuid > uuid )
+      {
+        hi = mid;
+      }
+      else
+      {
+        return ( gattUUIDTbl[mid].pRec );
+      }
+    }
+  }
+  else if ( len == ATT_UUID_SIZE )
+  {
+    // 128-bit UUID
+    uint8 base = gattFindUUIDBase( pUUID );
 
-      case GAP_SERVICE_UUID:
-        pRec = gapServiceUUID;
-        break;
+    if ( base != GATT_UUID_BASE_INVALID )
+    {
+      uint16 uuid = BUILD_UINT16( pUUID[GATT_UUID_OFFSET_POS],
+                                  pUUID[GATT_UUID_OFFSET_POS+1] );
+      uint8 i = gattFindUUID128( base, uuid );
+
+      if ( ( i < gattUUID128Num ) &&
+           ( gattUUID128Tbl[i].base == base ) && ( gattUUID128Tbl[i].uuid == uuid ) )
+      {
+        return ( gattUUID128Tbl[i].pRec );
+      }
+    }
+  }
 
-      case GATT_SERVICE_UUID:
-        pRec = gattServiceUUID;
-        break;
+  return ( NULL );
+}
 
-      /*** GATT Declarations ***/
+/*********************************************************************
+ * @fn      GATT_RegisterUUIDBase
+ *
+ * @brief   Register the base of a 128-bit UUID, that is the UUID with
+ *          its bytes 12 and 13 ignored, as TI_BASE_UUID_128() does
+ *          with its 16-bit argument.
+ *
+ * @param   pUUID - 128-bit UUID record; it must stay in place.
+ *
+ * @return  Index of the base. GATT_UUID_BASE_INVALID if all
+ *          GATT_UUID_MAX_BASES are taken by other bases.
+ */
+uint8 GATT_RegisterUUIDBase( const uint8 *pUUID )
+{
+  uint8 base = gattFindUUIDBase( pUUID );
 
-      case GATT_PRIMARY_SERVICE_UUID:
-        pRec = primaryServiceUUID;
-        break;
+  if ( ( base == GATT_UUID_BASE_INVALID ) && ( gattUUIDNumBases < GATT_UUID_MAX_BASES ) )
+  {
+    base = gattUUIDNumBases++;
+    gattUUIDBase[base] = pUUID;
+  }
 
-      case GATT_SECONDARY_SERVICE_UUID:
-        pRec = secondaryServiceUUID;
-        break;
+  return ( base );
+}
 
-      case GATT_INCLUDE_UUID:
-        pRec = includeUUID;
-        break;
+/*********************************************************************
+ * @fn      GATT_RegisterUUIDRec
+ *
+ * @brief   Register a 128-bit UUID record for GATT_FindUUIDRec() to
+ *          return, registering its base as well. A UUID registered
+ *          again with another record is no longer resolved, so that
+ *          neither record is taken for the other.
+ *
+ * @param   pUUID - 128-bit UUID record; it must stay in place.
+ *
+ * @return  SUCCESS: Record registered, or registered already.
+ *          bleNoResources: No room for the record or its base.
+ *          bleAlreadyInRequestedMode: Another record has the UUID.
+ */
+bStatus_t GATT_RegisterUUIDRec( const uint8 *pUUID )
+{
+  uint16 uuid = BUILD_UINT16( pUUID[GATT_UUID_OFFSET_POS], pUUID[GATT_UUID_OFFSET_POS+1] );
+  uint8 base;
+  uint8 i;
+  uint8 j;
 
-      case GATT_CHARACTER_UUID:
-        pRec = characterUUID;
-        break;
+  base = GATT_RegisterUUIDBase( pUUID );
+  if ( base == GATT_UUID_BASE_INVALID )
+  {
+    return ( bleNoResources );
+  }
 
-      /*** GATT Descriptors ***/
+  i = gattFindUUID128( base, uuid );
+  if ( ( i < gattUUID128Num ) &&
+       ( gattUUID128Tbl[i].base == base ) && ( gattUUID128Tbl[i].uuid == uuid ) )
+  {
+    if ( gattUUID128Tbl[i].pRec != pUUID )
+    {
+      gattUUID128Tbl[i].pRec = NULL;
 
-      case GATT_CHAR_EXT_PROPS_UUID:
-        pRec = charExtPropsUUID;
-        break;
+      return ( bleAlreadyInRequestedMode );
+    }
 
-      case GATT_CHAR_USER_DESC_UUID:
-        pRec = charUserDescUUID;
-        break;
+    return ( SUCCESS );
+  }
 
-      case GATT_CLIENT_CHAR_CFG_UUID:
-        pRec = clientCharCfgUUID;
-        break;
+  if ( gattUUID128Num == GATT_UUID_MAX_RECS )
+  {
+    return ( bleNoResources );
+  }
 
-      case GATT_SERV_CHAR_CFG_UUID:
-        pRec = servCharCfgUUID;
-        break;
+  // Insert in order
+  for ( j = gattUUID128Num; j > i; j-- )
+  {
+    gattUUID128Tbl[j] = gattUUID128Tbl[j-1];
+  }
 
-      case GATT_CHAR_FORMAT_UUID:
-        pRec = charFormatUUID;
-        break;
+  gattUUID128Tbl[i].base = base;
+  gattUUID128Tbl[i].uuid = uuid;
+  gattUUID128Tbl[i].pRec = pUUID;
+  gattUUID128Num++;
 
-      case GATT_CHAR_AGG_FORMAT_UUID:
-        pRec = charAggFormatUUID;
-        break;
+  return ( SUCCESS );
+}
 
-      case GATT_VALID_RANGE_UUID:
-        pRec = validRangeUUID;
-        break;
+/*********************************************************************
+ * @fn      GATT_RegisterUUIDRecs
+ *
+ * @brief   Register the 128-bit attribute types of a service attribute
+ *          table with GATT_RegisterUUIDRec(), so that read by type and
+ *          find information requests resolve them like 16-bit ones.
+ *          The services ignore the status, so a failure asserts: raise
+ *          GATT_UUID_MAX_RECS or GATT_UUID_MAX_BASES for the services
+ *          built.
+ *
+ * @param   pAttrTbl - pointer to attribute table
+ * @param   numAttrs - number of attributes in attribute table
+ *
+ * @return  SUCCESS, or the first failure of GATT_RegisterUUIDRec().
+ */
+bStatus_t GATT_RegisterUUIDRecs( gattAttribute_t *pAttrTbl, uint16 numAttrs )
+{
+  bStatus_t status = SUCCESS;
+  uint16 i;
 
-      case GATT_EXT_REPORT_REF_UUID:
-        pRec = extReportRefUUID;
-        break;
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    if ( pAttrTbl[i].type.len == ATT_UUID_SIZE )
+    {
+      bStatus_t ret = GATT_RegisterUUIDRec( pAttrTbl[i].type.uuid );
 
-      case GATT_REPORT_REF_UUID:
-        pRec = reportRefUUID;
-        break;
+      if ( status == SUCCESS )
+      {
+        status = ret;
+      }
+    }
+  }
 
-      /*** GATT Characteristics ***/
+  HAL_ASSERT( status == SUCCESS );
 
-      case DEVICE_NAME_UUID:
-        pRec = deviceNameUUID;
-        break;
+  return ( status );
+}
 
-      case APPEARANCE_UUID:
-        pRec = appearanceUUID;
-        break;
+/*********************************************************************
+ * @fn      gattFindUUIDBase
+ *
+ * @brief   Find the registered base of a 128-bit UUID.
+ *
+ * @param   pUUID - 128-bit UUID.
+ *
+ * @return  Index of the base. GATT_UUID_BASE_INVALID, otherwise.
+ */
+static uint8 gattFindUUIDBase( const uint8 *pUUID )
+{
+  uint8 i;
 
-      case RECONNECT_ADDR_UUID:
-        pRec = reconnectAddrUUID;
-        break;
+  for ( i = 0; i < gattUUIDNumBases; i++ )
+  {
+    const uint8 *pBase = gattUUIDBase[i];
 
-      case PERI_PRIVACY_FLAG_UUID:
-        pRec = periPrivacyFlagUUID;
-        break;
+    if ( ( pUUID[GATT_UUID_OFFSET_POS+2] == pBase[GATT_UUID_OFFSET_POS+2] ) &&
+         ( pUUID[GATT_UUID_OFFSET_POS+3] == pBase[GATT_UUID_OFFSET_POS+3] ) &&
+         osal_memcmp( pUUID, pBase, GATT_UUID_OFFSET_POS ) )
+    {
+      return ( i );
+    }
+  }
 
-      case PERI_CONN_PARAM_UUID:
-        pRec = periConnParamUUID;
-        break;
+  return ( GATT_UUID_BASE_INVALID );
+}
 
-      case SERVICE_CHANGED_UUID:
-        pRec = serviceChangedUUID;
-        break;
+/*********************************************************************
+ * @fn      gattFindUUID128
+ *
+ * @brief   Binary search of the registered 128-bit UUID records.
+ *
+ * @param   base - index of the base.
+ * @param   uuid - 16-bit offset.
+ *
+ * @return  Index of the first record not ordered before the UUID,
+ *          gattUUID128Num if there is none.
+ */
+static uint8 gattFindUUID128( uint8 base, uint16 uuid )
+{
+  uint8 lo = 0;
+  uint8 hi = gattUUID128Num;
 
-      /*** GATT Units ***/
+  while ( lo < hi )
+  {
+    uint8 mid = ( lo + hi ) / 2;
 
-      default:
-        break;
+    if ( ( gattUUID128Tbl[mid].base < base ) ||
+         ( ( gattUUID128Tbl[mid].base == base ) && ( gattUUID128Tbl[mid].uuid < uuid ) ) )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
     }
-  }
-  else if ( len == ATT_UUID_SIZE )
-  {
-    // 128-bit UUID
   }
 
-  return ( pRec );
+  return ( lo );
 }
 
 /****************************************************************************
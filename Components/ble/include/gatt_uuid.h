@@ -57,6 +57,7 @@ extern "C"
 /*********************************************************************
  * INCLUDES
  */
+#include "gatt.h"
 
 /*********************************************************************
  * CONSTANTS
@@ -105,6 +106,43 @@ extern "C"
 #define PERI_CONN_PARAM_UUID                       0x2A04 // Peripheral Preferred Connection Parameters
 #define SERVICE_CHANGED_UUID                       0x2A05 // Service Changed
 
+/**
+ * 128-bit UUID registry
+ */
+// Bases of 128-bit UUIDs GATT_FindUUIDRec() resolves, such as the TI base
+#if !defined GATT_UUID_MAX_BASES
+  #define GATT_UUID_MAX_BASES                      2
+#endif
+
+// 128-bit UUID records GATT_FindUUIDRec() resolves: the attribute types
+// of the services built that register theirs, that is the SensorTag and
+// test services with GATT_TI_UUID_128_BIT (24) and OAD (2), plus
+// GATT_UUID_APP_RECS for the application
+#if !defined GATT_UUID_APP_RECS
+  #define GATT_UUID_APP_RECS                       4
+#endif
+
+#if !defined GATT_UUID_MAX_RECS
+  #if defined GATT_TI_UUID_128_BIT
+    #define GATT_UUID_SENSOR_RECS                  24
+  #else
+    #define GATT_UUID_SENSOR_RECS                  0
+  #endif
+
+  #if defined FEATURE_OAD
+    #define GATT_UUID_OAD_RECS                     2
+  #else
+    #define GATT_UUID_OAD_RECS                     0
+  #endif
+
+  #define GATT_UUID_MAX_RECS                       ( GATT_UUID_SENSOR_RECS + \
+                                                     GATT_UUID_OAD_RECS + \
+                                                     GATT_UUID_APP_RECS )
+#endif
+
+// Returned by GATT_RegisterUUIDBase() when there is no room for the base
+#define GATT_UUID_BASE_INVALID                     0xFF
+
 /*********************************************************************
  * MACROS
  */
@@ -162,6 +200,21 @@ extern CONST uint8 manuAddrUUID[];
  */
 extern const uint8 *GATT_FindUUIDRec( const uint8 *pUUID, uint8 len );
 
+/*
+ * Register a 128-bit UUID base, returning its index.
+ */
+extern uint8 GATT_RegisterUUIDBase( const uint8 *pUUID );
+
+/*
+ * Register a 128-bit UUID record for GATT_FindUUIDRec().
+ */
+extern bStatus_t GATT_RegisterUUIDRec( const uint8 *pUUID );
+
+/*
+ * Register the 128-bit attribute types of a service attribute table.
+ */
+extern bStatus_t GATT_RegisterUUIDRecs( gattAttribute_t *pAttrTbl, uint16 numAttrs );
+
 /*********************************************************************
 *********************************************************************/
 
@@ -82,6 +82,27 @@ extern "C"
  */
 void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt);
 
+/**************************************************************************************************
+ * @fn          HalFlashCompare
+ *
+ * @brief       This function compares 'cnt' bytes of the internal flash with a buffer.
+ *
+ * input parameters
+ *
+ * @param       pg - Valid HAL flash page number (ie < 128).
+ * @param       offset - Valid offset into the page (so < HAL_NV_PAGE_SIZE and byte-aligned is ok).
+ * @param       buf - Valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - Valid number of bytes to compare: a compare cannot cross into the next 32KB bank.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the flash holds the same 'cnt' bytes as the buffer, FALSE otherwise.
+ **************************************************************************************************
+ */
+uint8 HalFlashCompare(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt);
+
 /**************************************************************************************************
  * @fn          HalFlashWrite
  *
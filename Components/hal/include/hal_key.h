@@ -83,6 +83,11 @@ extern "C"
 #define HAL_KEY_SW_6 0x20  // Button S1 if available
 #define HAL_KEY_SW_7 0x40  // Button S2 if available
 
+/* Mailbox switches, set while open (HAL_KEY_MAIL_SENSOR boards) */
+#define HAL_KEY_MAIL_LID  0x40  // Mail slot lid, in place of S2
+#define HAL_KEY_MAIL_DOOR 0x80  // Mailbox door
+#define HAL_KEY_MAIL      (HAL_KEY_MAIL_LID | HAL_KEY_MAIL_DOOR)
+
 /* Joystick */
 #define HAL_KEY_UP     0x01  // Joystick up
 #define HAL_KEY_RIGHT  0x02  // Joystick right
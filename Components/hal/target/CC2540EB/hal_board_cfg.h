@@ -149,6 +149,20 @@ extern "C"
 #define PUSH2_SBIT                     P2_0
 #define PUSH2_POLARITY                 ACTIVE_HIGH
 
+/* Mailbox lid and door switches, reported as keys when HAL_KEY_MAIL_SENSOR
+ * is TRUE. Both read low while open. They sit in different Port 1 edge
+ * groups (P1.0-3 and P1.4-7) so that each can be armed for its next edge.
+ * P1.2 and P1.7 are also the LCD chip select and MISO, so the switches
+ * cannot be built with HAL_LCD.
+ */
+#define MAIL_LID_BV                    BV(2)
+#define MAIL_LID_SBIT                  P1_2
+#define MAIL_LID_EDGEBIT               BV(1)   /* PICTL.P1ICONL */
+
+#define MAIL_DOOR_BV                   BV(7)
+#define MAIL_DOOR_SBIT                 P1_7
+#define MAIL_DOOR_EDGEBIT              BV(2)   /* PICTL.P1ICONH */
+
 /* OSAL NV implemented by internal flash pages. */
 
 // Flash is partitioned into 8 banks of 32 KB or 16 pages.
@@ -413,6 +427,11 @@ st( \
 #define HAL_KEY TRUE
 #endif
 
+/* Set to TRUE to report the mailbox switches as keys, FALSE disable it */
+#ifndef HAL_KEY_MAIL_SENSOR
+#define HAL_KEY_MAIL_SENSOR FALSE
+#endif
+
 /* Set to TRUE enable UART usage, FALSE disable it */
 #ifndef HAL_UART
 #if (defined ZAPP_P1) || (defined ZAPP_P2) || (defined ZTOOL_P1) || (defined ZTOOL_P2)
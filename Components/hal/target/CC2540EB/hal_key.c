@@ -104,7 +104,10 @@
 #define HAL_KEY_RISING_EDGE   0
 #define HAL_KEY_FALLING_EDGE  1
 
+/* Time the keys must be quiet after an interrupt before they are read (ms) */
+#if !defined HAL_KEY_DEBOUNCE_VALUE
 #define HAL_KEY_DEBOUNCE_VALUE  25
+#endif
 
 /* CPU port interrupt */
 #define HAL_KEY_CPU_PORT_0_IF P0IF
@@ -177,6 +180,31 @@
 
 #endif
 
+#if HAL_KEY_MAIL_SENSOR
+/* Mailbox lid and door switches on Port 1, see hal_board_cfg.h. Each is
+ * armed for the edge away from its current level, so opening and closing
+ * both interrupt.
+ */
+#define HAL_KEY_MAIL_BITS     (MAIL_LID_BV | MAIL_DOOR_BV)
+#define HAL_KEY_MAIL_SEL      P1SEL
+#define HAL_KEY_MAIL_DIR      P1DIR
+
+#define HAL_KEY_MAIL_IEN      IEN2  /* CPU interrupt mask register */
+#define HAL_KEY_MAIL_IENBIT   BV(4) /* Mask bit for all of Port_1 */
+#define HAL_KEY_MAIL_ICTL     P1IEN /* Port Interrupt Control register */
+#define HAL_KEY_MAIL_PXIFG    P1IFG /* Interrupt flag at source */
+
+#define HAL_KEY_CPU_PORT_1_IF P1IF
+
+#if (HAL_UART_DMA == 2) || (HAL_UART_ISR == 2) || (HAL_UART_SPI == 2)
+#error "HAL_KEY_MAIL_SENSOR needs the Port 1 interrupt used by the UART on port 1"
+#endif
+
+#if (defined HAL_LCD) && (HAL_LCD == TRUE)
+#error "HAL_KEY_MAIL_SENSOR needs P1.2 and P1.7, the LCD chip select and MISO"
+#endif
+#endif
+
 /**************************************************************************************************
  *                                            TYPEDEFS
  **************************************************************************************************/
@@ -195,6 +223,10 @@ bool Hal_KeyIntEnable;            /* interrupt enable/disable flag */
  **************************************************************************************************/
 void halProcessKeyInterrupt(void);
 uint8 halGetJoyKeyInput(void);
+#if HAL_KEY_MAIL_SENSOR
+static uint8 halKeyMailRead(void);
+static void halKeyMailArm(uint8 keys);
+#endif
 
 
 
@@ -230,6 +262,11 @@ void HalKeyInit( void )
   P2INP |= PUSH2_BV;  /* Configure GPIO tri-state. */
 #endif
 
+#if HAL_KEY_MAIL_SENSOR
+  HAL_KEY_MAIL_SEL &= ~(HAL_KEY_MAIL_BITS);   /* Set pin function to GPIO */
+  HAL_KEY_MAIL_DIR &= ~(HAL_KEY_MAIL_BITS);   /* Set pin direction to Input */
+#endif
+
   /* Initialize callback function */
   pHalKeyProcessFunction  = NULL;
 
@@ -307,6 +344,12 @@ void HalKeyConfig (bool interruptEnable, halKeyCBack_t cback)
     HAL_KEY_JOY_MOVE_PXIFG = ~(HAL_KEY_JOY_MOVE_BIT);
 #endif // !CC2540_MINIDK
 
+#if HAL_KEY_MAIL_SENSOR
+    halKeyMailArm(halKeyMailRead());
+    HAL_KEY_MAIL_ICTL |= HAL_KEY_MAIL_BITS;
+    HAL_KEY_MAIL_IEN |= HAL_KEY_MAIL_IENBIT;
+#endif
+
     /* Do this only after the hal_key is configured - to work with sleep stuff */
     if (HalKeyConfigured == TRUE)
     {
@@ -322,6 +365,9 @@ void HalKeyConfig (bool interruptEnable, halKeyCBack_t cback)
     HAL_KEY_SW_6_ICTL &= ~(HAL_KEY_SW_6_ICTLBIT); /* don't generate interrupt */
     HAL_KEY_SW_6_IEN &= ~(HAL_KEY_SW_6_IENBIT);   /* Clear interrupt enable bit */
 #endif  // !CC2540_MINIDK
+#if HAL_KEY_MAIL_SENSOR
+    HAL_KEY_MAIL_ICTL &= ~(HAL_KEY_MAIL_BITS);     /* don't generate interrupt */
+#endif
 
     osal_set_event(Hal_TaskID, HAL_KEY_EVENT);
   }
@@ -367,6 +413,9 @@ uint8 HalKeyRead ( void )
   {
     keys |= halGetJoyKeyInput();
   }
+#endif
+#if HAL_KEY_MAIL_SENSOR
+  keys |= halKeyMailRead();
 #endif
   return keys;
 }
@@ -405,6 +454,9 @@ void HalKeyPoll (void)
     keys = halGetJoyKeyInput();
   }
 #endif
+#if HAL_KEY_MAIL_SENSOR
+  keys |= halKeyMailRead();
+#endif
 
   /* If interrupts are not enabled, previous key status and current key status
    * are compared to find out if a key has changed status.
@@ -423,11 +475,15 @@ void HalKeyPoll (void)
   }
   else
   {
-    /* Key interrupt handled here */
-    if (keys)
+    /* Key interrupt handled here; the mailbox switches report both edges */
+    if ((keys & ~HAL_KEY_MAIL) || ((keys ^ halKeySavedKeys) & HAL_KEY_MAIL))
     {
       notify = 1;
     }
+
+#if HAL_KEY_MAIL_SENSOR
+    halKeyMailArm(keys & HAL_KEY_MAIL);
+#endif
   }
 
   /* Store the current keys for comparation next time */
@@ -493,6 +549,66 @@ uint8 halGetJoyKeyInput(void)
 }
 #endif
 
+#if HAL_KEY_MAIL_SENSOR
+/**************************************************************************************************
+ * @fn      halKeyMailRead
+ *
+ * @brief   Read the mailbox switches.
+ *
+ * @param   None
+ *
+ * @return  keys - HAL_KEY_MAIL_LID and/or HAL_KEY_MAIL_DOOR if open
+ **************************************************************************************************/
+static uint8 halKeyMailRead(void)
+{
+  uint8 keys = 0;
+
+  if (!MAIL_LID_SBIT)     /* Switch is low while open */
+  {
+    keys |= HAL_KEY_MAIL_LID;
+  }
+  if (!MAIL_DOOR_SBIT)    /* Switch is low while open */
+  {
+    keys |= HAL_KEY_MAIL_DOOR;
+  }
+
+  return keys;
+}
+
+/**************************************************************************************************
+ * @fn      halKeyMailArm
+ *
+ * @brief   Arm each mailbox switch for the edge away from the state just reported: rising while
+ *          open, falling while closed. A switch that moved before it was armed would not
+ *          interrupt, so it is debounced and read again instead.
+ *
+ * @param   keys - mailbox switches reported open
+ *
+ * @return  None
+ **************************************************************************************************/
+static void halKeyMailArm(uint8 keys)
+{
+  /* For falling edge, the bit must be set. */
+  PICTL &= ~(MAIL_LID_EDGEBIT | MAIL_DOOR_EDGEBIT);
+  if (!(keys & HAL_KEY_MAIL_LID))
+  {
+    PICTL |= MAIL_LID_EDGEBIT;
+  }
+  if (!(keys & HAL_KEY_MAIL_DOOR))
+  {
+    PICTL |= MAIL_DOOR_EDGEBIT;
+  }
+
+  /* Changing the edge can flag an interrupt */
+  HAL_KEY_MAIL_PXIFG = ~(HAL_KEY_MAIL_BITS);
+
+  if (halKeyMailRead() != keys)
+  {
+    osal_start_timerEx (Hal_TaskID, HAL_KEY_EVENT, HAL_KEY_DEBOUNCE_VALUE);
+  }
+}
+#endif
+
 /**************************************************************************************************
  * @fn      halProcessKeyInterrupt
  *
@@ -531,6 +647,13 @@ void halProcessKeyInterrupt (void)
     HAL_KEY_JOY_MOVE_PXIFG = ~(HAL_KEY_JOY_MOVE_BIT); /* Clear Interrupt Flag */
     valid = TRUE;
   }
+#endif
+#if HAL_KEY_MAIL_SENSOR
+  if (HAL_KEY_MAIL_PXIFG & HAL_KEY_MAIL_BITS)  /* Interrupt Flag has been set by a mailbox switch */
+  {
+    HAL_KEY_MAIL_PXIFG = ~(HAL_KEY_MAIL_BITS); /* Clear Interrupt Flag */
+    valid = TRUE;
+  }
 #endif
   if (valid)
   {
@@ -645,6 +768,40 @@ HAL_ISR_FUNCTION( halKeyPort2Isr, P2INT_VECTOR )
   return;
 }
 #endif
+
+#if HAL_KEY_MAIL_SENSOR
+/**************************************************************************************************
+ * @fn      halKeyPort1Isr
+ *
+ * @brief   Port1 ISR
+ *
+ * @param
+ *
+ * @return
+ **************************************************************************************************/
+HAL_ISR_FUNCTION( halKeyPort1Isr, P1INT_VECTOR )
+{
+  HAL_ENTER_ISR();
+
+  if (HAL_KEY_MAIL_PXIFG & HAL_KEY_MAIL_BITS)
+  {
+    halProcessKeyInterrupt();
+  }
+
+  /*
+    Clear the CPU interrupt flag for Port_1
+    PxIFG has to be cleared before PxIF
+  */
+  HAL_KEY_MAIL_PXIFG = 0;
+  HAL_KEY_CPU_PORT_1_IF = 0;
+
+  CLEAR_SLEEP_MODE();
+
+  HAL_EXIT_ISR();
+
+  return;
+}
+#endif
 #else
 
 void HalKeyInit(void){}
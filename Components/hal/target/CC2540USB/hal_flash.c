@@ -106,6 +106,64 @@ void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
 #endif
 }
 
+/**************************************************************************************************
+ * @fn          HalFlashCompare
+ *
+ * @brief       This function compares 'cnt' bytes of the internal flash with a buffer, mapping the
+ *              flash bank once for the whole comparison.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number.
+ * @param       offset - A valid offset into the page.
+ * @param       buf - A valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - A valid number of bytes to compare.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the flash holds the same 'cnt' bytes as the buffer, FALSE otherwise.
+ **************************************************************************************************
+ */
+uint8 HalFlashCompare(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
+{
+  // Calculate the offset into the containing flash bank as it gets mapped into XDATA.
+  uint8 *ptr = (uint8 *)(offset + HAL_FLASH_PAGE_MAP) +
+               ((pg % HAL_FLASH_PAGE_PER_BANK) * HAL_FLASH_PAGE_SIZE);
+  uint8 memctr = MEMCTR;  // Save to restore.
+
+#if !defined HAL_OAD_BOOT_CODE
+  halIntState_t is;
+#endif
+
+  pg /= HAL_FLASH_PAGE_PER_BANK;  // Calculate the flash bank from the flash page.
+
+#if !defined HAL_OAD_BOOT_CODE
+  HAL_ENTER_CRITICAL_SECTION(is);
+#endif
+
+  // Calculate and map the containing flash bank into XDATA.
+  MEMCTR = (MEMCTR & 0xF8) | pg;
+
+  while (cnt)
+  {
+    if (*buf++ != *ptr++)
+    {
+      break;
+    }
+    cnt--;
+  }
+
+  MEMCTR = memctr;
+
+#if !defined HAL_OAD_BOOT_CODE
+  HAL_EXIT_CRITICAL_SECTION(is);
+#endif
+
+  return (cnt == 0);
+}
+
 /**************************************************************************************************
  * @fn          HalFlashWrite
  *
@@ -0,0 +1,470 @@
+/******************************************************************************
+
+ @file  bench_advert.c
+
+ @brief Host benchmark of the advertising policies over a simulated week.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -IProjects/ble/Profiles/Roles/CC254x
+ * -IProjects/ble/SimpleBLEPeripheral/Source
+ * Projects/ble/SimpleBLEPeripheral/Source/mailAdvert.c for the adaptive
+ * policy. For a fixed interval, add the same value for all three steps
+ * and a failure limit the week cannot reach:
+ *
+ *   fixed 40ms:     -DMAIL_ADVERT_FAST_INT=64 -DMAIL_ADVERT_MEDIUM_INT=64
+ *                   -DMAIL_ADVERT_SLOW_INT=64 -DMAIL_ADVERT_MAX_FAILS=255
+ *   fixed 1022.5ms: the same with 1636
+ *
+ * The first argument is the number of days, 7 by default.
+ *
+ * The GAP Role stand-in below is a task of its own, which starts and stops
+ * advertising on GAPROLE_ADVERT_ENABLED, reports it to halSimAdvSet() and
+ * calls mailAdvert_StateChange() as the application's state callback does.
+ * A central connects at the next advertising event, on average half a
+ * period plus the random delay after it starts looking.
+ *
+ * Every four hours, from the first, mail is dropped at a random time in
+ * the first half hour (mailAdvert_Kick()), and the owner's phone connects
+ * one to two minutes later for five seconds. The owner discovery time is
+ * the average wait of these connections. In the fourth hour a broken
+ * central connects every 20 seconds and loses the connection to a
+ * supervision timeout 1.5 seconds later; its attempts that find no
+ * advertising within two minutes are counted as missed. Connection events
+ * are not counted in the current.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_types.h"
+#include "hal_drivers.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "OSAL_PwrMgr.h"
+#include "OnBoard.h"
+#include "gap.h"
+#include "peripheral.h"
+#include "mailAdvert.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Tasks
+#define BENCH_APP_TASK            1
+#define BENCH_ROLE_TASK           2
+
+// Events of the application task
+#define BENCH_ADVERT_STEP_EVT     0x0001
+
+// Events of the GAP Role stand-in
+#define BENCH_ROLE_START_EVT      0x0001
+#define BENCH_ROLE_END_EVT        0x0002
+
+// Longest wait of a central for advertising, in milliseconds
+#define BENCH_CONN_WAIT           120000
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_AppProcessEvent( uint8 task_id, uint16 events );
+static uint16 bench_RoleProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] =
+{
+  Hal_ProcessEvent,
+  bench_AppProcessEvent,
+  bench_RoleProcessEvent
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// GAP Role stand-in state
+static uint16 benchAdvInt = 160;
+static uint8 benchAdvEnabled = TRUE;
+static uint8 benchState = GAPROLE_INIT;
+
+// Connections made, lost to a timeout and missed; owner connections and
+// their total wait in microseconds
+static uint16 benchConns;
+static uint16 benchFails;
+static uint16 benchMissed;
+static uint16 benchOwners;
+static uint64 benchOwnerUs;
+
+/*********************************************************************
+ * @fn      bench_StateChange
+ *
+ * @brief   Enter a GAP Role state and pass it on, as the state callback
+ *          of the application does.
+ *
+ * @param   newState - gaprole_States_t
+ *
+ * @return  none
+ */
+static void bench_StateChange( uint8 newState )
+{
+  osalTimeUpdate();
+
+  benchState = newState;
+  mailAdvert_StateChange( newState );
+}
+
+/*********************************************************************
+ * @fn      GAP_SetParamValue
+ *
+ * @brief   Stand-in that keeps the general discoverable interval.
+ *
+ * @param   paramID - parameter ID
+ * @param   paramValue - new value
+ *
+ * @return  SUCCESS
+ */
+bStatus_t GAP_SetParamValue( gapParamIDs_t paramID, uint16 paramValue )
+{
+  if ( paramID == TGAP_GEN_DISC_ADV_INT_MIN )
+  {
+    benchAdvInt = paramValue;
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      GAPRole_GetParameter
+ *
+ * @brief   Stand-in that reads GAPROLE_ADVERT_ENABLED.
+ *
+ * @param   param - profile parameter ID
+ * @param   pValue - where to return the value
+ *
+ * @return  SUCCESS
+ */
+bStatus_t GAPRole_GetParameter( uint16 param, void *pValue )
+{
+  if ( param == GAPROLE_ADVERT_ENABLED )
+  {
+    *((uint8 *)pValue) = benchAdvEnabled;
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      GAPRole_SetParameter
+ *
+ * @brief   Stand-in that starts or stops advertising from its task
+ *          when GAPROLE_ADVERT_ENABLED changes.
+ *
+ * @param   param - profile parameter ID
+ * @param   len - length of the value
+ * @param   pValue - new value
+ *
+ * @return  SUCCESS
+ */
+bStatus_t GAPRole_SetParameter( uint16 param, uint8 len, void *pValue )
+{
+  uint8 oldEnabled = benchAdvEnabled;
+
+  (void)len;
+
+  if ( param != GAPROLE_ADVERT_ENABLED )
+  {
+    return ( SUCCESS );
+  }
+
+  benchAdvEnabled = *((uint8 *)pValue);
+
+  if ( oldEnabled && !benchAdvEnabled )
+  {
+    if ( (benchState == GAPROLE_ADVERTISING) ||
+         (benchState == GAPROLE_WAITING_AFTER_TIMEOUT) )
+    {
+      VOID osal_set_event( BENCH_ROLE_TASK, BENCH_ROLE_END_EVT );
+    }
+  }
+  else if ( !oldEnabled && benchAdvEnabled )
+  {
+    if ( (benchState == GAPROLE_STARTED) || (benchState == GAPROLE_WAITING) ||
+         (benchState == GAPROLE_WAITING_AFTER_TIMEOUT) )
+    {
+      VOID osal_set_event( BENCH_ROLE_TASK, BENCH_ROLE_START_EVT );
+    }
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Start the HAL, the advertising policy and the GAP Role
+ *          stand-in.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  Hal_Init( 0 );
+
+  mailAdvert_Init( BENCH_APP_TASK, BENCH_ADVERT_STEP_EVT );
+  bench_StateChange( GAPROLE_STARTED );
+  VOID osal_set_event( BENCH_ROLE_TASK, BENCH_ROLE_START_EVT );
+}
+
+/*********************************************************************
+ * @fn      bench_AppProcessEvent
+ *
+ * @brief   Step the advertising policy, like the SimpleBLEPeripheral
+ *          task.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_AppProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      VOID osal_msg_deallocate( pMsg );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( events & BENCH_ADVERT_STEP_EVT )
+  {
+    mailAdvert_ProcessEvent();
+
+    return ( events ^ BENCH_ADVERT_STEP_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      bench_RoleProcessEvent
+ *
+ * @brief   Start or stop advertising for the GAP Role stand-in.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_RoleProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & BENCH_ROLE_START_EVT )
+  {
+    if ( benchAdvEnabled && (benchState != GAPROLE_ADVERTISING) &&
+         (benchState != GAPROLE_CONNECTED) )
+    {
+      halSimAdvSet( benchAdvInt );
+      bench_StateChange( GAPROLE_ADVERTISING );
+    }
+
+    return ( events ^ BENCH_ROLE_START_EVT );
+  }
+
+  if ( events & BENCH_ROLE_END_EVT )
+  {
+    if ( benchState == GAPROLE_ADVERTISING )
+    {
+      halSimAdvSet( 0 );
+      bench_StateChange( GAPROLE_WAITING );
+    }
+
+    return ( events ^ BENCH_ROLE_END_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      bench_Connect
+ *
+ * @brief   Connect a central at the next advertising event, hold the
+ *          connection and then lose it.
+ *
+ * @param   holdMs - how long the connection lasts
+ * @param   timeout - TRUE if it ends in a supervision timeout
+ *
+ * @return  none
+ */
+static void bench_Connect( uint32 holdMs, uint8 timeout )
+{
+  uint64 start = halSimTime();
+  uint64 deadline = start + ((uint64)BENCH_CONN_WAIT * 1000);
+
+  while ( (benchState != GAPROLE_ADVERTISING) && (halSimTime() < deadline) )
+  {
+    halSimRun( 100 );
+  }
+
+  if ( benchState != GAPROLE_ADVERTISING )
+  {
+    benchMissed++;
+    return;
+  }
+
+  // The next advertising event, on average half a period away
+  halSimRun( ((((uint32)benchAdvInt * HAL_SIM_LL_TICK_US) + HAL_SIM_ADV_DELAY_US) / 2000) + 1 );
+
+  benchConns++;
+  if ( timeout )
+  {
+    benchFails++;
+  }
+  else
+  {
+    benchOwners++;
+    benchOwnerUs += halSimTime() - start;
+  }
+
+  halSimAdvSet( 0 );
+  bench_StateChange( GAPROLE_CONNECTED );
+
+  halSimRun( holdMs );
+
+  bench_StateChange( timeout ? GAPROLE_WAITING_AFTER_TIMEOUT : GAPROLE_WAITING );
+  VOID osal_set_event( BENCH_ROLE_TASK, BENCH_ROLE_START_EVT );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the simulated days and print the current estimate.
+ *
+ * @param   argc - argument count
+ * @param   argv - optional number of days
+ *
+ * @return  0
+ */
+int main( int argc, char **argv )
+{
+  int days = (argc > 1) ? atoi( argv[1] ) : 7;
+  halSimCurrent_t current;
+  int d, h;
+
+  srand( 11 );
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+  InitBoard( OB_READY );
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+
+  for ( d = 0; d < days; d++ )
+  {
+    for ( h = 0; h < 24; h++ )
+    {
+      if ( h == 3 )
+      {
+        // A broken central, connecting every 20s for an hour
+        uint64 end = halSimTime() + 3600000000ULL;
+
+        while ( halSimTime() < end )
+        {
+          bench_Connect( 1500, TRUE );
+          halSimRun( 20000 );
+        }
+        continue;
+      }
+
+      if ( (h % 4) == 1 )
+      {
+        // Mail, and the owner's phone reading the journal a minute later
+        halSimRun( (rand() % 1800) * 1000 );
+        mailAdvert_Kick();
+        halSimRun( 60000 + (rand() % 60000) );
+        bench_Connect( 5000, FALSE );
+      }
+
+      halSimRun( 3600000 - (uint32)((halSimTime() / 1000) % 3600000) );
+    }
+  }
+
+  halSimGetCurrent( &current );
+
+  printf( "intervals %u to %u: %u advertising events, %u.%u uA, "
+          "%u connections (%u failed, %u missed), owner discovery %u ms\n",
+          MAIL_ADVERT_FAST_INT, MAIL_ADVERT_SLOW_INT, (unsigned)current.advEvents,
+          (unsigned)(current.avgNa / 1000), (unsigned)((current.avgNa % 1000) / 100),
+          benchConns, benchFails, benchMissed,
+          benchOwners ? (unsigned)((benchOwnerUs / benchOwners + 500) / 1000) : 0 );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,247 @@
+/******************************************************************************
+
+ @file  bench_bufmgr.c
+
+ @brief Host benchmark of osal_bm_free() against the buffers outstanding.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness,
+ * plus -DINT_HEAP_LEN=8192 for the 64 buffers. Building with the
+ * osal_bufmgr.c of before the hash buckets in place of $O/osal_bufmgr.c
+ * (git show 7c2ef66^:Components/osal/common/osal_bufmgr.c) measures the
+ * list walk they replaced.
+ *
+ * 4, 16 and 64 buffers of 8 to 24 bytes are kept outstanding, and every
+ * other one has had its header adjusted by osal_bm_adjust_header(). Then
+ * BENCH_PAIRS times a random buffer is freed and replaced, and each
+ * osal_bm_free() is timed in host cycles. The buffers are freed by the
+ * pointer last handed out for them, which is found in its hash bucket,
+ * and in a second run the header-adjusted ones are freed by the pointer
+ * osal_bm_alloc() returned, which takes the walk of all buffers. With
+ * the old osal_bufmgr.c both runs walk the list.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_types.h"
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_bufmgr.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_PAIRS               200000UL
+#define BENCH_MAX_BUFS            64
+
+// Header space osal_bm_adjust_header() removes from every other buffer
+#define BENCH_HDR_LEN             4
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint8 *allocPtr;  // Pointer osal_bm_alloc() returned
+  uint8 *freePtr;   // Pointer the buffer is freed by
+} benchBuf_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static benchBuf_t benchBufs[BENCH_MAX_BUFS];
+static uint64 benchCycles[BENCH_PAIRS];
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   The benchmark has no tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      bench_Alloc
+ *
+ * @brief   Allocate a buffer, and for odd slots adjust its header.
+ *
+ * @param   slot - slot of the buffer
+ * @param   walk - free header-adjusted buffers by the allocated pointer
+ *
+ * @return  none
+ */
+static void bench_Alloc( uint8 slot, uint8 walk )
+{
+  benchBuf_t *pBuf = &benchBufs[slot];
+
+  pBuf->allocPtr = osal_bm_alloc( 8 + (rand() % 17) );
+  pBuf->freePtr = pBuf->allocPtr;
+
+  if ( slot & 1 )
+  {
+    uint8 *pAdj = osal_bm_adjust_header( pBuf->allocPtr, -BENCH_HDR_LEN );
+
+    if ( !walk )
+    {
+      pBuf->freePtr = pAdj;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      bench_Cmp
+ *
+ * @brief   qsort() comparison of two cycle counts.
+ *
+ * @param   a, b - cycle counts
+ *
+ * @return  <0, 0 or >0
+ */
+static int bench_Cmp( const void *a, const void *b )
+{
+  uint64 x = *(const uint64 *)a;
+  uint64 y = *(const uint64 *)b;
+
+  return ( (x > y) - (x < y) );
+}
+
+/*********************************************************************
+ * @fn      bench_Run
+ *
+ * @brief   Time osal_bm_free() with a number of buffers outstanding.
+ *
+ * @param   bufs - buffers outstanding
+ * @param   walk - free header-adjusted buffers by the allocated pointer
+ *
+ * @return  none
+ */
+static void bench_Run( uint8 bufs, uint8 walk )
+{
+  uint32 i;
+  uint8 k;
+
+  srand( bufs );
+
+  for ( k = 0; k < bufs; k++ )
+  {
+    bench_Alloc( k, walk );
+  }
+
+  for ( i = 0; i < BENCH_PAIRS; i++ )
+  {
+    uint8 slot = rand() % bufs;
+    uint64 start = halMcuCycles();
+
+    osal_bm_free( benchBufs[slot].freePtr );
+    benchCycles[i] = halMcuCycles() - start;
+
+    bench_Alloc( slot, walk );
+  }
+
+  for ( k = 0; k < bufs; k++ )
+  {
+    osal_bm_free( benchBufs[k].freePtr );
+  }
+
+  qsort( benchCycles, BENCH_PAIRS, sizeof( uint64 ), bench_Cmp );
+
+  printf( "buffers %2u, %s: p50 %4llu p99 %4llu cycles\n", bufs,
+          walk ? "walk  " : "bucket",
+          (unsigned long long)benchCycles[BENCH_PAIRS / 2],
+          (unsigned long long)benchCycles[(BENCH_PAIRS * 99) / 100] );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print one line per buffer count.
+ *
+ * @param   none
+ *
+ * @return  0
+ */
+int main( void )
+{
+  static const uint8 counts[] = { 4, 16, 64 };
+  uint8 k;
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+
+  for ( k = 0; k < sizeof( counts ); k++ )
+  {
+    bench_Run( counts[k], FALSE );
+    bench_Run( counts[k], TRUE );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
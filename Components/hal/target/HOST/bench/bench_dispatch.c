@@ -0,0 +1,243 @@
+/******************************************************************************
+
+ @file  bench_dispatch.c
+
+ @brief Host benchmark of OSAL task dispatch against the number of tasks.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness,
+ * plus -DBENCH_TASKS=<n> for the number of tasks (tasksCnt is a constant,
+ * so each task count is a build of its own):
+ *
+ *   for n in 5 12 24; do <command line> -DBENCH_TASKS=$n -o dispatch; ./dispatch; done
+ *
+ * Building with the OSAL.c of before the ready map in place of $O/OSAL.c
+ * (git show 26684b1^:Components/osal/common/OSAL.c) measures the scan of
+ * tasksEvents[] it replaced; the weak osal_tasks_ready() below stands in
+ * for the one that file lacks.
+ *
+ * The last task is made ready and one osal_run_system() pass is timed, then
+ * one pass with no task ready. Each figure is the median of BENCH_PASSES
+ * passes, in host cycles.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_types.h"
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#if !defined BENCH_TASKS
+  #define BENCH_TASKS             12
+#endif
+
+#define BENCH_PASSES              10001
+
+#define BENCH_EVT                 0x0001
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint64 benchDispatch[BENCH_PASSES];
+static uint64 benchIdle[BENCH_PASSES];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[BENCH_TASKS] =
+{
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+  bench_ProcessEvent,
+#if BENCH_TASKS > 5
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+#endif
+#if BENCH_TASKS > 12
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+#endif
+};
+
+OSAL_TASKS_ASSERT_CNT( tasksArr );
+
+const uint8 tasksCnt = BENCH_TASKS;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Clear the events of the benchmark tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      osal_tasks_ready
+ *
+ * @brief   Stand-in for builds with an OSAL.c without the ready map.
+ *
+ * @param   none
+ *
+ * @return  TRUE if any task has an event pending.
+ */
+__attribute__((weak)) uint8 osal_tasks_ready( void )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < tasksCnt; idx++ )
+  {
+    if ( tasksEvents[idx] )
+    {
+      return ( TRUE );
+    }
+  }
+
+  return ( FALSE );
+}
+
+/*********************************************************************
+ * @fn      bench_ProcessEvent
+ *
+ * @brief   Consume the benchmark event.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events ^ BENCH_EVT );
+}
+
+/*********************************************************************
+ * @fn      bench_Cmp
+ *
+ * @brief   qsort() comparison of two cycle counts.
+ *
+ * @param   a, b - cycle counts
+ *
+ * @return  <0, 0 or >0
+ */
+static int bench_Cmp( const void *a, const void *b )
+{
+  uint64 x = *(const uint64 *)a;
+  uint64 y = *(const uint64 *)b;
+
+  return ( (x > y) - (x < y) );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print the medians.
+ *
+ * @param   none
+ *
+ * @return  0
+ */
+int main( void )
+{
+  uint16 i;
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+
+  for ( i = 0; i < BENCH_PASSES; i++ )
+  {
+    uint64 start;
+
+    VOID osal_set_event( BENCH_TASKS - 1, BENCH_EVT );
+
+    start = halMcuCycles();
+    osal_run_system();
+    benchDispatch[i] = halMcuCycles() - start;
+
+    start = halMcuCycles();
+    osal_run_system();
+    benchIdle[i] = halMcuCycles() - start;
+  }
+
+  qsort( benchDispatch, BENCH_PASSES, sizeof( uint64 ), bench_Cmp );
+  qsort( benchIdle, BENCH_PASSES, sizeof( uint64 ), bench_Cmp );
+
+  printf( "tasks %2u: dispatch %4llu idle %4llu cycles\n", BENCH_TASKS,
+          (unsigned long long)benchDispatch[BENCH_PASSES / 2],
+          (unsigned long long)benchIdle[BENCH_PASSES / 2] );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,304 @@
+/******************************************************************************
+
+ @file  bench_findattr.c
+
+ @brief Host benchmark of GATTServApp_FindAttr() on indexed attribute
+        tables.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -DHAL_SIM_LINK=TRUE, -IProjects/ble/Include,
+ * Projects/ble/Profiles/GATT/gattservapp_util.c and
+ * Components/hal/target/HOST/hal_sim_link.c, which stands in for the GATT
+ * calls of gattservapp_util.c.
+ *
+ * For tables the size of the HID keyboard (29 attributes), keyboard and
+ * mouse (37) and a larger one (60), GATTServApp_FindAttr() first has to
+ * return the same attribute as a linear search for every value pointer,
+ * pointers shared by several attributes included. Then the deepest
+ * attributes, where notification values of the HID services sit, are
+ * looked up BENCH_LOOKUPS times unindexed and indexed, timed with the
+ * host clock. The timings depend on the optimization flags; the command
+ * line in hal_sim.h sets none, and at -O2 the linear search of tables
+ * this small hardly grows with their size, so only compare runs built
+ * the same way.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "bcomdef.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "linkdb.h"
+#include "gatt.h"
+#include "gattservapp.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_MAX_ATTRS           60
+#define BENCH_LOOKUPS             1000000UL
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+// Link database stand-ins for gattservapp_util.c
+uint8 linkDBNumConns = 1;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8 benchValues[BENCH_MAX_ATTRS];
+static gattAttribute_t benchAttrTbl[BENCH_MAX_ATTRS];
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   There are no tasks to initialize.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      linkDB_Register
+ *
+ * @brief   Link database stand-in: there are no link state changes.
+ *
+ * @param   pFunc - callback function
+ *
+ * @return  SUCCESS
+ */
+uint8 linkDB_Register( pfnLinkDBCB_t pFunc )
+{
+  (void)pFunc;
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      benchLinearFind
+ *
+ * @brief   Find an attribute by value pointer the way an unindexed
+ *          table is searched.
+ *
+ * @param   pAttrTbl - attribute table
+ * @param   numAttrs - number of attributes in the table
+ * @param   pValue - value pointer to look for
+ *
+ * @return  first attribute with that value pointer, NULL if none
+ */
+static __attribute__((noinline))
+gattAttribute_t *benchLinearFind( gattAttribute_t *pAttrTbl, uint16 numAttrs, uint8 *pValue )
+{
+  uint16 i;
+
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    if ( pAttrTbl[i].pValue == pValue )
+    {
+      return ( &pAttrTbl[i] );
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      benchNs
+ *
+ * @brief   Read the host monotonic clock.
+ *
+ * @param   none
+ *
+ * @return  nanoseconds
+ */
+static uint64 benchNs( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+
+  return ( (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec );
+}
+
+/*********************************************************************
+ * @fn      benchCheck
+ *
+ * @brief   Compare the indexed search with the linear one for every
+ *          value pointer of a table where every fifth attribute shares
+ *          the first value.
+ *
+ * @param   numAttrs - number of attributes in the table
+ *
+ * @return  TRUE if they agree
+ */
+static uint8 benchCheck( uint8 numAttrs )
+{
+  uint8 i;
+
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    *(uint8 **)&benchAttrTbl[i].pValue = &benchValues[(i % 5 == 0) ? 0 : (i * 7) % numAttrs];
+  }
+
+  if ( GATTServApp_IndexAttrTbl( benchAttrTbl, numAttrs ) != SUCCESS )
+  {
+    return ( FALSE );
+  }
+
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    if ( GATTServApp_FindAttr( benchAttrTbl, numAttrs, &benchValues[i] ) !=
+         benchLinearFind( benchAttrTbl, numAttrs, &benchValues[i] ) )
+    {
+      return ( FALSE );
+    }
+  }
+
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * @fn      benchTime
+ *
+ * @brief   Time lookups of the eight deepest attributes of a table.
+ *
+ * @param   numAttrs - number of attributes in the table
+ * @param   indexed - TRUE to index the table first
+ *
+ * @return  nanoseconds per lookup
+ */
+static uint32 benchTime( uint8 numAttrs, uint8 indexed )
+{
+  gattAttribute_t * volatile pAttr;
+  uint64 start;
+  uint32 k;
+  uint8 i;
+
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    *(uint8 **)&benchAttrTbl[i].pValue = &benchValues[i];
+  }
+
+  if ( indexed )
+  {
+    VOID GATTServApp_IndexAttrTbl( benchAttrTbl, numAttrs );
+  }
+  else
+  {
+    GATTServApp_UnindexAttrTbl( benchAttrTbl );
+  }
+
+  start = benchNs();
+
+  for ( k = 0; k < BENCH_LOOKUPS; k++ )
+  {
+    pAttr = GATTServApp_FindAttr( benchAttrTbl, numAttrs,
+                                  &benchValues[numAttrs - 1 - (k & 7)] );
+  }
+
+  (void)pAttr;
+
+  return ( (uint32)((benchNs() - start) / BENCH_LOOKUPS) );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print one line per table size.
+ *
+ * @param   none
+ *
+ * @return  0 if the indexed searches agree with the linear ones
+ */
+int main( void )
+{
+  static const uint8 sizes[] = { 29, 37, BENCH_MAX_ATTRS };
+  uint8 k;
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+
+  for ( k = 0; k < sizeof( sizes ); k++ )
+  {
+    uint32 linear, indexed;
+
+    if ( !benchCheck( sizes[k] ) )
+    {
+      printf( "attributes %2u: indexed search differs\n", sizes[k] );
+      return ( 1 );
+    }
+
+    linear = benchTime( sizes[k], FALSE );
+    indexed = benchTime( sizes[k], TRUE );
+
+    printf( "attributes %2u: unindexed %3u ns, indexed %3u ns per lookup\n",
+            sizes[k], (unsigned)linear, (unsigned)indexed );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
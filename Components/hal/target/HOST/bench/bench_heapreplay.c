@@ -0,0 +1,227 @@
+/******************************************************************************
+
+ @file  bench_heapreplay.c
+
+ @brief Host replay of a heap trace dumped over NPI.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -DOSALMEM_METRICS=TRUE and Components/hal/target/HOST/hal_sim_heap.c,
+ * with the heap settings to try (MAXMEMHEAP, OSALMEM_SMALL_BLKSZ,
+ * OSALMEM_SIZE_CLASSES, ...). Run it on a file of the bytes received from
+ * a device built with OSALMEM_TRACE=TRUE after it was sent the
+ * NPI_DUMP_HEAP_TRACE_CMD command; see npi.h for the framing.
+ *
+ * The records are taken from the NPI_DUMP_EVENT vendor specific events
+ * that answer NPI_DUMP_HEAP_TRACE_CMD; other HCI events are skipped
+ * whole, and bytes outside any event one at a time. The records are then
+ * replayed with halSimHeapReplay() and its result printed.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bcomdef.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Memory.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Framing of NPI_DumpCBack(), as in npi.h
+#define BENCH_HCI_EVENT_PACKET    0x04
+#define BENCH_HCI_VE_EVENT_CODE   0xFF
+#define BENCH_DUMP_HDR_LEN        8
+#define BENCH_DUMP_EVENT          0x07C0
+#define BENCH_DUMP_HEAP_TRACE_CMD 0xFFC0
+
+// Largest dump file read
+#define BENCH_MAX_FILE            (1UL << 22)
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   The replay has no tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      bench_Unframe
+ *
+ * @brief   Gather the heap trace records of the dump events in place.
+ *
+ * @param   pBuf - bytes received from the device
+ * @param   len - number of bytes
+ * @param   pEvents - where to return the number of dump events found
+ * @param   pBad - where to return the number of dump events that failed
+ *                 or did not hold whole records
+ *
+ * @return  length of the records
+ */
+static uint32 bench_Unframe( uint8 *pBuf, uint32 len, uint32 *pEvents, uint32 *pBad )
+{
+  uint32 in = 0, out = 0;
+
+  *pEvents = 0;
+  *pBad = 0;
+
+  while ( (in + 3) <= len )
+  {
+    uint32 pktLen = 3 + pBuf[in + 2];
+
+    if ( pBuf[in] != BENCH_HCI_EVENT_PACKET )
+    {
+      in++;
+      continue;
+    }
+
+    if ( (in + pktLen) > len )
+    {
+      break;
+    }
+
+    if ( (pBuf[in + 1] == BENCH_HCI_VE_EVENT_CODE) && (pktLen >= BENCH_DUMP_HDR_LEN) &&
+         (BUILD_UINT16( pBuf[in + 3], pBuf[in + 4] ) == BENCH_DUMP_EVENT) &&
+         (BUILD_UINT16( pBuf[in + 6], pBuf[in + 7] ) == BENCH_DUMP_HEAP_TRACE_CMD) )
+    {
+      uint32 dataLen = pktLen - BENCH_DUMP_HDR_LEN;
+      uint8 status = pBuf[in + 5];
+
+      (*pEvents)++;
+
+      if ( ((status != SUCCESS) && (status != blePending)) ||
+           ((dataLen % OSALMEM_TRACE_REC_SZ) != 0) )
+      {
+        (*pBad)++;
+      }
+      else
+      {
+        osal_memcpy( pBuf + out, pBuf + in + BENCH_DUMP_HDR_LEN, dataLen );
+        out += dataLen;
+      }
+    }
+
+    in += pktLen;
+  }
+
+  return ( out );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Read, unframe and replay a dump, and print the result.
+ *
+ * @param   argc - argument count
+ * @param   argv - file of the bytes received from the device
+ *
+ * @return  0 on success
+ */
+int main( int argc, char **argv )
+{
+  halSimHeapReplay_t stats;
+  uint32 len, events, bad;
+  uint8 *pBuf;
+  FILE *pFile;
+
+  if ( argc < 2 )
+  {
+    fprintf( stderr, "usage: %s <dump file>\n", argv[0] );
+    return ( 1 );
+  }
+
+  pFile = fopen( argv[1], "rb" );
+  pBuf = malloc( BENCH_MAX_FILE );
+  if ( (pFile == NULL) || (pBuf == NULL) )
+  {
+    fprintf( stderr, "%s: cannot read %s\n", argv[0], argv[1] );
+    return ( 1 );
+  }
+
+  len = (uint32)fread( pBuf, 1, BENCH_MAX_FILE, pFile );
+  fclose( pFile );
+
+  len = bench_Unframe( pBuf, len, &events, &bad );
+  halSimHeapReplay( pBuf, len, &stats );
+
+  printf( "%u dump events (%u bad), %u records\n",
+          (unsigned)events, (unsigned)bad, (unsigned)(len / OSALMEM_TRACE_REC_SZ) );
+  printf( "allocs             %u\n", stats.allocs );
+  printf( "frees              %u\n", stats.frees );
+  printf( "failures           %u\n", stats.failures );
+  printf( "skipped            %u\n", stats.skipped );
+  printf( "peakUsed           %u\n", stats.peakUsed );
+  printf( "largestFreeAtPeak  %u\n", stats.largestFreeAtPeak );
+  printf( "fragAtPeak         %u%%\n", stats.fragAtPeak );
+  printf( "minLargestFree     %u\n", stats.minLargestFree );
+  printf( "blockMax           %u\n", stats.blockMax );
+  printf( "searchMax          %u\n", stats.searchMax );
+
+  free( pBuf );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
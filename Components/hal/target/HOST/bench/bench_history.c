@@ -0,0 +1,402 @@
+/******************************************************************************
+
+ @file  bench_history.c
+
+ @brief Host benchmark of the mail history stream over a simulated
+        connection.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -DHAL_SIM_LINK=TRUE, -IProjects/ble/Include, -IProjects/ble/Profiles/Roles,
+ * -IProjects/ble/Profiles/SimpleProfile, -IProjects/ble/SimpleBLEPeripheral/Source,
+ * and the sources Projects/ble/Profiles/SimpleProfile/CC254x/simpleGATTprofile.c,
+ * Projects/ble/Profiles/GATT/gattservapp_util.c, Components/ble/host/gatt_uuid.c,
+ * Projects/ble/SimpleBLEPeripheral/Source/mailHistory.c and mailJournal.c,
+ * Components/osal/mcu/cc2540/osal_snv.c, and hal_sim_flash.c and
+ * hal_sim_link.c from Components/hal/target/HOST.
+ *
+ * BENCH_EVENTS mail events are logged to the journal, which keeps the
+ * last MAIL_JOURNAL_NV_BLOCKS * MAIL_JOURNAL_BLOCK_EVTS, then streamed from
+ * the oldest through Simple Profile characteristic 6 over a simulated
+ * connection, for each connection interval and ATT MTU in benchCases[].
+ * Every record received must carry the next sequence number. The stream
+ * ends with an empty notification; the records per second are counted up
+ * to it in virtual time.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+
+#include "bcomdef.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_snv.h"
+#include "linkdb.h"
+#include "gatt.h"
+#include "gatt_uuid.h"
+#include "gattservapp.h"
+#include "simpleGATTprofile.h"
+#include "mailJournal.h"
+#include "mailHistory.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_EVENTS              200
+
+// Events of the benchmark task
+#define BENCH_JOURNAL_EVT         0x0001
+#define BENCH_NOTI_Q_EVT          0x0002
+
+// Give up on a stream after this much virtual time, in milliseconds
+#define BENCH_TIMEOUT             60000
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint16 connInterval;  // Units of 1.25 ms
+  uint16 mtu;           // ATT MTU
+} benchCase_t;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] =
+{
+  bench_ProcessEvent
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+// Link database stand-ins for gattservapp_util.c
+uint8 linkDBNumConns = 1;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const benchCase_t benchCases[] =
+{
+  {  6,  23 }, {  6, 158 },  //   7.5 ms
+  { 24,  23 }, { 24, 158 },  //  30 ms
+  { 80,  23 }, { 80, 158 }   // 100 ms
+};
+
+// Attribute table passed to the GATTServApp_RegisterService() stand-in
+static gattAttribute_t *benchAttrTbl;
+static uint16 benchNumAttrs;
+
+// Stream received so far
+static uint16 benchNextSeq;
+static uint16 benchRecords;
+static uint16 benchErrors;
+static uint8 benchDone;
+static uint64 benchEnd;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Set up the journal, the Simple Profile and the history stream
+ *          on the benchmark task.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  mailJournal_Init( 0, BENCH_JOURNAL_EVT );
+  VOID SimpleProfile_AddService( GATT_ALL_SERVICES );
+  VOID GATTServApp_InitNotiQ( 0, BENCH_NOTI_Q_EVT );
+  mailHistory_Init( 0, BENCH_NOTI_Q_EVT );
+}
+
+/*********************************************************************
+ * @fn      bench_ProcessEvent
+ *
+ * @brief   Commit the journal and pump the notification queue and the
+ *          history stream, like the SimpleBLEPeripheral task.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( 0 )) != NULL )
+    {
+      VOID osal_msg_deallocate( pMsg );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( events & BENCH_NOTI_Q_EVT )
+  {
+    GATTServApp_ProcessNotiQ();
+    mailHistory_ProcessEvent();
+
+    return ( events ^ BENCH_NOTI_Q_EVT );
+  }
+
+  if ( events & BENCH_JOURNAL_EVT )
+  {
+    mailJournal_Commit();
+
+    return ( events ^ BENCH_JOURNAL_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      GATTServApp_RegisterService
+ *
+ * @brief   GATT server stand-in: keep the table to enable its client
+ *          characteristic configurations.
+ *
+ * @param   pAttrs - attribute table
+ * @param   numAttrs - number of attributes
+ * @param   encKeySize - unused
+ * @param   pServiceCBs - unused
+ *
+ * @return  SUCCESS
+ */
+bStatus_t GATTServApp_RegisterService( gattAttribute_t *pAttrs, uint16 numAttrs,
+                                       uint8 encKeySize, CONST gattServiceCBs_t *pServiceCBs )
+{
+  (void)encKeySize;
+  (void)pServiceCBs;
+
+  benchAttrTbl = pAttrs;
+  benchNumAttrs = numAttrs;
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      linkDB_Register
+ *
+ * @brief   Link database stand-in: there are no link state changes.
+ *
+ * @param   pFunc - callback function
+ *
+ * @return  SUCCESS
+ */
+uint8 linkDB_Register( pfnLinkDBCB_t pFunc )
+{
+  (void)pFunc;
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      benchEnableNotify
+ *
+ * @brief   Enable notifications on every characteristic of the Simple
+ *          Profile for the simulated connection.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void benchEnableNotify( void )
+{
+  uint16 i;
+
+  for ( i = 0; i < benchNumAttrs; i++ )
+  {
+    gattAttribute_t *pAttr = &benchAttrTbl[i];
+
+    if ( (pAttr->type.len == ATT_BT_UUID_SIZE) &&
+         (BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1] ) == GATT_CLIENT_CHAR_CFG_UUID) )
+    {
+      VOID GATTServApp_WriteCharCfg( 0, *(gattCharCfg_t **)pAttr->pValue,
+                                     GATT_CLIENT_CFG_NOTIFY );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      benchRx
+ *
+ * @brief   Check the records of each notification received.
+ *
+ * @param   handle - attribute handle
+ * @param   pValue - notification value
+ * @param   len - length of the value
+ *
+ * @return  none
+ */
+static void benchRx( uint16 handle, uint8 *pValue, uint8 len )
+{
+  uint8 i;
+
+  (void)handle;
+
+  if ( len == 0 )
+  {
+    benchDone = TRUE;
+    benchEnd = halSimTime();
+    return;
+  }
+
+  if ( len % MAIL_HISTORY_REC_LEN )
+  {
+    benchErrors++;
+  }
+
+  for ( i = 0; i + MAIL_HISTORY_REC_LEN <= len; i += MAIL_HISTORY_REC_LEN )
+  {
+    if ( BUILD_UINT16( pValue[i], pValue[i + 1] ) != benchNextSeq++ )
+    {
+      benchErrors++;
+    }
+
+    benchRecords++;
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print one line per case.
+ *
+ * @param   none
+ *
+ * @return  0 if every stream arrived complete and in order
+ */
+int main( void )
+{
+  uint16 seq;
+  uint8 k;
+
+  halSimInit();
+  if ( !halSimFlashOpen( NULL ) || (osal_snv_init() != SUCCESS) ||
+       (osal_init_system() != SUCCESS) )
+  {
+    return ( 1 );
+  }
+
+  benchEnableNotify();
+
+  for ( seq = 0; seq < BENCH_EVENTS; seq++ )
+  {
+    VOID mailJournal_Log( MAIL_EVT_DROP, (uint8)seq );
+
+    // Commit as the journal event would, before its RAM buffer fills
+    if ( (seq % 8) == 7 )
+    {
+      mailJournal_Commit();
+    }
+  }
+  mailJournal_Commit();
+  halSimRun( 10 );
+
+  for ( k = 0; k < sizeof( benchCases ) / sizeof( benchCases[0] ); k++ )
+  {
+    const benchCase_t *pCase = &benchCases[k];
+    halSimLinkStats_t stats;
+    uint64 start;
+
+    benchNextSeq = mailJournal_FirstSeq();
+    benchRecords = 0;
+    benchErrors = 0;
+    benchDone = FALSE;
+
+    halSimLinkOpen( pCase->connInterval, pCase->mtu, benchRx );
+    start = halSimTime();
+    mailHistory_Start( 0, benchNextSeq );
+
+    while ( !benchDone && (halSimTime() - start < (uint64)BENCH_TIMEOUT * 1000) )
+    {
+      halSimRun( 10 );
+    }
+
+    mailHistory_Stop();
+    halSimLinkGetStats( &stats );
+    halSimLinkClose();
+
+    if ( !benchDone || benchErrors )
+    {
+      printf( "interval %5.1f ms, MTU %3u: stream incomplete\n",
+              pCase->connInterval * 1.25, pCase->mtu );
+      return ( 1 );
+    }
+
+    printf( "interval %5.1f ms, MTU %3u: %u records in %u connection events, %5u records/s\n",
+            pCase->connInterval * 1.25, pCase->mtu, benchRecords,
+            (unsigned)stats.connEvents,
+            (unsigned)((uint64)benchRecords * 1000000 / (benchEnd - start)) );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
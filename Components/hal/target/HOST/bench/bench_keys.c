@@ -0,0 +1,373 @@
+/******************************************************************************
+
+ @file  bench_keys.c
+
+ @brief Host benchmark of mailbox switch detection, by interrupt or by polling.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -DHAL_KEY=TRUE -IProjects/ble/SimpleBLEPeripheral/Source
+ * Projects/ble/SimpleBLEPeripheral/Source/mailJournal.c,
+ * Projects/ble/SimpleBLEPeripheral/Source/mailSensor.c,
+ * Components/osal/mcu/cc2540/osal_snv.c,
+ * Components/hal/target/HOST/hal_sim_flash.c and
+ * Components/hal/target/HOST/hal_sim_key.c. Add -DBENCH_POLL to read the
+ * switches every BENCH_POLL_PERIOD instead, as the application did before
+ * they interrupted. The first argument is the number of rounds, 24 by
+ * default.
+ *
+ * In each round the lid opens after 100 seconds to 52 minutes and closes
+ * one to three seconds later, and in every eighth round the door opens a
+ * minute after that for 10 to 30 seconds; then nothing happens for ten
+ * minutes. Each edge bounces three times a millisecond apart. The
+ * detection latency runs from the first bounce until
+ * mailSensor_HandleKeys() reports the change; the sleep statistics give
+ * the time spent awake.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_types.h"
+#include "hal_drivers.h"
+#include "hal_key.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_PwrMgr.h"
+#include "OnBoard.h"
+#include "osal_snv.h"
+#include "mailJournal.h"
+#include "mailSensor.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Application task and its events
+#define BENCH_APP_TASK            1
+
+#define BENCH_START_EVT           0x0001
+#define BENCH_PERIODIC_EVT        0x0002
+#define BENCH_JOURNAL_EVT         0x0004
+
+// Period of SBP_PERIODIC_EVT, in milliseconds
+#define BENCH_POLL_PERIOD         5000
+
+// Longest wait for a detection, in milliseconds
+#define BENCH_DETECT_WAIT         6000
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] =
+{
+  Hal_ProcessEvent,
+  bench_ProcessEvent
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Switch pins driven so far
+static uint8 benchPins;
+
+// Virtual time of the last detection, 0 while waiting for one
+static uint64 benchDetectTime;
+
+// Detections and their latency in microseconds
+static uint16 benchDetects;
+static uint64 benchLatencySum;
+static uint64 benchLatencyMax;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Start the HAL, the journal and the mailbox switches.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  Hal_Init( 0 );
+
+  mailJournal_Init( BENCH_APP_TASK, BENCH_JOURNAL_EVT );
+  mailSensor_Init();
+
+#if !defined BENCH_POLL
+  VOID RegisterForKeys( BENCH_APP_TASK );
+#endif
+
+  VOID osal_set_event( BENCH_APP_TASK, BENCH_START_EVT );
+}
+
+/*********************************************************************
+ * @fn      bench_HandleKeys
+ *
+ * @brief   Pass the switches to mailSensor.c and note a detection,
+ *          like the SimpleBLEPeripheral task.
+ *
+ * @param   keys - key state
+ *
+ * @return  none
+ */
+static void bench_HandleKeys( uint8 keys )
+{
+  if ( mailSensor_HandleKeys( keys ) )
+  {
+    benchDetectTime = halSimTime();
+    benchDetects++;
+
+#if !defined BENCH_POLL
+    if ( mailSensor_Pending() &&
+         (osal_get_timeoutEx( BENCH_APP_TASK, BENCH_PERIODIC_EVT ) == 0) )
+    {
+      VOID osal_start_timerEx( BENCH_APP_TASK, BENCH_PERIODIC_EVT, BENCH_POLL_PERIOD );
+    }
+#endif
+  }
+}
+
+/*********************************************************************
+ * @fn      bench_ProcessEvent
+ *
+ * @brief   Handle key changes, the periodic event and journal commits.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      if ( ((osal_event_hdr_t *)pMsg)->event == KEY_CHANGE )
+      {
+        bench_HandleKeys( ((keyChange_t *)pMsg)->keys );
+      }
+
+      VOID osal_msg_deallocate( pMsg );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( events & BENCH_START_EVT )
+  {
+#if defined BENCH_POLL
+    VOID osal_start_timerEx( task_id, BENCH_PERIODIC_EVT, BENCH_POLL_PERIOD );
+#endif
+
+    return ( events ^ BENCH_START_EVT );
+  }
+
+  if ( events & BENCH_PERIODIC_EVT )
+  {
+    bench_HandleKeys( HalKeyRead() );
+
+#if defined BENCH_POLL
+    VOID osal_start_timerEx( task_id, BENCH_PERIODIC_EVT, BENCH_POLL_PERIOD );
+#else
+    if ( mailSensor_Pending() )
+    {
+      VOID osal_start_timerEx( task_id, BENCH_PERIODIC_EVT, BENCH_POLL_PERIOD );
+    }
+#endif
+
+    return ( events ^ BENCH_PERIODIC_EVT );
+  }
+
+  if ( events & BENCH_JOURNAL_EVT )
+  {
+    VOID mailJournal_Commit();
+
+    return ( events ^ BENCH_JOURNAL_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      bench_Edge
+ *
+ * @brief   Open or close a switch with bounce, then wait until the
+ *          change is detected.
+ *
+ * @param   key - HAL_KEY_MAIL_LID or HAL_KEY_MAIL_DOOR
+ * @param   open - TRUE to open the switch
+ *
+ * @return  none
+ */
+static void bench_Edge( uint8 key, uint8 open )
+{
+  uint8 pins = open ? (benchPins | key) : (benchPins & ~key);
+  uint64 start = halSimTime();
+  uint64 deadline;
+  uint8 i;
+
+  for ( i = 0; i < 3; i++ )
+  {
+    halSimKeySet( pins );
+    halSimRun( 1 );
+    halSimKeySet( benchPins );
+    halSimRun( 1 );
+  }
+
+  halSimKeySet( pins );
+  benchPins = pins;
+
+  benchDetectTime = 0;
+  deadline = halSimTime() + ((uint64)BENCH_DETECT_WAIT * 1000);
+
+  while ( (benchDetectTime == 0) && (halSimTime() < deadline) )
+  {
+    halSimRun( 1000 );
+  }
+
+  if ( benchDetectTime != 0 )
+  {
+    uint64 latency = benchDetectTime - start;
+
+    benchLatencySum += latency;
+    if ( latency > benchLatencyMax )
+    {
+      benchLatencyMax = latency;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the simulated rounds and print latency and awake time.
+ *
+ * @param   argc - argument count
+ * @param   argv - optional number of rounds
+ *
+ * @return  0
+ */
+int main( int argc, char **argv )
+{
+  int rounds = (argc > 1) ? atoi( argv[1] ) : 24;
+  halSimSleepStats_t sleepStats;
+  halSimKeyStats_t keyStats;
+  int r;
+
+  srand( 7 );
+
+  halSimInit();
+  if ( !halSimFlashOpen( NULL ) || (osal_snv_init() != SUCCESS) ||
+       (osal_init_system() != SUCCESS) )
+  {
+    return ( 1 );
+  }
+  InitBoard( OB_READY );
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+
+  halSimRun( 1000 );
+
+  for ( r = 0; r < rounds; r++ )
+  {
+    halSimRun( ((rand() % 3000) + 100) * 1000 );
+    bench_Edge( HAL_KEY_MAIL_LID, TRUE );
+    halSimRun( 1000 + (rand() % 2000) );
+    bench_Edge( HAL_KEY_MAIL_LID, FALSE );
+
+    if ( (r % 8) == 0 )
+    {
+      halSimRun( 60000 );
+      bench_Edge( HAL_KEY_MAIL_DOOR, TRUE );
+      halSimRun( 10000 + (rand() % 20000) );
+      bench_Edge( HAL_KEY_MAIL_DOOR, FALSE );
+    }
+
+    halSimRun( 600000 );
+  }
+
+  VOID mailJournal_Commit();
+
+  halSimGetSleepStats( &sleepStats );
+  halSimKeyGetStats( &keyStats );
+
+  printf( "%s: %u min, %u edges, %u detected, latency avg %llu ms max %llu ms, "
+          "awake %llu.%03llu s\n",
+#if defined BENCH_POLL
+          "polling",
+#else
+          "interrupt",
+#endif
+          (unsigned)(halSimTime() / 60000000), (unsigned)keyStats.edges, benchDetects,
+          (unsigned long long)(benchDetects ? (benchLatencySum / benchDetects) / 1000 : 0),
+          (unsigned long long)(benchLatencyMax / 1000),
+          (unsigned long long)(sleepStats.awakeUs / 1000000),
+          (unsigned long long)((sleepStats.awakeUs / 1000) % 1000) );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,184 @@
+/******************************************************************************
+
+ @file  bench_msgq.c
+
+ @brief Host benchmark of the OSAL per-task message queues.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness.
+ *
+ * Eight tasks are sent 1, 8 and 32 messages spread over them, then each
+ * task drains its queue with osal_msg_receive(), last task first. The
+ * longest and average critical sections come from halMcuCsGetStats(),
+ * in host cycles.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+
+#include "hal_types.h"
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_TASKS               8
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[BENCH_TASKS] =
+{
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent,
+  bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent, bench_ProcessEvent
+};
+
+const uint8 tasksCnt = BENCH_TASKS;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Clear the events of the benchmark tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      bench_ProcessEvent
+ *
+ * @brief   The benchmark tasks are never scheduled.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  0
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+  (void)events;
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print one line per message count.
+ *
+ * @param   none
+ *
+ * @return  0
+ */
+int main( void )
+{
+  static const uint8 counts[] = { 1, 8, 32 };
+  uint8 k;
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+
+  for ( k = 0; k < sizeof( counts ); k++ )
+  {
+    halMcuCsStats_t stats;
+    uint8 received = 0;
+    uint8 i;
+
+    for ( i = 0; i < counts[k]; i++ )
+    {
+      uint8 *pMsg = osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+
+      ((osal_event_hdr_t *)pMsg)->event = 0x10;
+      VOID osal_msg_send( i % BENCH_TASKS, pMsg );
+    }
+
+    halMcuCsResetStats();
+
+    for ( i = BENCH_TASKS; i > 0; i-- )
+    {
+      uint8 *pMsg;
+
+      while ( (pMsg = osal_msg_receive( i - 1 )) != NULL )
+      {
+        VOID osal_msg_deallocate( pMsg );
+        received++;
+      }
+    }
+
+    halMcuCsGetStats( &stats );
+
+    printf( "messages %2u: received %2u, critical sections %3u, max %4llu avg %4llu cycles\n",
+            counts[k], received, (unsigned)stats.count,
+            (unsigned long long)stats.max,
+            (unsigned long long)(stats.total / stats.count) );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,447 @@
+/******************************************************************************
+
+ @file  bench_snv.c
+
+ @brief Host benchmark of the write latency of osal_snv.c while
+        compacting, inline or incremental.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * Components/osal/mcu/cc2540/osal_snv.c and
+ * Components/hal/target/HOST/hal_sim_flash.c; add
+ * -DOSAL_SNV_INCREMENTAL_COMPACT=TRUE for incremental compaction.
+ *
+ * BENCH_WRITES items of BENCH_ITEM_LEN bytes are written over BENCH_IDS
+ * IDs, one every <gap> virtual milliseconds (first argument, 20 by
+ * default), so the NV pages fill and compact over and over. The time a
+ * write spends programming and erasing flash is its latency. Between
+ * writes the scheduler runs one millisecond at a time, and the most flash
+ * time spent in one of them is the longest background step.
+ *
+ * "writeback [ops [seed]]" runs the soak test for the write-back cache
+ * instead; build it once as is and once with -DOSAL_SNV_WRITE_BACK=TRUE.
+ * Each of <ops> operations (100000 by default), 50 virtual milliseconds
+ * apart, writes or reads one of BENCH_SOAK_IDS items, mostly one of
+ * BENCH_SOAK_HOT hot ones; now and then the cache is flushed and SNV
+ * started again as after a reset. Every read is checked against a copy
+ * kept in RAM, and the bytes appended to the NV pages and the compactions
+ * are printed.
+ *
+ * "noop" rewrites items of 8, 32, 64 and 128 bytes with the value they
+ * already hold, BENCH_NOOP_WRITES times each, and prints the flash reads
+ * and compares (halSimFlashStats_t.reads) and host cycles per write.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_types.h"
+#include "hal_board_cfg.h"
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_cbtimer.h"
+#include "osal_snv.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_WRITES              20000
+#define BENCH_IDS                 40
+#define BENCH_ITEM_LEN            24
+#define BENCH_FIRST_ID            0x80
+
+#define BENCH_SOAK_IDS            24
+#define BENCH_SOAK_HOT            4
+#define BENCH_SOAK_ITEM_MAX       48
+#define BENCH_SOAK_GAP            50
+
+#define BENCH_NOOP_WRITES         5000
+#define BENCH_NOOP_IDS            8
+#define BENCH_NOOP_ITEM_MAX       128
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static int benchLatency( uint32 gap );
+static int benchWriteBack( uint32 ops, uint32 seed );
+static int benchNoOp( void );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] =
+{
+  OSAL_CBTIMER_PROCESS_EVENT( osal_CbTimerProcessEvent )
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// What the soak test expects to read back from each item.
+static uint8 benchModel[BENCH_SOAK_IDS][BENCH_SOAK_ITEM_MAX];
+static uint8 benchModelLen[BENCH_SOAK_IDS];
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Initialize the callback timer task.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  osal_CbTimerInit( 0 );
+}
+
+/*********************************************************************
+ * @fn      benchFlashUs
+ *
+ * @brief   Virtual time spent programming and erasing flash so far.
+ *
+ * @param   none
+ *
+ * @return  microseconds
+ */
+static uint64 benchFlashUs( void )
+{
+  halSimFlashStats_t stats;
+
+  halSimFlashGetStats( &stats );
+
+  return ( stats.busyUs );
+}
+
+/*********************************************************************
+ * @fn      benchLatency
+ *
+ * @brief   Write items <gap> ms apart and print the write latencies.
+ *
+ * @param   gap - virtual milliseconds between writes
+ *
+ * @return  0 if every write succeeded
+ */
+static int benchLatency( uint32 gap )
+{
+  uint64 writeMax = 0, writeTotal = 0, stepMax = 0;
+  uint32 slow = 0;
+  uint8 buf[BENCH_ITEM_LEN];
+  halSimFlashStats_t stats;
+  uint32 k, t;
+
+  for ( k = 0; k < BENCH_WRITES; k++ )
+  {
+    uint64 us = benchFlashUs();
+
+    osal_memset( buf, (uint8)k, sizeof( buf ) );
+    if ( osal_snv_write( (osalSnvId_t)(BENCH_FIRST_ID + (k * 7) % BENCH_IDS),
+                         sizeof( buf ), buf ) != SUCCESS )
+    {
+      return ( 1 );
+    }
+
+    us = benchFlashUs() - us;
+    writeTotal += us;
+    if ( us > writeMax )
+    {
+      writeMax = us;
+    }
+    if ( us >= (uint64)gap * 1000 )
+    {
+      slow++;
+    }
+
+    for ( t = 0; t < gap; t++ )
+    {
+      us = benchFlashUs();
+      halSimRun( 1 );
+      us = benchFlashUs() - us;
+      if ( us > stepMax )
+      {
+        stepMax = us;
+      }
+    }
+  }
+
+  halSimFlashGetStats( &stats );
+
+  printf( "gap %u ms: max write %llu us, avg %llu us, %u writes >= gap, "
+          "longest background step %llu us, %u erases\n",
+          (unsigned)gap, (unsigned long long)writeMax,
+          (unsigned long long)(writeTotal / BENCH_WRITES), (unsigned)slow,
+          (unsigned long long)stepMax, (unsigned)stats.erases );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      benchWriteBack
+ *
+ * @brief   Run the soak test and print the flash traffic it caused.
+ *
+ * @param   ops - number of operations
+ * @param   seed - seed of the operation sequence
+ *
+ * @return  0 if every operation succeeded and every read matched
+ */
+static int benchWriteBack( uint32 ops, uint32 seed )
+{
+  uint32 writes = 0, bad = 0;
+  uint8 buf[BENCH_SOAK_ITEM_MAX];
+  halSimFlashStats_t stats;
+  uint32 k;
+  uint8 i, j, len;
+
+  srand( seed );
+
+  for ( k = 0; k < ops; k++ )
+  {
+    int op = rand() % 10;
+
+    // Counters and state in the hot items take most of the traffic.
+    i = (rand() % 4) ? (rand() % BENCH_SOAK_HOT) : (rand() % BENCH_SOAK_IDS);
+
+    if ( op < 5 )
+    {
+      if ( benchModelLen[i] != 0 )
+      {
+        len = benchModelLen[i];
+      }
+      else if ( i < BENCH_SOAK_HOT )
+      {
+        len = 4 + rand() % 12;
+      }
+      else
+      {
+        len = 1 + rand() % BENCH_SOAK_ITEM_MAX;
+      }
+
+      // Rewrites keep about a quarter of the bytes they had.
+      for ( j = 0; j < len; j++ )
+      {
+        buf[j] = (rand() % 4 == 0) ? benchModel[i][j] : (uint8)rand();
+      }
+
+      if ( osal_snv_write( (osalSnvId_t)(BENCH_FIRST_ID + i), len, buf ) != SUCCESS )
+      {
+        return ( 1 );
+      }
+
+      osal_memcpy( benchModel[i], buf, len );
+      benchModelLen[i] = len;
+      writes++;
+    }
+    else if ( op < 9 )
+    {
+      len = (benchModelLen[i] != 0) ? benchModelLen[i] : 4;
+      if ( osal_snv_read( (osalSnvId_t)(BENCH_FIRST_ID + i), len, buf ) == SUCCESS )
+      {
+        if ( (benchModelLen[i] == 0) || memcmp( buf, benchModel[i], len ) )
+        {
+          bad++;
+        }
+      }
+      else if ( benchModelLen[i] != 0 )
+      {
+        bad++;
+      }
+    }
+    else if ( rand() % 200 == 0 )
+    {
+      // Reset, flushing first as the application must.
+      osal_snv_flush();
+      if ( osal_snv_init() != SUCCESS )
+      {
+        return ( 1 );
+      }
+    }
+
+    halSimRun( BENCH_SOAK_GAP );
+  }
+
+  osal_snv_flush();
+  if ( osal_snv_init() != SUCCESS )
+  {
+    return ( 1 );
+  }
+
+  for ( i = 0; i < BENCH_SOAK_IDS; i++ )
+  {
+    if ( (benchModelLen[i] != 0) &&
+         ((osal_snv_read( (osalSnvId_t)(BENCH_FIRST_ID + i), benchModelLen[i],
+                          buf ) != SUCCESS) ||
+          memcmp( buf, benchModel[i], benchModelLen[i] )) )
+    {
+      bad++;
+    }
+  }
+
+  halSimFlashGetStats( &stats );
+
+  printf( "%u ops, %u writes, seed %u: %u bytes appended, %u erases, "
+          "%u bad reads\n", (unsigned)ops, (unsigned)writes, (unsigned)seed,
+          (unsigned)(stats.words * HAL_FLASH_WORD_SIZE),
+          (unsigned)stats.erases, (unsigned)bad );
+
+  return ( (bad != 0) ? 1 : 0 );
+}
+
+/*********************************************************************
+ * @fn      benchNoOp
+ *
+ * @brief   Rewrite items with their own value and print the cost.
+ *
+ * @param   none
+ *
+ * @return  0 if every write succeeded and appended nothing
+ */
+static int benchNoOp( void )
+{
+  static const uint8 lens[] = { 8, 32, 64, BENCH_NOOP_ITEM_MAX };
+  uint8 buf[BENCH_NOOP_ITEM_MAX];
+  halSimFlashStats_t before, after;
+  uint64 cycles;
+  uint32 k;
+  uint8 t, i;
+
+  printf( "  len   flash reads/write   host cycles/write\n" );
+
+  for ( t = 0; t < sizeof( lens ); t++ )
+  {
+    osalSnvId_t first = BENCH_FIRST_ID + t * BENCH_NOOP_IDS;
+
+    for ( i = 0; i < BENCH_NOOP_IDS; i++ )
+    {
+      osal_memset( buf, 0x11 * i, lens[t] );
+      if ( osal_snv_write( first + i, lens[t], buf ) != SUCCESS )
+      {
+        return ( 1 );
+      }
+    }
+
+    halSimFlashGetStats( &before );
+    cycles = 0;
+
+    for ( k = 0; k < BENCH_NOOP_WRITES; k++ )
+    {
+      uint64 start;
+
+      i = k % BENCH_NOOP_IDS;
+      osal_memset( buf, 0x11 * i, lens[t] );
+
+      start = halMcuCycles();
+      if ( osal_snv_write( first + i, lens[t], buf ) != SUCCESS )
+      {
+        return ( 1 );
+      }
+      cycles += halMcuCycles() - start;
+    }
+
+    halSimFlashGetStats( &after );
+    if ( after.words != before.words )
+    {
+      return ( 1 );
+    }
+
+    printf( "  %3u   %17.1f   %17llu\n", (unsigned)lens[t],
+            (double)(after.reads - before.reads) / BENCH_NOOP_WRITES,
+            (unsigned long long)(cycles / BENCH_NOOP_WRITES) );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark chosen by the arguments.
+ *
+ * @param   argc - argument count
+ * @param   argv - gap between writes in milliseconds, "writeback"
+ *                 followed by the operation count and seed, or "noop"
+ *
+ * @return  0 if the benchmark succeeded
+ */
+int main( int argc, char **argv )
+{
+  halSimInit();
+  if ( (osal_init_system() != SUCCESS) || !halSimFlashOpen( NULL ) ||
+       (osal_snv_init() != SUCCESS) )
+  {
+    return ( 1 );
+  }
+
+  if ( (argc > 1) && (strcmp( argv[1], "writeback" ) == 0) )
+  {
+    return ( benchWriteBack( (argc > 2) ? (uint32)atoi( argv[2] ) : 100000,
+                             (argc > 3) ? (uint32)atoi( argv[3] ) : 1 ) );
+  }
+
+  if ( (argc > 1) && (strcmp( argv[1], "noop" ) == 0) )
+  {
+    return ( benchNoOp() );
+  }
+
+  return ( benchLatency( (argc > 1) ? (uint32)atoi( argv[1] ) : 20 ) );
+}
+
+/*********************************************************************
+*********************************************************************/
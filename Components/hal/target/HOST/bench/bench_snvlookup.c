@@ -0,0 +1,217 @@
+/******************************************************************************
+
+ @file  bench_snvlookup.c
+
+ @brief Host benchmark of SNV item lookup against the number of items.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * Components/osal/mcu/cc2540/osal_snv.c and
+ * Components/hal/target/HOST/hal_sim_flash.c. The RAM index holds 32 IDs
+ * by default; add -DOSAL_NV_INDEX_SIZE=128 for one that holds all 64.
+ *
+ * 4, 16, 32 and then 64 items of BENCH_ITEM_LEN bytes are written, and
+ * after each step BENCH_READS osal_snv_read() calls of a random item
+ * (hit) and of a random ID never written (miss) are timed. Each line gives
+ * the median host cycles of a read and the flash reads it took on
+ * average, including the one of the item data on a hit; on the target
+ * each flash read maps the bank in a critical section.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_types.h"
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "osal_snv.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_READS               20001
+#define BENCH_ITEM_LEN            4
+#define BENCH_FIRST_ID            0x80
+#define BENCH_MISS_ID             0xC0
+#define BENCH_MISS_IDS            48
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint64 benchCycles[BENCH_READS];
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   The benchmark has no tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      bench_Cmp
+ *
+ * @brief   qsort() comparison of two cycle counts.
+ *
+ * @param   a, b - cycle counts
+ *
+ * @return  <0, 0 or >0
+ */
+static int bench_Cmp( const void *a, const void *b )
+{
+  uint64 x = *(const uint64 *)a;
+  uint64 y = *(const uint64 *)b;
+
+  return ( (x > y) - (x < y) );
+}
+
+/*********************************************************************
+ * @fn      bench_Reads
+ *
+ * @brief   Time reads of random IDs.
+ *
+ * @param   firstId - first ID to read
+ * @param   ids - number of IDs to read from
+ * @param   pFlashReads - where to return the flash reads per read, x10
+ *
+ * @return  median host cycles of a read
+ */
+static uint64 bench_Reads( uint8 firstId, uint8 ids, uint32 *pFlashReads )
+{
+  halSimFlashStats_t before, after;
+  uint8 buf[BENCH_ITEM_LEN];
+  uint32 i;
+
+  halSimFlashGetStats( &before );
+
+  for ( i = 0; i < BENCH_READS; i++ )
+  {
+    osalSnvId_t id = (osalSnvId_t)(firstId + (rand() % ids));
+    uint64 start = halMcuCycles();
+
+    VOID osal_snv_read( id, sizeof( buf ), buf );
+    benchCycles[i] = halMcuCycles() - start;
+  }
+
+  halSimFlashGetStats( &after );
+  *pFlashReads = ((after.reads - before.reads) * 10) / BENCH_READS;
+
+  qsort( benchCycles, BENCH_READS, sizeof( uint64 ), bench_Cmp );
+
+  return ( benchCycles[BENCH_READS / 2] );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the benchmark and print one line per item count.
+ *
+ * @param   none
+ *
+ * @return  0 if every write succeeded
+ */
+int main( void )
+{
+  static const uint8 counts[] = { 4, 16, 32, 64 };
+  uint8 buf[BENCH_ITEM_LEN];
+  uint8 items = 0;
+  uint8 k;
+
+  halSimInit();
+  if ( (osal_init_system() != SUCCESS) || !halSimFlashOpen( NULL ) ||
+       (osal_snv_init() != SUCCESS) )
+  {
+    return ( 1 );
+  }
+
+  for ( k = 0; k < sizeof( counts ); k++ )
+  {
+    uint64 hit, miss;
+    uint32 hitReads, missReads;
+
+    for ( ; items < counts[k]; items++ )
+    {
+      osal_memset( buf, items, sizeof( buf ) );
+      if ( osal_snv_write( (osalSnvId_t)(BENCH_FIRST_ID + items),
+                           sizeof( buf ), buf ) != SUCCESS )
+      {
+        return ( 1 );
+      }
+    }
+
+    hit = bench_Reads( BENCH_FIRST_ID, items, &hitReads );
+    miss = bench_Reads( BENCH_MISS_ID, BENCH_MISS_IDS, &missReads );
+
+    printf( "items %2u: hit %5llu cycles %3u.%u flash reads, "
+            "miss %5llu cycles %3u.%u flash reads\n", items,
+            (unsigned long long)hit, (unsigned)(hitReads / 10),
+            (unsigned)(hitReads % 10), (unsigned long long)miss,
+            (unsigned)(missReads / 10), (unsigned)(missReads % 10) );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
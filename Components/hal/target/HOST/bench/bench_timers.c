@@ -0,0 +1,254 @@
+/******************************************************************************
+
+ @file  bench_timers.c
+
+ @brief Host soak test of the OSAL timer record pool.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*
+ * Build with the command line in hal_sim.h, this file as the harness, plus
+ * -DOSALMEM_METRICS=TRUE -Wl,--wrap=osal_mem_alloc,--wrap=osal_mem_free
+ * so that every heap operation passes through the counters below. Add
+ * -DOSAL_TIMERS_POOL_SIZE=0 for the timers of before the pool, which took
+ * each record from the heap.
+ *
+ * For BENCH_SOAK_TIME virtual milliseconds, task 0 restarts a 100ms timer
+ * and sends itself a message each time it fires, both tasks restart a 7ms
+ * timer, and task 1 runs a 33ms reload timer. Allocations other than the
+ * messages are timer records, and osal_heap_block_max() shows how far the
+ * heap got cut up.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+
+#include "hal_types.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Timers.h"
+#include "OSAL_Memory.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_SOAK_TIME           600000
+
+// Timer events
+#define BENCH_PERIODIC_EVT        0x0001
+#define BENCH_FAST_EVT            0x0002
+#define BENCH_RELOAD_EVT          0x0004
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+const pTaskEventHandlerFn tasksArr[] =
+{
+  bench_ProcessEvent,
+  bench_ProcessEvent
+};
+
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint32 benchAllocs;
+static uint32 benchFrees;
+static uint32 benchMsgs;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+extern void *__real_osal_mem_alloc( uint16 size );
+extern void __real_osal_mem_free( void *ptr );
+
+/*********************************************************************
+ * @fn      __wrap_osal_mem_alloc
+ *
+ * @brief   Count an allocation (-Wl,--wrap=osal_mem_alloc).
+ *
+ * @param   size - number of bytes to allocate
+ *
+ * @return  pointer to the allocation, NULL on failure
+ */
+void *__wrap_osal_mem_alloc( uint16 size )
+{
+  benchAllocs++;
+
+  return ( __real_osal_mem_alloc( size ) );
+}
+
+/*********************************************************************
+ * @fn      __wrap_osal_mem_free
+ *
+ * @brief   Count a free (-Wl,--wrap=osal_mem_free).
+ *
+ * @param   ptr - allocation to free
+ *
+ * @return  none
+ */
+void __wrap_osal_mem_free( void *ptr )
+{
+  benchFrees++;
+
+  __real_osal_mem_free( ptr );
+}
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Start the timers of both tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  VOID osal_start_timerEx( 0, BENCH_PERIODIC_EVT, 100 );
+  VOID osal_start_timerEx( 0, BENCH_FAST_EVT, 7 );
+  VOID osal_start_reload_timer( 1, BENCH_RELOAD_EVT, 33 );
+  VOID osal_start_timerEx( 1, BENCH_FAST_EVT, 13 );
+}
+
+/*********************************************************************
+ * @fn      bench_ProcessEvent
+ *
+ * @brief   Restart the timers, and send and receive the messages.
+ *
+ * @param   task_id - task
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+static uint16 bench_ProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *pMsg;
+
+    while ( (pMsg = osal_msg_receive( task_id )) != NULL )
+    {
+      VOID osal_msg_deallocate( pMsg );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( (task_id == 0) && (events & BENCH_PERIODIC_EVT) )
+  {
+    uint8 *pMsg;
+
+    VOID osal_start_timerEx( task_id, BENCH_PERIODIC_EVT, 100 );
+
+    pMsg = osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+    if ( pMsg != NULL )
+    {
+      VOID osal_msg_send( task_id, pMsg );
+      benchMsgs++;
+    }
+  }
+
+  if ( events & BENCH_FAST_EVT )
+  {
+    VOID osal_start_timerEx( task_id, BENCH_FAST_EVT, 7 );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Run the soak and print the heap operations.
+ *
+ * @param   none
+ *
+ * @return  0
+ */
+int main( void )
+{
+  uint32 allocs, frees;
+
+  halSimInit();
+  if ( osal_init_system() != SUCCESS )
+  {
+    return ( 1 );
+  }
+  osal_mem_kick();
+
+  allocs = benchAllocs;
+  frees = benchFrees;
+
+  halSimRun( BENCH_SOAK_TIME );
+
+  allocs = benchAllocs - allocs;
+  frees = benchFrees - frees;
+
+  printf( "%u allocs, %u frees, %u messages, %u timer record allocs, "
+          "%u pool overflows, osal_heap_block_max() %u\n",
+          (unsigned)allocs, (unsigned)frees, (unsigned)benchMsgs,
+          (unsigned)(allocs - benchMsgs),
+          (unsigned)osal_timer_pool_overflow(), osal_heap_block_max() );
+
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
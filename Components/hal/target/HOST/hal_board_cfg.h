@@ -0,0 +1,174 @@
+/******************************************************************************
+
+ @file  hal_board_cfg.h
+
+ @brief Board configuration for the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+#ifndef HAL_BOARD_CFG_H
+#define HAL_BOARD_CFG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include "hal_mcu.h"
+#include "hal_defs.h"
+#include "hal_types.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ */
+
+/* Board Identifier */
+
+#define HAL_BOARD_HOST
+
+/* Clock Speed - the simulated core runs at the CC254x system clock */
+
+#define HAL_CPU_CLOCK_MHZ             32
+
+/* LED Configuration */
+
+#define HAL_NUM_LEDS                  0
+
+/* OSAL NV implemented by the simulated internal flash of hal_sim_flash.c,
+ * laid out as on a CC2540F256.
+ */
+
+// Flash is partitioned into 8 banks of 32 KB or 16 pages.
+#define HAL_FLASH_PAGE_PER_BANK        16
+
+// Flash is constructed of 128 pages of 2 KB.
+#define HAL_FLASH_PAGE_PHYS            2048
+
+#define HAL_FLASH_PAGE_SIZE            HAL_FLASH_PAGE_PHYS
+#define HAL_FLASH_WORD_SIZE            4
+
+// The last 16 bytes of the last available page are reserved for flash lock bits.
+#define HAL_FLASH_LOCK_BITS            16
+
+#define HAL_NV_PAGE_END                126
+
+#define HAL_FLASH_IEEE_SIZE            8
+#define HAL_FLASH_IEEE_PAGE            (HAL_NV_PAGE_END+1)
+#define HAL_FLASH_IEEE_OSET            (HAL_FLASH_PAGE_SIZE - HAL_FLASH_LOCK_BITS - HAL_FLASH_IEEE_SIZE)
+
+#ifndef HAL_NV_PAGE_CNT
+#define HAL_NV_PAGE_CNT                2
+#endif
+#define HAL_NV_PAGE_BEG                (HAL_NV_PAGE_END-HAL_NV_PAGE_CNT+1)
+
+/*******************************************************************************
+ * MACROS
+ */
+
+/* Board Initialization */
+#define HAL_BOARD_INIT()
+
+/* Debounce */
+#define HAL_DEBOUNCE(expr)    { int i; for (i=0; i<500; i++) { if (!(expr)) i = 0; } }
+
+/* Driver Configuration */
+
+/* The host simulation only provides the drivers modeled in hal_sim.c;
+ * the flash driver comes from hal_sim_flash.c when that is linked in.
+ */
+#ifndef HAL_TIMER
+#define HAL_TIMER FALSE
+#endif
+
+#ifndef HAL_ADC
+#define HAL_ADC FALSE
+#endif
+
+#ifndef HAL_DMA
+#define HAL_DMA FALSE
+#endif
+
+#ifndef HAL_FLASH
+#define HAL_FLASH FALSE
+#endif
+
+#ifndef HAL_AES
+#define HAL_AES FALSE
+#endif
+
+#ifndef HAL_AES_DMA
+#define HAL_AES_DMA FALSE
+#endif
+
+#ifndef HAL_LCD
+#define HAL_LCD FALSE
+#endif
+
+#ifndef HAL_LED
+#define HAL_LED FALSE
+#endif
+
+#ifndef HAL_KEY
+#define HAL_KEY FALSE
+#endif
+
+#ifndef HAL_UART
+#define HAL_UART FALSE
+#endif
+
+#define HAL_UART_DMA  0
+#define HAL_UART_ISR  0
+#define HAL_UART_SPI  0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_BOARD_CFG_H */
+
+/*******************************************************************************
+*/
@@ -0,0 +1,167 @@
+/******************************************************************************
+
+ @file  hal_mcu.h
+
+ @brief MCU abstraction for the host (Linux/GCC) simulation target: a
+        simulated EA bit whose critical sections are timed with the host
+        cycle counter.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+#ifndef _HAL_MCU_H
+#define _HAL_MCU_H
+
+/*
+ *  Target : Host (Linux/GCC) simulation of the CC254x 8051 core
+ *
+ */
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <stdlib.h>
+
+#include "hal_defs.h"
+#include "hal_types.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Target Defines
+ * ------------------------------------------------------------------------------------------------
+ */
+#define HAL_MCU_HOST
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Compiler Abstraction
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* ---------------------- GNU Compiler ---------------------- */
+#ifdef __GNUC__
+
+#define HAL_COMPILER_GNU
+#define HAL_MCU_LITTLE_ENDIAN()   (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HAL_ISR_FUNC_DECLARATION(f,v)   void f(void)
+#define HAL_ISR_FUNC_PROTOTYPE(f,v)     void f(void)
+#define HAL_ISR_FUNCTION(f,v)           HAL_ISR_FUNC_PROTOTYPE(f,v); HAL_ISR_FUNC_DECLARATION(f,v)
+
+/* ------------------ Unrecognized Compiler ------------------ */
+#else
+#error "ERROR: Unknown compiler."
+#endif
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Interrupt Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* The simulated EA bit. There are no real interrupts on the host, but every transition from
+ * enabled to disabled and back is timed with the host cycle counter so that the length of the
+ * OSAL critical sections can be measured (see halMcuCsStats_t).
+ */
+extern volatile uint8 halMcuEA;
+
+#define HAL_ENABLE_INTERRUPTS()         st( halMcuEA = 1; )
+#define HAL_DISABLE_INTERRUPTS()        st( halMcuEA = 0; )
+#define HAL_INTERRUPTS_ARE_ENABLED()    (halMcuEA)
+
+typedef unsigned char halIntState_t;
+#define HAL_ENTER_CRITICAL_SECTION(x)   st( x = halMcuEA; HAL_DISABLE_INTERRUPTS(); if (x) halMcuCsEnter(); )
+#define HAL_EXIT_CRITICAL_SECTION(x)    st( if ((x) && !halMcuEA) halMcuCsExit(); halMcuEA = x; )
+#define HAL_CRITICAL_STATEMENT(x)       st( halIntState_t _s; HAL_ENTER_CRITICAL_SECTION(_s); x; HAL_EXIT_CRITICAL_SECTION(_s); )
+
+#define HAL_ENTER_ISR()
+#define HAL_EXIT_ISR()
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Reset Macro
+ * ------------------------------------------------------------------------------------------------
+ */
+#define WD_KICK()
+
+/* A reset (or HAL_ASSERT_RESET) on the host terminates the simulation. */
+#define HAL_SYSTEM_RESET()  st( HAL_DISABLE_INTERRUPTS(); abort(); )
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Sleep Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+#define CLEAR_SLEEP_MODE()
+#define ALLOW_SLEEP_MODE()
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Cycle Counters
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* Critical section statistics, in host cycles as returned by halMcuCycles(). */
+typedef struct
+{
+  uint32 count;   // Number of outermost critical sections entered.
+  uint64 total;   // Total cycles spent with interrupts disabled.
+  uint64 max;     // Longest single critical section.
+} halMcuCsStats_t;
+
+/*
+ * Free running host cycle counter (TSC on x86, monotonic nanoseconds elsewhere).
+ */
+extern uint64 halMcuCycles( void );
+
+/*
+ * Critical section bookkeeping invoked by the interrupt macros above.
+ */
+extern void halMcuCsEnter( void );
+extern void halMcuCsExit( void );
+
+/*
+ * Read and clear the critical section statistics.
+ */
+extern void halMcuCsGetStats( halMcuCsStats_t *pStats );
+extern void halMcuCsResetStats( void );
+
+/**************************************************************************************************
+ */
+#endif
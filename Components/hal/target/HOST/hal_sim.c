@@ -0,0 +1,495 @@
+/******************************************************************************
+
+ @file  hal_sim.c
+
+ @brief Virtual clock, simulated sleep and critical section timing for
+        the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <time.h>
+#if defined __i386__ || defined __x86_64__
+#include <x86intrin.h>
+#endif
+
+#include "hal_mcu.h"
+#include "hal_sim.h"
+#include "hal_sleep.h"
+#include "hal_drivers.h"
+#include "hal_key.h"
+#include "OSAL.h"
+#include "OnBoard.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Simulated EA bit; interrupts start out enabled.
+volatile uint8 halMcuEA = 1;
+
+uint8 Hal_TaskID;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Virtual clock, in microseconds.
+static uint64 halSimClock;
+
+// End of the current halSimRun() window, in microseconds.
+static uint64 halSimDeadline;
+
+static halSimSleepStats_t halSimSleepStats;
+
+// Advertising interval (units of 625us, 0 when off), the time of the last
+// advertising event counted and the events so far.
+static uint16 halSimAdvInt;
+static uint64 halSimAdvLast;
+static uint32 halSimAdvEvents;
+
+// Critical section bookkeeping.
+static uint64 halMcuCsStart;
+static halMcuCsStats_t halMcuCsStats;
+
+/*********************************************************************
+ * @fn      halMcuCycles
+ *
+ * @brief   Read the free running host cycle counter.
+ *
+ * @param   none
+ *
+ * @return  Host cycles (TSC on x86, nanoseconds otherwise).
+ */
+uint64 halMcuCycles( void )
+{
+#if defined __i386__ || defined __x86_64__
+  return ( __rdtsc() );
+#else
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC_RAW, &ts );
+
+  return ( ((uint64)ts.tv_sec * 1000000000ULL) + (uint64)ts.tv_nsec );
+#endif
+}
+
+/*********************************************************************
+ * @fn      halMcuCsEnter
+ *
+ * @brief   Mark the start of an outermost critical section.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halMcuCsEnter( void )
+{
+  halMcuCsStart = halMcuCycles();
+}
+
+/*********************************************************************
+ * @fn      halMcuCsExit
+ *
+ * @brief   Account for the end of an outermost critical section.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halMcuCsExit( void )
+{
+  uint64 len = halMcuCycles() - halMcuCsStart;
+
+  halMcuCsStats.count++;
+  halMcuCsStats.total += len;
+  if ( halMcuCsStats.max < len )
+  {
+    halMcuCsStats.max = len;
+  }
+}
+
+/*********************************************************************
+ * @fn      halMcuCsGetStats
+ *
+ * @brief   Read the critical section statistics.
+ *
+ * @param   pStats - where to copy the statistics
+ *
+ * @return  none
+ */
+void halMcuCsGetStats( halMcuCsStats_t *pStats )
+{
+  *pStats = halMcuCsStats;
+}
+
+/*********************************************************************
+ * @fn      halMcuCsResetStats
+ *
+ * @brief   Clear the critical section statistics.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halMcuCsResetStats( void )
+{
+  halMcuCsStats.count = 0;
+  halMcuCsStats.total = 0;
+  halMcuCsStats.max = 0;
+}
+
+/*********************************************************************
+ * @fn      halSimInit
+ *
+ * @brief   Reset the virtual clock and all simulation statistics.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halSimInit( void )
+{
+  halSimClock = 0;
+  halSimDeadline = 0;
+
+  halSimSleepStats.count = 0;
+  halSimSleepStats.sleepUs = 0;
+  halSimSleepStats.awakeUs = 0;
+
+  halSimAdvInt = 0;
+  halSimAdvLast = 0;
+  halSimAdvEvents = 0;
+
+  halMcuEA = 1;
+  halMcuCsResetStats();
+}
+
+/*********************************************************************
+ * @fn      halSimAdvance
+ *
+ * @brief   Advance the virtual clock while the processor is awake.
+ *
+ * @param   usec - microseconds to advance
+ *
+ * @return  none
+ */
+void halSimAdvance( uint32 usec )
+{
+  halSimClock += usec;
+  halSimSleepStats.awakeUs += usec;
+}
+
+/*********************************************************************
+ * @fn      halSimTime
+ *
+ * @brief   Read the virtual clock.
+ *
+ * @param   none
+ *
+ * @return  Microseconds since halSimInit().
+ */
+uint64 halSimTime( void )
+{
+  return ( halSimClock );
+}
+
+/*********************************************************************
+ * @fn      halSimRun
+ *
+ * @brief   Drive osal_run_system() for a window of virtual time. Each
+ *          pass that finds no task ready and does not sleep advances
+ *          the clock by HAL_SIM_IDLE_STEP_US; with POWER_SAVING the
+ *          clock jumps straight to the next OSAL timeout instead.
+ *
+ * @param   msec - virtual milliseconds to run
+ *
+ * @return  none
+ */
+void halSimRun( uint32 msec )
+{
+  halSimDeadline = halSimClock + ((uint64)msec * 1000);
+
+  while ( halSimClock < halSimDeadline )
+  {
+    uint32 sleeps = halSimSleepStats.count;
+
+#if (defined HAL_SIM_LINK) && (HAL_SIM_LINK == TRUE)
+    halSimLinkPoll();
+#endif
+
+    osal_run_system();
+
+    if ( (sleeps == halSimSleepStats.count) && !osal_tasks_ready() )
+    {
+      halSimAdvance( HAL_SIM_IDLE_STEP_US );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimGetSleepStats
+ *
+ * @brief   Read the sleep statistics of the simulated processor.
+ *
+ * @param   pStats - where to copy the statistics
+ *
+ * @return  none
+ */
+void halSimGetSleepStats( halSimSleepStats_t *pStats )
+{
+  *pStats = halSimSleepStats;
+}
+
+/*********************************************************************
+ * @fn      halSimAdvCount
+ *
+ * @brief   Count the advertising events up to the virtual clock.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void halSimAdvCount( void )
+{
+  if ( halSimAdvInt != 0 )
+  {
+    uint64 period = ((uint64)halSimAdvInt * HAL_SIM_LL_TICK_US) + HAL_SIM_ADV_DELAY_US;
+    uint64 events = (halSimClock - halSimAdvLast) / period;
+
+    halSimAdvEvents += (uint32)events;
+    halSimAdvLast += events * period;
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimAdvSet
+ *
+ * @brief   Report an advertising start, stop or interval change. The
+ *          first event goes out as advertising starts.
+ *
+ * @param   interval - advertising interval in 625us units, 0 for off
+ *
+ * @return  none
+ */
+void halSimAdvSet( uint16 interval )
+{
+  halSimAdvCount();
+
+  if ( (halSimAdvInt == 0) && (interval != 0) )
+  {
+    halSimAdvEvents++;
+    halSimAdvLast = halSimClock;
+  }
+
+  halSimAdvInt = interval;
+}
+
+/*********************************************************************
+ * @fn      halSimGetCurrent
+ *
+ * @brief   Estimate the supply current from the time spent asleep and
+ *          awake and from the advertising events, using
+ *          HAL_SIM_SLEEP_NA, HAL_SIM_AWAKE_UA and HAL_SIM_ADV_EVENT_NC.
+ *
+ * @param   pStats - where to copy the estimate
+ *
+ * @return  none
+ */
+void halSimGetCurrent( halSimCurrent_t *pStats )
+{
+  halSimAdvCount();
+
+  pStats->advEvents = halSimAdvEvents;
+  pStats->chargeNc = ((halSimSleepStats.sleepUs * HAL_SIM_SLEEP_NA) / 1000000) +
+                     ((halSimSleepStats.awakeUs * HAL_SIM_AWAKE_UA) / 1000) +
+                     ((uint64)halSimAdvEvents * HAL_SIM_ADV_EVENT_NC);
+  pStats->avgNa = (halSimClock != 0) ?
+                  (uint32)((pStats->chargeNc * 1000000) / halSimClock) : 0;
+}
+
+/*********************************************************************
+ * @fn      ll_McuPrecisionCount
+ *
+ * @brief   Virtual free running 625us link layer counter.
+ *
+ * @param   none
+ *
+ * @return  Current 16-bit tick count.
+ */
+uint16 ll_McuPrecisionCount( void )
+{
+  return ( (uint16)(halSimClock / HAL_SIM_LL_TICK_US) );
+}
+
+/*********************************************************************
+ * @fn      halSleep
+ *
+ * @brief   Simulated sleep: jump the virtual clock to the next OSAL
+ *          timeout, or to the end of the halSimRun() window when no
+ *          timer is running, for at most HAL_SIM_MAX_SLEEP_MS and no
+ *          later than the next connection event with HAL_SIM_LINK.
+ *
+ * @param   osal_timer - next OSAL timeout in milliseconds, 0 if none
+ *
+ * @return  none
+ */
+void halSleep( uint32 osal_timer )
+{
+  uint64 wake = halSimDeadline;
+
+  if ( (osal_timer != 0) && (osal_timer < MIN_SLEEP_TIME) )
+  {
+    return;
+  }
+
+  if ( (osal_timer == 0) || (osal_timer > HAL_SIM_MAX_SLEEP_MS) )
+  {
+    osal_timer = HAL_SIM_MAX_SLEEP_MS;
+  }
+
+  if ( (halSimClock + ((uint64)osal_timer * 1000)) < wake )
+  {
+    wake = halSimClock + ((uint64)osal_timer * 1000);
+  }
+
+#if (defined HAL_SIM_LINK) && (HAL_SIM_LINK == TRUE)
+  if ( (halSimLinkNext() != 0) && (halSimLinkNext() < wake) )
+  {
+    wake = halSimLinkNext();
+  }
+#endif
+
+  if ( wake > halSimClock )
+  {
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+    HalKeyEnterSleep();
+#endif
+
+    halSimSleepStats.count++;
+    halSimSleepStats.sleepUs += wake - halSimClock;
+    halSimClock = wake;
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+    (void)HalKeyExitSleep();
+#endif
+  }
+}
+
+/*********************************************************************
+ * @fn      Hal_Init
+ *
+ * @brief   Hal initialization function.
+ *
+ * @param   task_id - Hal TaskId
+ *
+ * @return  none
+ */
+void Hal_Init( uint8 task_id )
+{
+  Hal_TaskID = task_id;
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+  HalKeyInit();
+#endif
+}
+
+/*********************************************************************
+ * @fn      Hal_ProcessEvent
+ *
+ * @brief   Hal process event, for the drivers the host simulates.
+ *
+ * @param   task_id - Hal TaskId
+ * @param   events - events
+ *
+ * @return  events not processed
+ */
+uint16 Hal_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    uint8 *msgPtr;
+
+    while ( (msgPtr = osal_msg_receive( Hal_TaskID )) != NULL )
+    {
+      osal_msg_deallocate( msgPtr );
+    }
+    return events ^ SYS_EVENT_MSG;
+  }
+
+  if ( events & HAL_KEY_EVENT )
+  {
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+    /* Check for keys */
+    HalKeyPoll();
+
+    /* if interrupt disabled, do next polling */
+    if ( !Hal_KeyIntEnable )
+    {
+      osal_start_timerEx( Hal_TaskID, HAL_KEY_EVENT, 100 );
+    }
+#endif
+    return events ^ HAL_KEY_EVENT;
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+ * @fn      Hal_ProcessPoll
+ *
+ * @brief   Nothing to poll on the host.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void Hal_ProcessPoll( void )
+{
+}
+
+/*********************************************************************
+*********************************************************************/
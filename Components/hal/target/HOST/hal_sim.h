@@ -0,0 +1,387 @@
+/******************************************************************************
+
+ @file  hal_sim.h
+
+ @brief Virtual clock and scheduler driver for the host (Linux/GCC)
+        simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED �AS IS� WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+/*
+ * The host port builds Components/osal/common with GCC against this
+ * directory and Projects/ble/common/host in place of the CC254x target
+ * and board directories:
+ *
+ *   include path: Components/hal/target/HOST, Components/hal/include,
+ *                 Components/osal/include, Projects/ble/common/host,
+ *                 Components/ble/include, Components/ble/host,
+ *                 Components/ble/controller/CC254x/include,
+ *                 Components/services/saddr
+ *   defines:      POWER_SAVING (optional), HAL_ASSERT_RESET, ASSERT_WHILE,
+ *                 OSAL_CBTIMER_NUM_TASKS=1 (osal_cbtimer.c),
+ *                 OAD_KEEP_NV_PAGES (osal_snv.c)
+ *   sources:      OSAL*.c, osal_*.c, hal_assert.c, hal_sim.c, OnBoard.c,
+ *                 plus the harness providing tasksArr[], tasksCnt,
+ *                 tasksEvents and osalInitTasks().
+ *
+ * With gcc from the repository root, for harness.c:
+ *
+ *   O=Components/osal/common
+ *   gcc -std=gnu99 -DPOWER_SAVING -DHAL_ASSERT_RESET -DASSERT_WHILE \
+ *       -DOSAL_CBTIMER_NUM_TASKS=1 -DOAD_KEEP_NV_PAGES \
+ *       -IComponents/hal/target/HOST -IComponents/hal/include \
+ *       -IComponents/osal/include -IProjects/ble/common/host \
+ *       -IComponents/ble/include -IComponents/ble/host \
+ *       -IComponents/ble/controller/CC254x/include \
+ *       -IComponents/services/saddr \
+ *       $O/OSAL.c $O/OSAL_Timers.c $O/OSAL_Memory.c $O/OSAL_ClockBLE.c \
+ *       $O/OSAL_PwrMgr.c $O/osal_bufmgr.c $O/osal_cbtimer.c \
+ *       Components/hal/common/hal_assert.c \
+ *       Components/hal/target/HOST/hal_sim.c \
+ *       Projects/ble/common/host/OnBoard.c harness.c
+ *
+ * The benchmarks in bench/ are such harnesses; each names what it adds to
+ * this command line.
+ *
+ * The harness calls halSimInit() and osal_init_system(), then drives the
+ * scheduler with halSimRun(). Elapsed virtual time reaches the OSAL timers
+ * through ll_McuPrecisionCount(), so runs are deterministic, while the
+ * critical sections are timed with the real host cycle counter.
+ *
+ * Adding hal_sim_heap.c to a build with OSALMEM_METRICS=TRUE provides
+ * halSimHeapReplay(), which replays a heap trace dumped from a device
+ * built with OSALMEM_TRACE=TRUE against the allocator of the host build.
+ *
+ * Adding hal_sim_flash.c provides HalFlashRead/Compare/Write/Erase() over
+ * a flash image that can be kept in a file (halSimFlashOpen()), so
+ * osal_snv.c or osal_snv_wl.c from Components/osal/mcu/cc2540 run on the
+ * host; define OAD_KEEP_NV_PAGES for osal_snv.c. Programming only clears
+ * bits, writes go by 4-byte words and erases by 2KB page, and every word
+ * written and page erased advances the virtual clock. Erase counts are
+ * kept per page in the image file.
+ *
+ * Building with HAL_KEY=TRUE and hal_sim_key.c adds the key driver, run by
+ * Hal_ProcessEvent() from the HAL task like hal_drivers.c on the target.
+ * halSimKeySet() drives its pins, including the mailbox switches, so that
+ * detection latency and sleep time can be measured against edges placed
+ * in virtual time.
+ *
+ * Building with HAL_SIM_LINK=TRUE and hal_sim_link.c, with
+ * Components/ble/controller/CC254x/include on the include path, adds one
+ * simulated connection (halSimLinkOpen()) and stands in for
+ * GATT_Notification(), GATT_Indication(), GATT_bm_alloc/free(),
+ * ATT_GetMTU() and HCI_EXT_ConnEventNoticeCmd(), so that GATT server code
+ * and gattservapp_util.c run against the connection's PDU buffers and
+ * events. Connection events wake the simulated processor and each sends
+ * at most HAL_SIM_LINK_PKTS_PER_EVENT link layer packets, which bounds
+ * the notification throughput at a given interval and ATT MTU.
+ *
+ * halSimGetCurrent() estimates the average supply current from the time
+ * spent asleep and awake and from the advertising events, which a host
+ * build of an application reports by calling halSimAdvSet() from its
+ * GAPRole_SetParameter() and GAP_SetParamValue() stand-ins. Connection
+ * events are not counted.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Resolution of the link layer precision counter, in microseconds.
+#define HAL_SIM_LL_TICK_US        625
+
+// Virtual time that elapses for each idle pass of halSimRun() which
+// did not put the simulated processor to sleep, in microseconds.
+#if !defined HAL_SIM_IDLE_STEP_US
+#define HAL_SIM_IDLE_STEP_US      HAL_SIM_LL_TICK_US
+#endif
+
+// Pages of simulated flash, as on a CC2540F256.
+#if !defined HAL_SIM_FLASH_PAGES
+#define HAL_SIM_FLASH_PAGES       128
+#endif
+
+// Virtual time to program one flash word and to erase one page, in
+// microseconds.
+#if !defined HAL_SIM_FLASH_WORD_US
+#define HAL_SIM_FLASH_WORD_US     20
+#endif
+#if !defined HAL_SIM_FLASH_ERASE_US
+#define HAL_SIM_FLASH_ERASE_US    20000
+#endif
+
+// Erases a page survives before it stops erasing fully; 0 never wears out.
+#if !defined HAL_SIM_FLASH_ENDURANCE
+#define HAL_SIM_FLASH_ENDURANCE   20000
+#endif
+
+// Longest sleep, as MAX_SLEEP_TIMEOUT on the target, so that the 16-bit
+// ll_McuPrecisionCount() cannot wrap while asleep, in milliseconds.
+#if !defined HAL_SIM_MAX_SLEEP_MS
+#define HAL_SIM_MAX_SLEEP_MS      40000
+#endif
+
+// Current model: PM2 sleep current in nanoamps, awake current in
+// microamps, and the charge of one advertising event on all three
+// channels at 0dBm in nanocoulombs.
+#if !defined HAL_SIM_SLEEP_NA
+#define HAL_SIM_SLEEP_NA          1000
+#endif
+#if !defined HAL_SIM_AWAKE_UA
+#define HAL_SIM_AWAKE_UA          6700
+#endif
+#if !defined HAL_SIM_ADV_EVENT_NC
+#define HAL_SIM_ADV_EVENT_NC      30000
+#endif
+
+// PDU buffers of the simulated connection, as MAX_NUM_PDU on the target,
+// and the link layer packets it sends per connection event.
+#if !defined HAL_SIM_LINK_BUFFERS
+#define HAL_SIM_LINK_BUFFERS      4
+#endif
+#if !defined HAL_SIM_LINK_PKTS_PER_EVENT
+#define HAL_SIM_LINK_PKTS_PER_EVENT 4
+#endif
+
+// Link layer data payload per packet without data length extension, and
+// the connection interval unit in microseconds.
+#define HAL_SIM_LINK_PKT_LEN      27
+#define HAL_SIM_LINK_INT_US       1250
+
+// Mean of the 0-10ms random delay added to every advertising interval,
+// in microseconds.
+#define HAL_SIM_ADV_DELAY_US      5000
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Sleep statistics for the simulated processor.
+typedef struct
+{
+  uint32 count;    // Number of times halSleep() put the processor to sleep.
+  uint64 sleepUs;  // Total virtual time spent asleep.
+  uint64 awakeUs;  // Total virtual time spent awake.
+} halSimSleepStats_t;
+
+// Result of replaying a heap trace with halSimHeapReplay().
+typedef struct
+{
+  uint16 allocs;             // Allocations replayed.
+  uint16 frees;              // Frees replayed.
+  uint16 failures;           // Allocations that failed in the replay.
+  uint16 skipped;            // Records that could not be matched or decoded.
+  uint16 peakUsed;           // Most bytes allocated at once, including headers.
+  uint16 largestFreeAtPeak;  // Largest possible allocation at peakUsed.
+  uint8  fragAtPeak;         // Percentage of the free heap outside that largest run.
+  uint16 minLargestFree;     // Smallest largest-possible allocation seen.
+  uint16 blockMax;           // osal_heap_block_max() at the end of the replay.
+  uint16 searchMax;          // Most blocks visited by one first-fit search.
+} halSimHeapReplay_t;
+
+// Flash statistics since halSimFlashOpen().
+typedef struct
+{
+  uint32 reads;          // HalFlashRead() and HalFlashCompare() calls.
+  uint32 words;          // Flash words programmed.
+  uint32 erases;         // Pages erased.
+  uint32 setBits;        // Word writes that tried to set a cleared bit.
+  uint32 maxErases;      // Most lifetime erases of any one page.
+  uint8  maxWordWrites;  // Most writes to one word between two erases.
+  uint64 busyUs;         // Virtual time spent programming and erasing.
+} halSimFlashStats_t;
+
+// Key statistics since HalKeyInit().
+typedef struct
+{
+  uint32 edges;       // Pin edges driven by halSimKeySet().
+  uint32 interrupts;  // Simulated port interrupts.
+  uint32 polls;       // HalKeyPoll() calls.
+  uint32 reports;     // Key changes reported to the callback.
+} halSimKeyStats_t;
+
+// Simulated connection statistics since halSimLinkOpen().
+typedef struct
+{
+  uint32 connEvents;     // Connection events.
+  uint32 notifications;  // Notifications and indications sent.
+  uint32 refused;        // Sends refused for want of a PDU buffer.
+  uint32 packets;        // Link layer packets sent.
+  uint32 bytes;          // Attribute value bytes sent.
+} halSimLinkStats_t;
+
+// Called with the handle and value of each notification or indication sent.
+typedef void (*halSimLinkRxCB_t)( uint16 handle, uint8 *pValue, uint8 len );
+
+// Supply current estimate since halSimInit().
+typedef struct
+{
+  uint32 advEvents;  // Advertising events.
+  uint64 chargeNc;   // Estimated charge drawn, in nanocoulombs.
+  uint32 avgNa;      // Estimated average current, in nanoamps.
+} halSimCurrent_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Reset the virtual clock and all simulation statistics.
+ */
+extern void halSimInit( void );
+
+/*
+ * Advance the virtual clock by the given number of microseconds.
+ */
+extern void halSimAdvance( uint32 usec );
+
+/*
+ * Read the virtual clock in microseconds since halSimInit().
+ */
+extern uint64 halSimTime( void );
+
+/*
+ * Run the OSAL scheduler for the given number of virtual milliseconds.
+ */
+extern void halSimRun( uint32 msec );
+
+/*
+ * Read the sleep statistics of the simulated processor.
+ */
+extern void halSimGetSleepStats( halSimSleepStats_t *pStats );
+
+/*
+ * Replay a heap trace against a fresh heap (hal_sim_heap.c).
+ */
+extern void halSimHeapReplay( const uint8 *pTrace, uint32 len, halSimHeapReplay_t *pStats );
+
+/*
+ * Map the simulated flash onto an image file, or memory if path is NULL (hal_sim_flash.c).
+ */
+extern uint8 halSimFlashOpen( const char *path );
+
+/*
+ * Write back and unmap the simulated flash image.
+ */
+extern void halSimFlashClose( void );
+
+/*
+ * Read the flash statistics since halSimFlashOpen().
+ */
+extern void halSimFlashGetStats( halSimFlashStats_t *pStats );
+
+/*
+ * Read the lifetime erase count of a flash page.
+ */
+extern uint32 halSimFlashEraseCount( uint8 pg );
+
+/*
+ * Drive the simulated key pins (hal_sim_key.c).
+ */
+extern void halSimKeySet( uint8 keys );
+
+/*
+ * Read the key statistics.
+ */
+extern void halSimKeyGetStats( halSimKeyStats_t *pStats );
+
+/*
+ * Bring up the simulated connection with handle 0 (hal_sim_link.c).
+ */
+extern void halSimLinkOpen( uint16 connInterval, uint16 mtu, halSimLinkRxCB_t pfnRx );
+
+/*
+ * Drop the simulated connection.
+ */
+extern void halSimLinkClose( void );
+
+/*
+ * Read the connection statistics since halSimLinkOpen().
+ */
+extern void halSimLinkGetStats( halSimLinkStats_t *pStats );
+
+/*
+ * Virtual time of the next connection event, 0 if none; for halSleep().
+ */
+extern uint64 halSimLinkNext( void );
+
+/*
+ * Run the connection events due by the virtual clock; for halSimRun().
+ */
+extern void halSimLinkPoll( void );
+
+/*
+ * Report the advertising interval in 625us units, 0 when not advertising.
+ */
+extern void halSimAdvSet( uint16 interval );
+
+/*
+ * Estimate the average supply current since halSimInit().
+ */
+extern void halSimGetCurrent( halSimCurrent_t *pStats );
+
+/*
+ * Virtual free running 625us link layer counter read by osalTimeUpdate().
+ */
+extern uint16 ll_McuPrecisionCount( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_SIM_H */
@@ -0,0 +1,429 @@
+/******************************************************************************
+
+ @file  hal_sim_flash.c
+
+ @brief Internal flash driver for the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hal_assert.h"
+#include "hal_flash.h"
+#include "hal_sim.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define HAL_SIM_FLASH_SIZE        ((uint32)HAL_SIM_FLASH_PAGES * HAL_FLASH_PAGE_PHYS)
+#define HAL_SIM_FLASH_WORDS       (HAL_SIM_FLASH_SIZE / HAL_FLASH_WORD_SIZE)
+#define HAL_SIM_FLASH_BANK_SIZE   ((uint32)HAL_FLASH_PAGE_PER_BANK * HAL_FLASH_PAGE_PHYS)
+
+// The image file holds the flash contents followed by the erase count
+// of each page, so wear accumulates over runs that share one image.
+#define HAL_SIM_FLASH_MAP_SIZE    (HAL_SIM_FLASH_SIZE + (HAL_SIM_FLASH_PAGES * sizeof( uint32 )))
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8 *halSimFlash = NULL;
+static uint32 *halSimFlashWear;
+static int halSimFlashFd = -1;
+
+// Writes to each flash word since its page was last erased.
+static uint8 halSimFlashWordWrites[HAL_SIM_FLASH_WORDS];
+
+static halSimFlashStats_t halSimFlashStats;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 *halSimFlashAddr( uint8 pg, uint16 offset, uint16 cnt );
+
+/*********************************************************************
+ * @fn      halSimFlashOpen
+ *
+ * @brief   Map the simulated flash onto an image file, creating it
+ *          fully erased if it does not exist, or onto an erased image
+ *          in memory. The drivers below open an in-memory image by
+ *          themselves if this is never called.
+ *
+ *          Statistics and the per-word write counts restart; the
+ *          contents and the per-page erase counts of a file persist.
+ *
+ * @param   path - image file, or NULL for an image in memory
+ *
+ * @return  TRUE if the image is mapped, FALSE otherwise.
+ */
+uint8 halSimFlashOpen( const char *path )
+{
+  void *pMap;
+  off_t size = 0;
+
+  halSimFlashClose();
+
+  if ( path == NULL )
+  {
+    pMap = mmap( NULL, HAL_SIM_FLASH_MAP_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  }
+  else
+  {
+    struct stat st;
+
+    halSimFlashFd = open( path, O_RDWR | O_CREAT, 0644 );
+    if ( halSimFlashFd < 0 )
+    {
+      return ( FALSE );
+    }
+
+    if ( (fstat( halSimFlashFd, &st ) != 0) ||
+         ((st.st_size < (off_t)HAL_SIM_FLASH_MAP_SIZE) &&
+          (ftruncate( halSimFlashFd, HAL_SIM_FLASH_MAP_SIZE ) != 0)) )
+    {
+      close( halSimFlashFd );
+      halSimFlashFd = -1;
+      return ( FALSE );
+    }
+    size = st.st_size;
+
+    pMap = mmap( NULL, HAL_SIM_FLASH_MAP_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_SHARED, halSimFlashFd, 0 );
+  }
+
+  if ( pMap == MAP_FAILED )
+  {
+    halSimFlashClose();
+    return ( FALSE );
+  }
+
+  halSimFlash = pMap;
+  halSimFlashWear = (uint32 *)(halSimFlash + HAL_SIM_FLASH_SIZE);
+
+  // Flash the file did not cover yet reads erased; the file was
+  // extended with zeros, which is also a fresh erase count.
+  if ( size < (off_t)HAL_SIM_FLASH_SIZE )
+  {
+    memset( halSimFlash + size, 0xFF, HAL_SIM_FLASH_SIZE - size );
+  }
+
+  memset( halSimFlashWordWrites, 0, sizeof( halSimFlashWordWrites ) );
+  memset( &halSimFlashStats, 0, sizeof( halSimFlashStats ) );
+
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * @fn      halSimFlashClose
+ *
+ * @brief   Write back and unmap the simulated flash image.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halSimFlashClose( void )
+{
+  if ( halSimFlash != NULL )
+  {
+    if ( halSimFlashFd >= 0 )
+    {
+      (void)msync( halSimFlash, HAL_SIM_FLASH_MAP_SIZE, MS_SYNC );
+    }
+
+    (void)munmap( halSimFlash, HAL_SIM_FLASH_MAP_SIZE );
+    halSimFlash = NULL;
+  }
+
+  if ( halSimFlashFd >= 0 )
+  {
+    close( halSimFlashFd );
+    halSimFlashFd = -1;
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimFlashGetStats
+ *
+ * @brief   Read the flash statistics since halSimFlashOpen().
+ *
+ * @param   pStats - where to copy the statistics
+ *
+ * @return  none
+ */
+void halSimFlashGetStats( halSimFlashStats_t *pStats )
+{
+  uint8 pg;
+
+  halSimFlashStats.maxErases = 0;
+
+  if ( halSimFlash != NULL )
+  {
+    for ( pg = 0; pg < HAL_SIM_FLASH_PAGES; pg++ )
+    {
+      if ( halSimFlashStats.maxErases < halSimFlashWear[pg] )
+      {
+        halSimFlashStats.maxErases = halSimFlashWear[pg];
+      }
+    }
+  }
+
+  *pStats = halSimFlashStats;
+}
+
+/*********************************************************************
+ * @fn      halSimFlashEraseCount
+ *
+ * @brief   Read the number of times a flash page has been erased over
+ *          the life of the image.
+ *
+ * @param   pg - flash page number
+ *
+ * @return  Erase count of the page.
+ */
+uint32 halSimFlashEraseCount( uint8 pg )
+{
+  if ( (halSimFlash == NULL) || (pg >= HAL_SIM_FLASH_PAGES) )
+  {
+    return ( 0 );
+  }
+
+  return ( halSimFlashWear[pg] );
+}
+
+/*********************************************************************
+ * @fn      halSimFlashAddr
+ *
+ * @brief   Map a page, offset and length to the image, asserting that
+ *          the range exists and does not cross into the next 32KB bank
+ *          as the flash controller requires.
+ *
+ * @param   pg - flash page number
+ * @param   offset - offset into the page
+ * @param   cnt - number of bytes
+ *
+ * @return  Pointer to the first byte in the image.
+ */
+static uint8 *halSimFlashAddr( uint8 pg, uint16 offset, uint16 cnt )
+{
+  uint32 addr = ((uint32)pg * HAL_FLASH_PAGE_PHYS) + offset;
+
+  if ( halSimFlash == NULL )
+  {
+    (void)halSimFlashOpen( NULL );
+    HAL_ASSERT( halSimFlash != NULL );
+  }
+
+  HAL_ASSERT( (addr + cnt) <= HAL_SIM_FLASH_SIZE );
+  HAL_ASSERT( (cnt == 0) ||
+              ((addr / HAL_SIM_FLASH_BANK_SIZE) == ((addr + cnt - 1) / HAL_SIM_FLASH_BANK_SIZE)) );
+
+  return ( halSimFlash + addr );
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashRead
+ *
+ * @brief       This function reads 'cnt' bytes from the simulated internal flash.
+ *
+ * input parameters
+ *
+ * @param       pg - Valid HAL flash page number (ie < 128).
+ * @param       offset - Valid offset into the page (so < HAL_NV_PAGE_SIZE and byte-aligned is ok).
+ * @param       buf - Valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - Valid number of bytes to read: a read cannot cross into the next 32KB bank.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
+{
+  (void)memcpy(buf, halSimFlashAddr(pg, offset, cnt), cnt);
+  halSimFlashStats.reads++;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashCompare
+ *
+ * @brief       This function compares 'cnt' bytes of the simulated internal flash with a buffer.
+ *
+ * input parameters
+ *
+ * @param       pg - Valid HAL flash page number (ie < 128).
+ * @param       offset - Valid offset into the page (so < HAL_NV_PAGE_SIZE and byte-aligned is ok).
+ * @param       buf - Valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - Valid number of bytes to compare: a compare cannot cross into the next 32KB bank.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the flash holds the same 'cnt' bytes as the buffer, FALSE otherwise.
+ **************************************************************************************************
+ */
+uint8 HalFlashCompare(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
+{
+  halSimFlashStats.reads++;
+
+  return (memcmp(buf, halSimFlashAddr(pg, offset, cnt), cnt) == 0);
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashWrite
+ *
+ * @brief       This function writes 'cnt' words to the simulated internal flash. As on the
+ *              device, programming can only clear bits: a word that would need a cleared bit
+ *              set again keeps it cleared and is counted in halSimFlashStats_t.setBits.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' flash words.
+ * @param       cnt - Valid number of flash words to write: a write cannot cross into the next 32KB bank.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
+{
+  uint32 word = addr;
+  uint8 *pFlash = halSimFlashAddr((uint8)(word / (HAL_FLASH_PAGE_PHYS / HAL_FLASH_WORD_SIZE)),
+                                  (uint16)((word % (HAL_FLASH_PAGE_PHYS / HAL_FLASH_WORD_SIZE)) *
+                                           HAL_FLASH_WORD_SIZE),
+                                  cnt * HAL_FLASH_WORD_SIZE);
+
+  for ( ; cnt != 0; cnt--, word++)
+  {
+    uint8 setBits = FALSE;
+    uint8 idx;
+
+    for (idx = 0; idx < HAL_FLASH_WORD_SIZE; idx++, pFlash++, buf++)
+    {
+      if (*buf & ~*pFlash)
+      {
+        setBits = TRUE;
+      }
+      *pFlash &= *buf;
+    }
+
+    if (setBits)
+    {
+      halSimFlashStats.setBits++;
+    }
+
+    if (halSimFlashWordWrites[word] != 0xFF)
+    {
+      halSimFlashWordWrites[word]++;
+    }
+    if (halSimFlashStats.maxWordWrites < halSimFlashWordWrites[word])
+    {
+      halSimFlashStats.maxWordWrites = halSimFlashWordWrites[word];
+    }
+
+    halSimFlashStats.words++;
+    halSimFlashStats.busyUs += HAL_SIM_FLASH_WORD_US;
+    halSimAdvance(HAL_SIM_FLASH_WORD_US);
+  }
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashErase
+ *
+ * @brief       This function erases the specified page of the simulated internal flash. Once a
+ *              page has been erased more than HAL_SIM_FLASH_ENDURANCE times, the lowest bit of
+ *              its first byte no longer erases.
+ *
+ * input parameters
+ *
+ * @param       pg - Valid HAL flash page number (ie < 128) to erase.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashErase(uint8 pg)
+{
+  uint8 *pFlash = halSimFlashAddr(pg, 0, HAL_FLASH_PAGE_PHYS);
+
+  (void)memset(pFlash, 0xFF, HAL_FLASH_PAGE_PHYS);
+  (void)memset(&halSimFlashWordWrites[(uint32)pg * (HAL_FLASH_PAGE_PHYS / HAL_FLASH_WORD_SIZE)], 0,
+               HAL_FLASH_PAGE_PHYS / HAL_FLASH_WORD_SIZE);
+
+  if (halSimFlashWear[pg] != 0xFFFFFFFF)
+  {
+    halSimFlashWear[pg]++;
+  }
+#if HAL_SIM_FLASH_ENDURANCE
+  if (halSimFlashWear[pg] > HAL_SIM_FLASH_ENDURANCE)
+  {
+    pFlash[0] &= 0xFE;
+  }
+#endif
+
+  halSimFlashStats.erases++;
+  halSimFlashStats.busyUs += HAL_SIM_FLASH_ERASE_US;
+  halSimAdvance(HAL_SIM_FLASH_ERASE_US);
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,215 @@
+/******************************************************************************
+
+ @file  hal_sim_heap.c
+
+ @brief Heap trace replayer for the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdlib.h>
+
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Memory.h"
+#include "OnBoard.h"
+
+#if ( OSALMEM_METRICS )
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Number of heap offsets a trace can refer to; block headers are 2-byte aligned.
+#define HAL_SIM_HEAP_MAP_CNT      (0x8000 / 2)
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void halSimHeapSample( halSimHeapReplay_t *pStats );
+
+/*********************************************************************
+ * @fn      halSimHeapReplay
+ *
+ * @brief   Replay a heap trace recorded by an OSALMEM_TRACE build
+ *          against the allocator of this build, starting from a fresh
+ *          heap. Build with different MAXMEMHEAP, OSALMEM_LL_BLKSZ,
+ *          OSALMEM_SMALL_BLKSZ or OSALMEM_SIZE_CLASSES settings to
+ *          compare them on the same trace.
+ *
+ *          Frees are matched to allocations by the heap offset in the
+ *          trace, so records lost on the device only show up as
+ *          skipped frees and leaked blocks.
+ *
+ * @param   pTrace - trace records as read with osal_mem_trace_read()
+ * @param   len - length of the trace in bytes
+ * @param   pStats - where to report the result
+ *
+ * @return  none
+ */
+void halSimHeapReplay( const uint8 *pTrace, uint32 len, halSimHeapReplay_t *pStats )
+{
+  void **map = calloc( HAL_SIM_HEAP_MAP_CNT, sizeof( void * ) );
+  uint32 idx;
+
+  osal_memset( pStats, 0, sizeof( halSimHeapReplay_t ) );
+  pStats->minLargestFree = 0xFFFF;
+
+  if ( map == NULL )
+  {
+    return;
+  }
+
+  osal_mem_init();
+
+  for ( idx = 0; (idx + OSALMEM_TRACE_REC_SZ) <= len; idx += OSALMEM_TRACE_REC_SZ )
+  {
+    const uint8 *pRec = pTrace + idx;
+    uint16 size = BUILD_UINT16( pRec[2], pRec[3] );
+    uint16 offset = BUILD_UINT16( pRec[4], pRec[5] );
+    void **ppBlk = NULL;
+
+    if ( (offset != OSALMEM_TRACE_NO_BLK) && ((offset / 2) < HAL_SIM_HEAP_MAP_CNT) )
+    {
+      ppBlk = &map[offset / 2];
+    }
+
+    switch ( pRec[0] )
+    {
+      case OSALMEM_TRACE_ALLOC:
+        if ( ppBlk == NULL )
+        {
+          // The allocation failed on the device as well; try it anyway.
+          void *pBlk = osal_mem_alloc( size );
+
+          if ( pBlk != NULL )
+          {
+            osal_mem_free( pBlk );
+          }
+          else
+          {
+            pStats->failures++;
+          }
+          break;
+        }
+
+        pStats->allocs++;
+        *ppBlk = osal_mem_alloc( size );
+
+        if ( *ppBlk == NULL )
+        {
+          pStats->failures++;
+        }
+
+        halSimHeapSample( pStats );
+        break;
+
+      case OSALMEM_TRACE_FREE:
+        if ( (ppBlk == NULL) || (*ppBlk == NULL) )
+        {
+          pStats->skipped++;
+          break;
+        }
+
+        pStats->frees++;
+        osal_mem_free( *ppBlk );
+        *ppBlk = NULL;
+        break;
+
+      case OSALMEM_TRACE_KICK:
+        osal_mem_kick();
+        break;
+
+      default:
+        pStats->skipped++;
+        break;
+    }
+  }
+
+  pStats->searchMax = osal_heap_search_max();
+  pStats->blockMax = osal_heap_block_max();
+
+  free( map );
+}
+
+/*********************************************************************
+ * @fn      halSimHeapSample
+ *
+ * @brief   Sample the heap usage and fragmentation after an allocation.
+ *
+ * @param   pStats - replay result to update
+ *
+ * @return  none
+ */
+static void halSimHeapSample( halSimHeapReplay_t *pStats )
+{
+  uint16 used = osal_heap_mem_used();
+  uint16 largest = osal_heap_largest_free();
+
+  if ( pStats->minLargestFree > largest )
+  {
+    pStats->minLargestFree = largest;
+  }
+
+  if ( pStats->peakUsed < used )
+  {
+    pStats->peakUsed = used;
+    pStats->largestFreeAtPeak = largest;
+
+    // Share of the free heap that isn't part of the largest free run
+    if ( (MAXMEMHEAP > used) && (largest < (MAXMEMHEAP - used)) )
+    {
+      pStats->fragAtPeak = (uint8)(100 - (((uint32)largest * 100) / (MAXMEMHEAP - used)));
+    }
+    else
+    {
+      pStats->fragAtPeak = 0;
+    }
+  }
+}
+
+#endif /* OSALMEM_METRICS */
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,285 @@
+/******************************************************************************
+
+ @file  hal_sim_key.c
+
+ @brief Key driver with simulated GPIO for the host (Linux/GCC) simulation
+        target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_drivers.h"
+#include "hal_key.h"
+#include "hal_sim.h"
+#include "OSAL.h"
+#include "OSAL_Clock.h"
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Time the keys must be quiet after an interrupt before they are read (ms).
+#if !defined HAL_KEY_DEBOUNCE_VALUE
+#define HAL_KEY_DEBOUNCE_VALUE    25
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+bool Hal_KeyIntEnable;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Keys the simulated pins currently report as pressed or open.
+static uint8 halSimKeys;
+
+static uint8 halKeySavedKeys;
+static halKeyCBack_t pHalKeyProcessFunction;
+
+static halSimKeyStats_t halSimKeyStats;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+void halProcessKeyInterrupt( void );
+
+/*********************************************************************
+ * @fn      halSimKeySet
+ *
+ * @brief   Drive the simulated key pins. As on the CC2540EB with
+ *          HAL_KEY_MAIL_SENSOR, the mailbox switches interrupt on both
+ *          edges and the other keys when pressed. Call between
+ *          halSimRun() windows; a window that ends on an edge models
+ *          the wake-up by the port interrupt.
+ *
+ * @param   keys - keys pressed, or mailbox switches open
+ *
+ * @return  none
+ */
+void halSimKeySet( uint8 keys )
+{
+  uint8 changed = keys ^ halSimKeys;
+  uint8 bit;
+
+  for ( bit = 0x01; bit != 0; bit <<= 1 )
+  {
+    if ( changed & bit )
+    {
+      halSimKeyStats.edges++;
+    }
+  }
+
+  halSimKeys = keys;
+
+  if ( Hal_KeyIntEnable && ((changed & HAL_KEY_MAIL) || (changed & keys)) )
+  {
+    // The edge arrives between scheduler passes, usually after a sleep, so
+    // bring the OSAL timers up to date before the debounce timer is added.
+    osalTimeUpdate();
+    halProcessKeyInterrupt();
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimKeyGetStats
+ *
+ * @brief   Read the key statistics.
+ *
+ * @param   pStats - where to copy the statistics
+ *
+ * @return  none
+ */
+void halSimKeyGetStats( halSimKeyStats_t *pStats )
+{
+  *pStats = halSimKeyStats;
+}
+
+/*********************************************************************
+ * @fn      HalKeyInit
+ *
+ * @brief   Initialize the key service with all keys released.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void HalKeyInit( void )
+{
+  halSimKeys = 0;
+  halKeySavedKeys = 0;
+  pHalKeyProcessFunction = NULL;
+  Hal_KeyIntEnable = FALSE;
+
+  osal_memset( &halSimKeyStats, 0, sizeof( halSimKeyStats ) );
+}
+
+/*********************************************************************
+ * @fn      HalKeyConfig
+ *
+ * @brief   Configure the key service.
+ *
+ * @param   interruptEnable - TRUE/FALSE, enable/disable interrupt
+ * @param   cback - pointer to the callback function
+ *
+ * @return  none
+ */
+void HalKeyConfig( bool interruptEnable, halKeyCBack_t cback )
+{
+  Hal_KeyIntEnable = interruptEnable;
+  pHalKeyProcessFunction = cback;
+
+  if ( Hal_KeyIntEnable )
+  {
+    osal_stop_timerEx( Hal_TaskID, HAL_KEY_EVENT );
+  }
+  else
+  {
+    osal_set_event( Hal_TaskID, HAL_KEY_EVENT );
+  }
+}
+
+/*********************************************************************
+ * @fn      HalKeyRead
+ *
+ * @brief   Read the current value of the keys.
+ *
+ * @param   none
+ *
+ * @return  keys - current keys status
+ */
+uint8 HalKeyRead( void )
+{
+  return ( halSimKeys );
+}
+
+/*********************************************************************
+ * @fn      HalKeyPoll
+ *
+ * @brief   Called by Hal_ProcessEvent() to poll the keys, reporting
+ *          what the CC2540EB driver would report.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void HalKeyPoll( void )
+{
+  uint8 keys = halSimKeys;
+  uint8 notify = FALSE;
+
+  halSimKeyStats.polls++;
+
+  if ( !Hal_KeyIntEnable )
+  {
+    notify = (keys != halKeySavedKeys);
+  }
+  else
+  {
+    notify = ((keys & ~HAL_KEY_MAIL) || ((keys ^ halKeySavedKeys) & HAL_KEY_MAIL));
+  }
+
+  halKeySavedKeys = keys;
+
+  if ( notify && pHalKeyProcessFunction )
+  {
+    halSimKeyStats.reports++;
+    (pHalKeyProcessFunction)( keys, HAL_KEY_STATE_NORMAL );
+  }
+}
+
+/*********************************************************************
+ * @fn      halProcessKeyInterrupt
+ *
+ * @brief   Simulated port interrupt: debounce the keys by reading them
+ *          HAL_KEY_DEBOUNCE_VALUE ms after the last edge.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halProcessKeyInterrupt( void )
+{
+  halSimKeyStats.interrupts++;
+
+  osal_start_timerEx( Hal_TaskID, HAL_KEY_EVENT, HAL_KEY_DEBOUNCE_VALUE );
+}
+
+/*********************************************************************
+ * @fn      HalKeyEnterSleep
+ *
+ * @brief   Called by halSleep() before sleeping; the simulated port
+ *          interrupts stay armed.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void HalKeyEnterSleep( void )
+{
+}
+
+/*********************************************************************
+ * @fn      HalKeyExitSleep
+ *
+ * @brief   Called by halSleep() after sleeping.
+ *
+ * @param   none
+ *
+ * @return  keys - current keys status
+ */
+uint8 HalKeyExitSleep( void )
+{
+  return ( HalKeyRead() );
+}
+
+#endif /* HAL_KEY */
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,505 @@
+/******************************************************************************
+
+ @file  hal_sim_link.c
+
+ @brief Simulated connection and GATT server transmit path for the host
+        (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_sim.h"
+#include "OSAL.h"
+
+#if (defined HAL_SIM_LINK) && (HAL_SIM_LINK == TRUE)
+
+#include "att.h"
+#include "gatt.h"
+#include "hci.h"
+#include "l2cap.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Handle of the simulated connection.
+#define HAL_SIM_LINK_CONN         0
+
+// Confirmation state of the last indication.
+#define HAL_SIM_LINK_IND_NONE     0  // No indication outstanding
+#define HAL_SIM_LINK_IND_SENDING  1  // Queued or being sent
+#define HAL_SIM_LINK_IND_SENT     2  // Confirmed in the next connection event
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// A notification or indication holding a PDU buffer.
+typedef struct
+{
+  uint8 packets;  // Link layer packets still to be sent.
+  uint8 ind;      // TRUE for an indication.
+} halSimLinkPdu_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Connection interval (units of 1.25ms, 0 when closed), ATT MTU and the
+// time of the next connection event.
+static uint16 halSimLinkInt;
+static uint16 halSimLinkMTU;
+static uint64 halSimLinkNextEvt;
+
+// PDU buffers in use, oldest first, as a ring.
+static halSimLinkPdu_t halSimLinkPdu[HAL_SIM_LINK_BUFFERS];
+static uint8 halSimLinkHead;
+static uint8 halSimLinkCount;
+
+// Last indication and the task that gets its confirmation.
+static uint8 halSimLinkInd;
+static uint8 halSimLinkIndTask;
+
+// Task and event set at the end of every connection event, 0 for none.
+static uint8 halSimLinkNoticeTask;
+static uint16 halSimLinkNoticeEvt;
+
+static halSimLinkRxCB_t pHalSimLinkRxCB;
+
+static halSimLinkStats_t halSimLinkStats;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void halSimLinkEvent( void );
+static void halSimLinkConfirm( void );
+static bStatus_t halSimLinkSend( attHandleValueNoti_t *pNoti, uint8 ind );
+
+/*********************************************************************
+ * @fn      halSimLinkOpen
+ *
+ * @brief   Bring up the simulated connection, with connection handle 0.
+ *          The first connection event follows one interval later.
+ *
+ * @param   connInterval - connection interval in 1.25ms units
+ * @param   mtu - ATT MTU, as agreed by an exchange MTU procedure
+ * @param   pfnRx - called with every value sent, or NULL
+ *
+ * @return  none
+ */
+void halSimLinkOpen( uint16 connInterval, uint16 mtu, halSimLinkRxCB_t pfnRx )
+{
+  halSimLinkClose();
+
+  halSimLinkInt = connInterval;
+  halSimLinkMTU = MAX( mtu, ATT_MTU_SIZE );
+  halSimLinkNextEvt = halSimTime() + ((uint64)connInterval * HAL_SIM_LINK_INT_US);
+  pHalSimLinkRxCB = pfnRx;
+
+  osal_memset( &halSimLinkStats, 0, sizeof( halSimLinkStats ) );
+}
+
+/*********************************************************************
+ * @fn      halSimLinkClose
+ *
+ * @brief   Drop the simulated connection and whatever it had queued.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halSimLinkClose( void )
+{
+  halSimLinkInt = 0;
+  halSimLinkHead = 0;
+  halSimLinkCount = 0;
+  halSimLinkInd = HAL_SIM_LINK_IND_NONE;
+  halSimLinkNoticeEvt = 0;
+}
+
+/*********************************************************************
+ * @fn      halSimLinkGetStats
+ *
+ * @brief   Read the connection statistics since halSimLinkOpen().
+ *
+ * @param   pStats - where to copy the statistics
+ *
+ * @return  none
+ */
+void halSimLinkGetStats( halSimLinkStats_t *pStats )
+{
+  *pStats = halSimLinkStats;
+}
+
+/*********************************************************************
+ * @fn      halSimLinkNext
+ *
+ * @brief   Called by halSleep() for the time of the next connection
+ *          event, which wakes the simulated processor.
+ *
+ * @param   none
+ *
+ * @return  Virtual time of the next connection event, 0 if none.
+ */
+uint64 halSimLinkNext( void )
+{
+  return ( (halSimLinkInt != 0) ? halSimLinkNextEvt : 0 );
+}
+
+/*********************************************************************
+ * @fn      halSimLinkPoll
+ *
+ * @brief   Called by halSimRun() to run the connection events that are
+ *          due by the virtual clock.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void halSimLinkPoll( void )
+{
+  while ( (halSimLinkInt != 0) && (halSimLinkNextEvt <= halSimTime()) )
+  {
+    halSimLinkEvent();
+
+    halSimLinkNextEvt += (uint64)halSimLinkInt * HAL_SIM_LINK_INT_US;
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimLinkEvent
+ *
+ * @brief   Run one connection event: confirm an indication received in
+ *          the last event, send up to HAL_SIM_LINK_PKTS_PER_EVENT link
+ *          layer packets from the oldest PDU on, releasing the PDU
+ *          buffers that are done, then set the connection event notice.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void halSimLinkEvent( void )
+{
+  uint8 packets = HAL_SIM_LINK_PKTS_PER_EVENT;
+
+  halSimLinkStats.connEvents++;
+
+  if ( halSimLinkInd == HAL_SIM_LINK_IND_SENT )
+  {
+    halSimLinkConfirm();
+  }
+
+  while ( (packets > 0) && (halSimLinkCount > 0) )
+  {
+    halSimLinkPdu_t *pPdu = &halSimLinkPdu[halSimLinkHead];
+    uint8 sent = MIN( packets, pPdu->packets );
+
+    pPdu->packets -= sent;
+    packets -= sent;
+    halSimLinkStats.packets += sent;
+
+    if ( pPdu->packets == 0 )
+    {
+      if ( pPdu->ind )
+      {
+        halSimLinkInd = HAL_SIM_LINK_IND_SENT;
+      }
+
+      halSimLinkHead = (halSimLinkHead + 1) % HAL_SIM_LINK_BUFFERS;
+      halSimLinkCount--;
+    }
+  }
+
+  if ( halSimLinkNoticeEvt != 0 )
+  {
+    osal_set_event( halSimLinkNoticeTask, halSimLinkNoticeEvt );
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimLinkConfirm
+ *
+ * @brief   Pass the client's confirmation of the last indication to the
+ *          task that sent it, as GATT does.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void halSimLinkConfirm( void )
+{
+  gattMsgEvent_t *pMsg;
+
+  halSimLinkInd = HAL_SIM_LINK_IND_NONE;
+
+  pMsg = (gattMsgEvent_t *)osal_msg_allocate( sizeof( gattMsgEvent_t ) );
+  if ( pMsg != NULL )
+  {
+    pMsg->hdr.event = GATT_MSG_EVENT;
+    pMsg->hdr.status = SUCCESS;
+    pMsg->connHandle = HAL_SIM_LINK_CONN;
+    pMsg->method = ATT_HANDLE_VALUE_CFM;
+
+    VOID osal_msg_send( halSimLinkIndTask, (uint8 *)pMsg );
+  }
+}
+
+/*********************************************************************
+ * @fn      halSimLinkSend
+ *
+ * @brief   Queue a notification or indication on a PDU buffer and take
+ *          over its value. Without data length extension the link
+ *          layer carries 27 bytes of the L2CAP PDU per packet.
+ *
+ * @param   pNoti - notification or indication to send
+ * @param   ind - TRUE for an indication
+ *
+ * @return  SUCCESS, bleNotConnected or MSG_BUFFER_NOT_AVAIL
+ */
+static bStatus_t halSimLinkSend( attHandleValueNoti_t *pNoti, uint8 ind )
+{
+  uint16 pduLen = L2CAP_HDR_SIZE + ATT_HANDLE_VALUE_IND_HDR_SIZE + pNoti->len;
+  halSimLinkPdu_t *pPdu;
+
+  if ( halSimLinkInt == 0 )
+  {
+    return ( bleNotConnected );
+  }
+
+  if ( halSimLinkCount == HAL_SIM_LINK_BUFFERS )
+  {
+    halSimLinkStats.refused++;
+
+    return ( MSG_BUFFER_NOT_AVAIL );
+  }
+
+  pPdu = &halSimLinkPdu[(halSimLinkHead + halSimLinkCount) % HAL_SIM_LINK_BUFFERS];
+  pPdu->packets = (uint8)((pduLen + HAL_SIM_LINK_PKT_LEN - 1) / HAL_SIM_LINK_PKT_LEN);
+  pPdu->ind = ind;
+  halSimLinkCount++;
+
+  halSimLinkStats.notifications++;
+  halSimLinkStats.bytes += pNoti->len;
+
+  if ( pHalSimLinkRxCB != NULL )
+  {
+    (*pHalSimLinkRxCB)( pNoti->handle, pNoti->pValue, pNoti->len );
+  }
+
+  if ( pNoti->pValue != NULL )
+  {
+    osal_mem_free( pNoti->pValue );
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      GATT_Notification
+ *
+ * @brief   Stand-in for the stack's GATT_Notification(), sending over
+ *          the simulated connection.
+ *
+ * @param   connHandle - connection to use
+ * @param   pNoti - pointer to notification to be sent
+ * @param   authenticated - whether an authenticated link is required
+ *
+ * @return  SUCCESS, bleNotConnected or MSG_BUFFER_NOT_AVAIL
+ */
+bStatus_t GATT_Notification( uint16 connHandle, attHandleValueNoti_t *pNoti,
+                             uint8 authenticated )
+{
+  (void)authenticated;
+
+  if ( connHandle != HAL_SIM_LINK_CONN )
+  {
+    return ( bleNotConnected );
+  }
+
+  return ( halSimLinkSend( pNoti, FALSE ) );
+}
+
+/*********************************************************************
+ * @fn      GATT_Indication
+ *
+ * @brief   Stand-in for the stack's GATT_Indication(). The client
+ *          confirms in the connection event after the indication is
+ *          sent, and only one indication may be outstanding.
+ *
+ * @param   connHandle - connection to use
+ * @param   pInd - pointer to indication to be sent
+ * @param   authenticated - whether an authenticated link is required
+ * @param   taskId - task to be notified of the confirmation
+ *
+ * @return  SUCCESS, bleNotConnected, blePending or MSG_BUFFER_NOT_AVAIL
+ */
+bStatus_t GATT_Indication( uint16 connHandle, attHandleValueInd_t *pInd,
+                           uint8 authenticated, uint8 taskId )
+{
+  bStatus_t status;
+
+  (void)authenticated;
+
+  if ( connHandle != HAL_SIM_LINK_CONN )
+  {
+    return ( bleNotConnected );
+  }
+
+  if ( halSimLinkInd != HAL_SIM_LINK_IND_NONE )
+  {
+    return ( blePending );
+  }
+
+  status = halSimLinkSend( (attHandleValueNoti_t *)pInd, TRUE );
+  if ( status == SUCCESS )
+  {
+    halSimLinkInd = HAL_SIM_LINK_IND_SENDING;
+    halSimLinkIndTask = taskId;
+  }
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      GATT_bm_alloc
+ *
+ * @brief   Stand-in for the stack's GATT_bm_alloc(), allocating from
+ *          the OSAL heap at most ATT_MTU-3 bytes, as the stack does for
+ *          notifications and indications.
+ *
+ * @param   connHandle - connection that message is to be sent on
+ * @param   opcode - opcode of message that buffer to be allocated for
+ * @param   size - number of bytes to allocate
+ * @param   pSizeAlloc - number of bytes allocated for the caller
+ *
+ * @return  Pointer to the allocation, NULL if not connected or out of
+ *          memory.
+ */
+void *GATT_bm_alloc( uint16 connHandle, uint8 opcode, uint16 size, uint16 *pSizeAlloc )
+{
+  void *pBuf;
+
+  (void)opcode;
+
+  if ( (halSimLinkInt == 0) || (connHandle != HAL_SIM_LINK_CONN) )
+  {
+    return ( NULL );
+  }
+
+  size = MIN( size, halSimLinkMTU - ATT_HANDLE_VALUE_IND_HDR_SIZE );
+
+  pBuf = osal_mem_alloc( MAX( size, 1 ) );
+  if ( (pBuf != NULL) && (pSizeAlloc != NULL) )
+  {
+    *pSizeAlloc = size;
+  }
+
+  return ( pBuf );
+}
+
+/*********************************************************************
+ * @fn      GATT_bm_free
+ *
+ * @brief   Stand-in for the stack's GATT_bm_free().
+ *
+ * @param   pMsg - pointer to GATT message containing the memory to free
+ * @param   opcode - opcode of the message
+ *
+ * @return  none
+ */
+void GATT_bm_free( gattMsg_t *pMsg, uint8 opcode )
+{
+  if ( ((opcode == ATT_HANDLE_VALUE_NOTI) || (opcode == ATT_HANDLE_VALUE_IND)) &&
+       (pMsg->handleValueNoti.pValue != NULL) )
+  {
+    osal_mem_free( pMsg->handleValueNoti.pValue );
+    pMsg->handleValueNoti.pValue = NULL;
+  }
+}
+
+/*********************************************************************
+ * @fn      ATT_GetMTU
+ *
+ * @brief   Stand-in for the stack's ATT_GetMTU().
+ *
+ * @param   connHandle - connection handle
+ *
+ * @return  ATT MTU of the simulated connection, ATT_MTU_SIZE otherwise.
+ */
+uint16 ATT_GetMTU( uint16 connHandle )
+{
+  return ( ((halSimLinkInt != 0) && (connHandle == HAL_SIM_LINK_CONN)) ?
+           halSimLinkMTU : ATT_MTU_SIZE );
+}
+
+/*********************************************************************
+ * @fn      HCI_EXT_ConnEventNoticeCmd
+ *
+ * @brief   Stand-in for the stack's HCI_EXT_ConnEventNoticeCmd(): set
+ *          the task event at the end of every simulated connection
+ *          event, or stop when taskEvent is 0.
+ *
+ * @param   connHandle - connection handle
+ * @param   taskID - user's task ID
+ * @param   taskEvent - user's task event, 0 to disable
+ *
+ * @return  SUCCESS or bleNotConnected
+ */
+hciStatus_t HCI_EXT_ConnEventNoticeCmd( uint16 connHandle, uint8 taskID, uint16 taskEvent )
+{
+  if ( (halSimLinkInt == 0) || (connHandle != HAL_SIM_LINK_CONN) )
+  {
+    return ( bleNotConnected );
+  }
+
+  halSimLinkNoticeTask = taskID;
+  halSimLinkNoticeEvt = taskEvent;
+
+  return ( SUCCESS );
+}
+
+#endif /* HAL_SIM_LINK */
+
+/*********************************************************************
+*********************************************************************/
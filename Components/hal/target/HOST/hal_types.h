@@ -0,0 +1,118 @@
+/******************************************************************************
+
+ @file  hal_types.h
+
+ @brief Basic types and compiler abstraction for the host (Linux/GCC)
+        simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+#ifndef _HAL_TYPES_H
+#define _HAL_TYPES_H
+
+/* Host (Linux/GCC) simulation target */
+
+/* ------------------------------------------------------------------------------------------------
+ *                                               Types
+ * ------------------------------------------------------------------------------------------------
+ */
+/** @defgroup HAL_TYPES HAL Types
+ * @{
+ */
+typedef signed   char   int8;     //!< Signed 8 bit integer
+typedef unsigned char   uint8;    //!< Unsigned 8 bit integer
+
+typedef signed   short  int16;    //!< Signed 16 bit integer
+typedef unsigned short  uint16;   //!< Unsigned 16 bit integer
+
+// 'long' is 64 bits on LP64 hosts, so 'int' is used to keep these 32 bits wide.
+typedef signed   int    int32;    //!< Signed 32 bit integer
+typedef unsigned int    uint32;   //!< Unsigned 32 bit integer
+
+typedef unsigned long long uint64; //!< Unsigned 64 bit integer (host cycle counters)
+
+typedef unsigned char   bool;     //!< Boolean data type
+
+typedef uint8           halDataAlign_t; //!< Used for byte alignment
+/** @} End HAL_TYPES */
+
+/* ------------------------------------------------------------------------------------------------
+ *                               Memory Attributes and Compiler Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* ----------- GNU Compiler ----------- */
+#if defined __GNUC__
+#define CODE
+#define XDATA
+#define DATA
+#define NEAR_FUNC
+#define __near_func
+#define __data
+#define ASM_NOP __asm__ __volatile__ ("nop")
+
+/* ----------- Unrecognized Compiler ----------- */
+#else
+#error "ERROR: Unknown compiler."
+#endif
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Standard Defines
+ * ------------------------------------------------------------------------------------------------
+ */
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+
+/**************************************************************************************************
+ */
+#endif
@@ -63,6 +63,7 @@
 #include "OSAL_Clock.h"
 
 #include "OnBoard.h"
+#include "hal_assert.h"
 
 /* HAL */
 #include "hal_drivers.h"
@@ -80,6 +81,21 @@
  * MACROS
  */
 
+// Index of the lowest set bit of a non-zero ready map
+#if defined ( __GNUC__ )
+#define OSAL_READY_FFS( map )    ( (uint8)__builtin_ctz( map ) )
+#else
+#define OSAL_READY_FFS( map )    osal_ready_ffs( map )
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+// Clock of the event loop trace, the 625us link layer counter unless the
+// build supplies a finer one
+#if !defined ( OSAL_EVENT_TRACE_TICK )
+#define OSAL_EVENT_TRACE_TICK()  ll_McuPrecisionCount()
+#endif
+#endif
+
 /*********************************************************************
  * CONSTANTS
  */
@@ -88,17 +104,51 @@
 #define OSAL_PROXY_ID_FLAG       0x80
 #endif // USE_ICALL
 
+#if ( OSAL_EVENT_TRACE )
+// Number of records held by the event loop trace
+#if !defined ( OSAL_EVENT_TRACE_CNT )
+#define OSAL_EVENT_TRACE_CNT     32
+#endif
+
+// Histogram bins, one per bit length of a 16-bit tick count
+#define OSAL_EVENT_TRACE_BINS    17
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// Per-task message queue; the tail makes appending O(1).
+typedef struct
+{
+  osal_msg_q_t head;
+  osal_msg_q_t tail;
+} osalTaskMsgQ_t;
+
+#if ( OSAL_EVENT_TRACE )
+// Histogram of run times or queueing delays, in trace ticks.
+typedef struct
+{
+  uint16 min;
+  uint16 max;
+  uint32 sum;
+  uint16 bins[OSAL_EVENT_TRACE_BINS];  // bins[N] counts the values of N bits
+} osalTraceHist_t;
+
+// Per-task event loop statistics.
+typedef struct
+{
+  uint16          ready;  // Tick at which the task last became ready
+  uint16          count;  // Samples in run and wait
+  osalTraceHist_t run;
+  osalTraceHist_t wait;
+} osalTraceTask_t;
+#endif
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
 
-// Message Pool Definitions
-osal_msg_q_t osal_qHead;
-
 #ifdef USE_ICALL
 // OSAL event loop hook function pointer 
 void (*osal_eventloop_hook)(void) = NULL;
@@ -111,6 +161,9 @@ void (*osal_eventloop_hook)(void) = NULL;
 /*********************************************************************
  * EXTERNAL FUNCTIONS
  */
+#if ( OSAL_EVENT_TRACE )
+extern uint16 ll_McuPrecisionCount( void );
+#endif
 
 /*********************************************************************
  * LOCAL VARIABLES
@@ -119,6 +172,30 @@ void (*osal_eventloop_hook)(void) = NULL;
 // Index of active task
 static uint8 activeTaskID = TASK_NO_TASK;
 
+// Message queues, one per task (tasksCnt entries)
+static osalTaskMsgQ_t *osal_taskMsgQ;
+
+// Ready map, bit N is set while tasksEvents[N] is non-zero
+static uint32 osal_readyMap = 0;
+
+#if ( OSAL_EVENT_TRACE )
+static uint8 osalEventTrace[OSAL_EVENT_TRACE_CNT][OSAL_EVENT_TRACE_REC_SZ];
+static uint8 osalEventTraceIdx;    // Index of the next record to write
+static uint8 osalEventTraceCnt;    // Number of records not yet read
+static uint16 osalEventTraceLost;  // Records overwritten before they were read
+
+// Event loop statistics, one per task (tasksCnt entries)
+static osalTraceTask_t *osalTraceTasks;
+#endif
+
+#if !defined ( __GNUC__ )
+// Index of the lowest set bit of a nibble
+static const CODE uint8 osalReadyFfsNibble[16] =
+{
+  0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+#endif
+
 #ifdef USE_ICALL
 // Maximum number of proxy tasks
 #ifndef OSAL_MAX_NUM_PROXY_TASKS
@@ -165,6 +242,18 @@ static uint8 osal_notask_entity;
 
 static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint8 urgent );
 
+#if !defined ( __GNUC__ )
+static uint8 osal_ready_ffs( uint32 map );
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+static void osalEventTraceRec( uint8 op, uint8 task_id, uint16 events, uint16 tick );
+static void osalEventTraceSet( uint8 task_id, uint16 event_flag );
+static void osalEventTraceSample( uint8 task_id, uint16 wait, uint16 run );
+static void osalTraceHistAdd( osalTraceHist_t *pHist, uint16 value );
+static void osalTraceHistGet( osalTraceHist_t *pHist, uint16 count, osal_trace_time_t *pTime );
+#endif
+
 #ifdef USE_ICALL
 static uint8 osal_alien2proxy(ICall_EntityID entity);
 static ICall_EntityID osal_proxy2alien(uint8 proxyid);
@@ -390,12 +479,12 @@ uint32 osal_build_uint32( uint8 *swapped, uint8 len )
  *
  * @return  pointer to buffer
  */
-unsigned char * _ltoa(unsigned long l, unsigned char *buf, unsigned char radix)
+unsigned char * _ltoa(uint32 l, unsigned char *buf, unsigned char radix)
 {
 #if defined (__TI_COMPILER_VERSION) || defined (__TI_COMPILER_VERSION__)
   return ( (unsigned char*)ltoa( l, (char *)buf ) );
 #elif defined( __GNUC__ )
-  return ( (char*)ltoa( l, buf, radix ) );
+  return ( (unsigned char*)ltoa( l, buf, radix ) );
 #else
   unsigned char tmp1[10] = "", tmp2[10] = "", tmp3[10] = "";
   unsigned short num1, num2, num3;
@@ -716,6 +805,9 @@ uint8 osal_msg_push_front( uint8 destination_task, uint8 *msg_ptr )
  */
 static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint8 push )
 {
+  osalTaskMsgQ_t *q;
+  halIntState_t intState;
+
   if ( msg_ptr == NULL )
   {
     return ( INVALID_MSG_POINTER );
@@ -744,17 +836,31 @@ static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint
 
   OSAL_MSG_ID( msg_ptr ) = destination_task;
 
-  if ( push == TRUE )
+  q = &osal_taskMsgQ[destination_task];
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  if ( q->head == NULL )
+  {
+    // first message for this task
+    q->head = msg_ptr;
+    q->tail = msg_ptr;
+  }
+  else if ( push == TRUE )
   {
     // prepend the message
-    osal_msg_push( &osal_qHead, msg_ptr );
+    OSAL_MSG_NEXT( msg_ptr ) = q->head;
+    q->head = msg_ptr;
   }
   else
   {
     // append the message
-    osal_msg_enqueue( &osal_qHead, msg_ptr );
+    OSAL_MSG_NEXT( q->tail ) = msg_ptr;
+    q->tail = msg_ptr;
   }
 
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
   // Signal the task that a message is waiting
   osal_set_event( destination_task, SYS_EVENT_MSG );
 
@@ -776,42 +882,31 @@ static uint8 osal_msg_enqueue_push( uint8 destination_task, uint8 *msg_ptr, uint
  */
 uint8 *osal_msg_receive( uint8 task_id )
 {
-  osal_msg_hdr_t *listHdr;
-  osal_msg_hdr_t *prevHdr = NULL;
-  osal_msg_hdr_t *foundHdr = NULL;
+  osal_msg_hdr_t *foundHdr;
+  osalTaskMsgQ_t *q;
   halIntState_t   intState;
 
+  if ( task_id >= tasksCnt )
+  {
+    return ( NULL );
+  }
+
+  q = &osal_taskMsgQ[task_id];
+
   // Hold off interrupts
   HAL_ENTER_CRITICAL_SECTION(intState);
 
-  // Point to the top of the queue
-  listHdr = osal_qHead;
-
-  // Look through the queue for a message that belongs to the asking task
-  while ( listHdr != NULL )
+  // Take the first message off the task's own queue
+  foundHdr = q->head;
+  if ( foundHdr != NULL )
   {
-    if ( (listHdr - 1)->dest_id == task_id )
-    {
-      if ( foundHdr == NULL )
-      {
-        // Save the first one
-        foundHdr = listHdr;
-      }
-      else
-      {
-        // Second msg found, stop looking
-        break;
-      }
-    }
-    if ( foundHdr == NULL )
-    {
-      prevHdr = listHdr;
-    }
-    listHdr = OSAL_MSG_NEXT( listHdr );
+    q->head = OSAL_MSG_NEXT( foundHdr );
+    OSAL_MSG_NEXT( foundHdr ) = NULL;
+    OSAL_MSG_ID( foundHdr ) = TASK_NO_TASK;
   }
 
   // Is there more than one?
-  if ( listHdr != NULL )
+  if ( q->head != NULL )
   {
     // Yes, Signal the task that a message is waiting
     osal_set_event( task_id, SYS_EVENT_MSG );
@@ -819,16 +914,10 @@ uint8 *osal_msg_receive( uint8 task_id )
   else
   {
     // No more
+    q->tail = NULL;
     osal_clear_event( task_id, SYS_EVENT_MSG );
   }
 
-  // Did we find a message?
-  if ( foundHdr != NULL )
-  {
-    // Take out of the link list
-    osal_msg_extract( &osal_qHead, foundHdr, prevHdr );
-  }
-
   // Release interrupts
   HAL_EXIT_CRITICAL_SECTION(intState);
 
@@ -858,14 +947,19 @@ osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event)
   osal_msg_hdr_t *pHdr;
   halIntState_t intState;
 
+  if (task_id >= tasksCnt)
+  {
+    return NULL;
+  }
+
   HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
 
-  pHdr = osal_qHead;  // Point to the top of the queue.
+  pHdr = osal_taskMsgQ[task_id].head;  // Point to the top of the task's queue.
 
-  // Look through the queue for a message that matches the task_id and event parameters.
+  // Look through the queue for a message that matches the event parameter.
   while (pHdr != NULL)
   {
-    if (((pHdr-1)->dest_id == task_id) && (((osal_event_hdr_t *)pHdr)->event == event))
+    if (((osal_event_hdr_t *)pHdr)->event == event)
     {
       break;
     }
@@ -903,15 +997,19 @@ uint8 osal_msg_count( uint8 task_id, uint8 event )
   osal_msg_hdr_t *pHdr;
   halIntState_t intState;
 
+  if ( task_id >= tasksCnt )
+  {
+    return ( 0 );
+  }
+
   HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
 
-  pHdr = osal_qHead;  // Point to the top of the queue.
+  pHdr = osal_taskMsgQ[task_id].head;  // Point to the top of the task's queue.
 
-  // Look through the queue for a message that matches the task_id and event parameters.
+  // Look through the queue for messages that match the event parameter.
   while (pHdr != NULL)
   {
-    if ( ((pHdr-1)->dest_id == task_id) 
-        && ((event == 0xFF) || (((osal_event_hdr_t *)pHdr)->event == event)) )
+    if ( (event == 0xFF) || (((osal_event_hdr_t *)pHdr)->event == event) )
     {
       count++;
     }
@@ -1194,7 +1292,14 @@ uint8 osal_set_event( uint8 task_id, uint16 event_flag )
   {
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
+#if ( OSAL_EVENT_TRACE )
+    osalEventTraceSet( task_id, event_flag );
+#endif
     tasksEvents[task_id] |= event_flag;  // Stuff the event bit(s)
+    if ( tasksEvents[task_id] )
+    {
+      osal_readyMap |= ((uint32)1 << task_id);  // Mark the task ready
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
 #ifdef USE_ICALL
     ICall_signal(osal_semaphore);
@@ -1227,6 +1332,10 @@ uint8 osal_clear_event( uint8 task_id, uint16 event_flag )
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
     tasksEvents[task_id] &= ~(event_flag);   // Clear the event bit(s)
+    if ( tasksEvents[task_id] == 0 )
+    {
+      osal_readyMap &= ~((uint32)1 << task_id);  // Nothing left to run
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
     return ( SUCCESS );
   }
@@ -1236,6 +1345,23 @@ uint8 osal_clear_event( uint8 task_id, uint16 event_flag )
   }
 }
 
+/*********************************************************************
+ * @fn      osal_tasks_ready
+ *
+ * @brief
+ *
+ *    This function is called to check whether any task has an event
+ *    pending, without scanning the task event table.
+ *
+ * @param   none
+ *
+ * @return  TRUE if a task is ready to run, FALSE otherwise
+ */
+uint8 osal_tasks_ready( void )
+{
+  return ( (osal_readyMap != 0) ? TRUE : FALSE );
+}
+
 /*********************************************************************
  * @fn      osal_isr_register
  *
@@ -1328,7 +1454,8 @@ uint8 osal_int_disable( uint8 interrupt_id )
  *
  * @param   void
  *
- * @return  SUCCESS
+ * @return  SUCCESS, FAILURE if there are too many tasks or the message
+ *          queues can't be allocated
  */
 uint8 osal_init_system( void )
 {
@@ -1337,8 +1464,34 @@ uint8 osal_init_system( void )
   osal_mem_init();
 #endif /* !defined USE_ICALL && !defined OSAL_PORT2TIRTOS */
 
-  // Initialize the message queue
-  osal_qHead = NULL;
+  // The ready map holds one bit per task; task tables are checked at
+  // build time with OSAL_TASKS_ASSERT_CNT()
+  if ( tasksCnt > OSAL_READY_MAP_TASKS )
+  {
+    HAL_ASSERT_FORCED();
+    return ( FAILURE );
+  }
+
+  // Initialize the per-task message queues
+  osal_taskMsgQ = (osalTaskMsgQ_t *)osal_mem_alloc( sizeof( osalTaskMsgQ_t ) * tasksCnt );
+  if ( osal_taskMsgQ == NULL )
+  {
+    HAL_ASSERT_FORCED();
+    return ( FAILURE );
+  }
+  osal_memset( osal_taskMsgQ, 0, sizeof( osalTaskMsgQ_t ) * tasksCnt );
+
+#if ( OSAL_EVENT_TRACE )
+  // Initialize the per-task event loop statistics
+  osalTraceTasks = (osalTraceTask_t *)osal_mem_alloc( sizeof( osalTraceTask_t ) * tasksCnt );
+  if ( osalTraceTasks == NULL )
+  {
+    HAL_ASSERT_FORCED();
+    return ( FAILURE );
+  }
+  osal_memset( osalTraceTasks, 0, sizeof( osalTraceTask_t ) * tasksCnt );
+  osal_task_stats_reset();
+#endif
 
   // Initialize the timers
   osalTimerInit();
@@ -1552,10 +1705,10 @@ ICall_Errno osal_service_entry(ICall_FuncArgsHdr *args)
  *
  * @brief
  *
- *   This function will make one pass through the OSAL taskEvents table
- *   and call the task_event_processor() function for the first task that
- *   is found with at least one event pending. If there are no pending
- *   events (all tasks), this function puts the processor into Sleep.
+ *   This function will take the highest priority task from the OSAL
+ *   ready map and call its task_event_processor() function. If there
+ *   are no pending events (all tasks), this function puts the processor
+ *   into Sleep.
  *
  * @param   void
  *
@@ -1563,7 +1716,7 @@ ICall_Errno osal_service_entry(ICall_FuncArgsHdr *args)
  */
 void osal_run_system( void )
 {
-  uint8 idx = 0;
+  uint8 idx;
 
 #ifdef USE_ICALL
   uint32 next_timeout_prior = osal_next_timeout();
@@ -1650,21 +1803,26 @@ void osal_run_system( void )
   }
 #endif /* USE_ICALL */
 
-  do {
-    if (tasksEvents[idx])  // Task is highest priority that is ready.
-    {
-      break;
-    }
-  } while (++idx < tasksCnt);
-
-  if (idx < tasksCnt)
+  if (osal_readyMap)
   {
     uint16 events;
     halIntState_t intState;
+#if ( OSAL_EVENT_TRACE )
+    uint16 traceStart;
+    uint16 traceEnd;
+    uint16 traceWait;
+#endif
 
     HAL_ENTER_CRITICAL_SECTION(intState);
+    idx = OSAL_READY_FFS(osal_readyMap);  // Task is highest priority that is ready.
     events = tasksEvents[idx];
     tasksEvents[idx] = 0;  // Clear the Events for this task.
+    osal_readyMap &= ~((uint32)1 << idx);
+#if ( OSAL_EVENT_TRACE )
+    traceStart = OSAL_EVENT_TRACE_TICK();
+    traceWait = traceStart - osalTraceTasks[idx].ready;
+    osalEventTraceRec( OSAL_EVENT_TRACE_RUN, idx, events, traceStart );
+#endif
     HAL_EXIT_CRITICAL_SECTION(intState);
 
     activeTaskID = idx;
@@ -1672,8 +1830,24 @@ void osal_run_system( void )
     activeTaskID = TASK_NO_TASK;
 
     HAL_ENTER_CRITICAL_SECTION(intState);
+#if ( OSAL_EVENT_TRACE )
+    traceEnd = OSAL_EVENT_TRACE_TICK();
+    osalEventTraceRec( OSAL_EVENT_TRACE_DONE, idx, events, traceEnd );
+    if ( events && (tasksEvents[idx] == 0) )
+    {
+      osalTraceTasks[idx].ready = traceEnd;  // Ready again with the events returned
+    }
+#endif
     tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
+    if (tasksEvents[idx])
+    {
+      osal_readyMap |= ((uint32)1 << idx);
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);
+
+#if ( OSAL_EVENT_TRACE )
+    osalEventTraceSample( idx, traceWait, (uint16)(traceEnd - traceStart) );
+#endif
   }
 #if defined( POWER_SAVING ) && !defined(USE_ICALL)
   else  // Complete pass through all task events with no activity?
@@ -1826,5 +2000,345 @@ uint8 osal_self( void )
   return ( activeTaskID );
 }
 
+#if !defined ( __GNUC__ )
+/*********************************************************************
+ * @fn      osal_ready_ffs
+ *
+ * @brief
+ *
+ *   Find the lowest set bit of the ready map in a fixed number of steps.
+ *
+ * @param   map - ready map, must not be zero
+ *
+ * @return  index of the lowest set bit
+ */
+static uint8 osal_ready_ffs( uint32 map )
+{
+  uint8 idx = 0;
+
+  if ( (map & 0x0000FFFF) == 0 )
+  {
+    map >>= 16;
+    idx += 16;
+  }
+
+  if ( (map & 0x000000FF) == 0 )
+  {
+    map >>= 8;
+    idx += 8;
+  }
+
+  if ( (map & 0x0000000F) == 0 )
+  {
+    map >>= 4;
+    idx += 4;
+  }
+
+  return ( idx + osalReadyFfsNibble[map & 0x0F] );
+}
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+/*********************************************************************
+ * @fn      osal_event_trace_read
+ *
+ * @brief   Copy the oldest event loop trace records into a buffer and
+ *          remove them from the trace, e.g. for the NPI event trace dump
+ *          (NPI_DumpCBack()). Only whole records are copied.
+ *
+ * @param   buf - where to copy the records
+ * @param   len - size of buf in bytes
+ *
+ * @return  Number of bytes copied, a multiple of OSAL_EVENT_TRACE_REC_SZ.
+ */
+uint16 osal_event_trace_read( uint8 *buf, uint16 len )
+{
+  halIntState_t intState;
+  uint16 cnt = len / OSAL_EVENT_TRACE_REC_SZ;
+  uint16 idx;
+  uint8 oldest;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  if ( cnt > osalEventTraceCnt )
+  {
+    cnt = osalEventTraceCnt;
+  }
+
+  oldest = (uint8)((osalEventTraceIdx + OSAL_EVENT_TRACE_CNT - osalEventTraceCnt) % OSAL_EVENT_TRACE_CNT);
+
+  for ( idx = 0; idx < cnt; idx++ )
+  {
+    (void)osal_memcpy( buf, osalEventTrace[oldest], OSAL_EVENT_TRACE_REC_SZ );
+    buf += OSAL_EVENT_TRACE_REC_SZ;
+
+    if ( ++oldest == OSAL_EVENT_TRACE_CNT )
+    {
+      oldest = 0;
+    }
+  }
+
+  osalEventTraceCnt -= (uint8)cnt;
+
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  return ( cnt * OSAL_EVENT_TRACE_REC_SZ );
+}
+
+/*********************************************************************
+ * @fn      osal_event_trace_lost
+ *
+ * @brief   Return the number of trace records that were overwritten
+ *          before osal_event_trace_read() got to them.
+ *
+ * @param   none
+ *
+ * @return  Number of lost records, saturating at 0xFFFF.
+ */
+uint16 osal_event_trace_lost( void )
+{
+  return ( osalEventTraceLost );
+}
+
+/*********************************************************************
+ * @fn      osal_task_stats
+ *
+ * @brief   Get the run time and queueing delay statistics of a task
+ *          since the last osal_task_stats_reset(), in trace ticks.
+ *
+ * @param   task_id - task to report on
+ * @param   pStats - where to put the statistics
+ *
+ * @return  SUCCESS, INVALID_TASK
+ */
+uint8 osal_task_stats( uint8 task_id, osal_task_stats_t *pStats )
+{
+  osalTraceTask_t *pTask;
+
+  if ( task_id >= tasksCnt )
+  {
+    return ( INVALID_TASK );
+  }
+
+  // Only the OSAL loop updates the statistics, so no need to hold off interrupts
+  pTask = &osalTraceTasks[task_id];
+
+  pStats->count = pTask->count;
+  osalTraceHistGet( &pTask->run, pTask->count, &pStats->run );
+  osalTraceHistGet( &pTask->wait, pTask->count, &pStats->wait );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osal_task_stats_reset
+ *
+ * @brief   Clear the run time and queueing delay statistics of all tasks.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osal_task_stats_reset( void )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < tasksCnt; idx++ )
+  {
+    osalTraceTask_t *pTask = &osalTraceTasks[idx];
+
+    pTask->count = 0;
+    osal_memset( &pTask->run, 0, sizeof( osalTraceHist_t ) );
+    osal_memset( &pTask->wait, 0, sizeof( osalTraceHist_t ) );
+    pTask->run.min = 0xFFFF;
+    pTask->wait.min = 0xFFFF;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalEventTraceRec
+ *
+ * @brief   Write one record into the event loop trace ring buffer,
+ *          overwriting the oldest record when it is full. Ints must be
+ *          disabled.
+ *
+ * @param   op - OSAL_EVENT_TRACE_SET, OSAL_EVENT_TRACE_RUN or
+ *               OSAL_EVENT_TRACE_DONE
+ * @param   task_id - task the events belong to
+ * @param   events - event bits
+ * @param   tick - OSAL_EVENT_TRACE_TICK()
+ *
+ * @return  none
+ */
+static void osalEventTraceRec( uint8 op, uint8 task_id, uint16 events, uint16 tick )
+{
+  uint8 *pRec = osalEventTrace[osalEventTraceIdx];
+
+  pRec[0] = op;
+  pRec[1] = task_id;
+  pRec[2] = LO_UINT16( events );
+  pRec[3] = HI_UINT16( events );
+  pRec[4] = LO_UINT16( tick );
+  pRec[5] = HI_UINT16( tick );
+
+  if ( ++osalEventTraceIdx == OSAL_EVENT_TRACE_CNT )
+  {
+    osalEventTraceIdx = 0;
+  }
+
+  if ( osalEventTraceCnt < OSAL_EVENT_TRACE_CNT )
+  {
+    osalEventTraceCnt++;
+  }
+  else if ( osalEventTraceLost < 0xFFFF )
+  {
+    osalEventTraceLost++;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalEventTraceSet
+ *
+ * @brief   Trace osal_set_event() and note when the task becomes ready.
+ *          Ints must be disabled.
+ *
+ * @param   task_id - receiving task
+ * @param   event_flag - events being set
+ *
+ * @return  none
+ */
+static void osalEventTraceSet( uint8 task_id, uint16 event_flag )
+{
+  uint16 tick = OSAL_EVENT_TRACE_TICK();
+
+  osalEventTraceRec( OSAL_EVENT_TRACE_SET, task_id, event_flag, tick );
+
+  if ( event_flag && (tasksEvents[task_id] == 0) )
+  {
+    osalTraceTasks[task_id].ready = tick;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalEventTraceSample
+ *
+ * @brief   Add one dispatch of a task to its statistics.
+ *
+ * @param   task_id - task dispatched
+ * @param   wait - ticks from the task becoming ready to its dispatch
+ * @param   run - ticks spent in the task's event handler
+ *
+ * @return  none
+ */
+static void osalEventTraceSample( uint8 task_id, uint16 wait, uint16 run )
+{
+  osalTraceTask_t *pTask = &osalTraceTasks[task_id];
+
+  if ( pTask->count == 0xFFFF )
+  {
+    uint8 bin;
+
+    // Halve the history so that it keeps following the recent dispatches
+    for ( bin = 0; bin < OSAL_EVENT_TRACE_BINS; bin++ )
+    {
+      pTask->run.bins[bin] >>= 1;
+      pTask->wait.bins[bin] >>= 1;
+    }
+    pTask->run.sum >>= 1;
+    pTask->wait.sum >>= 1;
+    pTask->count >>= 1;
+  }
+
+  pTask->count++;
+  osalTraceHistAdd( &pTask->run, run );
+  osalTraceHistAdd( &pTask->wait, wait );
+}
+
+/*********************************************************************
+ * @fn      osalTraceHistAdd
+ *
+ * @brief   Add one value to a histogram.
+ *
+ * @param   pHist - histogram
+ * @param   value - in trace ticks
+ *
+ * @return  none
+ */
+static void osalTraceHistAdd( osalTraceHist_t *pHist, uint16 value )
+{
+  uint8 bin = 0;
+  uint16 rest = value;
+
+  while ( rest )
+  {
+    bin++;
+    rest >>= 1;
+  }
+
+  pHist->bins[bin]++;
+  pHist->sum += value;
+
+  if ( value < pHist->min )
+  {
+    pHist->min = value;
+  }
+
+  if ( value > pHist->max )
+  {
+    pHist->max = value;
+  }
+}
+
+/*********************************************************************
+ * @fn      osalTraceHistGet
+ *
+ * @brief   Summarize a histogram.
+ *
+ * @param   pHist - histogram
+ * @param   count - number of values added to it
+ * @param   pTime - where to put the summary
+ *
+ * @return  none
+ */
+static void osalTraceHistGet( osalTraceHist_t *pHist, uint16 count, osal_trace_time_t *pTime )
+{
+  uint32 total = 0;
+  uint32 below = 0;
+  uint8 bin;
+
+  if ( count == 0 )
+  {
+    osal_memset( pTime, 0, sizeof( osal_trace_time_t ) );
+    return;
+  }
+
+  for ( bin = 0; bin < OSAL_EVENT_TRACE_BINS; bin++ )
+  {
+    total += pHist->bins[bin];
+  }
+
+  // Find the bin holding the 99th percentile
+  for ( bin = 0; bin < OSAL_EVENT_TRACE_BINS - 1; bin++ )
+  {
+    below += pHist->bins[bin];
+    if ( (below * 100) >= (total * 99) )
+    {
+      break;
+    }
+  }
+
+  pTime->min = pHist->min;
+  pTime->avg = (uint16)(pHist->sum / count);
+  pTime->max = pHist->max;
+
+  // Largest value of that bin, but no more than the maximum seen
+  pTime->p99 = (uint16)(((uint32)1 << bin) - 1);
+  if ( pTime->p99 > pHist->max )
+  {
+    pTime->p99 = pHist->max;
+  }
+}
+#endif
+
 /*********************************************************************
  */
@@ -152,6 +152,35 @@
 #define OSALMEM_PROFILER_LL        FALSE  // Special profiling of the Long-Lived bucket.
 #endif
 
+/* Size classes: once the LL block is filled, allocations that round up to one of these block sizes
+ * (including the header) are recycled through an O(1) free list per class instead of the first-fit
+ * walk. Blocks are only returned to the first-fit heap when an allocation would otherwise fail.
+ * The defaults fit osalTimerRec_t and short OSAL messages, GATT/ATT event messages and ATT_MTU
+ * sized buffers; list the sizes in increasing order.
+ */
+#if !defined OSALMEM_SIZE_CLASSES
+#define OSALMEM_SIZE_CLASSES       FALSE  // Enable/disable the size-class free lists.
+#endif
+
+#if OSALMEM_SIZE_CLASSES
+#if !defined OSALMEM_CLASS_SIZES
+#define OSALMEM_CLASS_SIZES        OSALMEM_ROUND(16), OSALMEM_ROUND(24), OSALMEM_ROUND(32), \
+                                   OSALMEM_ROUND(48)
+#endif
+#if !defined OSALMEM_CLASS_CNT
+#define OSALMEM_CLASS_CNT          4
+#endif
+// Free list links are byte offsets into theHeap; the block at offset 0 is never put on a list.
+#define OSALMEM_CLASS_NIL          0
+#endif
+
+// Number of records held by the heap trace ring buffer, at most 255.
+#if OSALMEM_TRACE
+#if !defined OSALMEM_TRACE_CNT
+#define OSALMEM_TRACE_CNT          32
+#endif
+#endif
+
 #if OSALMEM_PROFILER
 #define OSALMEM_INIT              'X'
 #define OSALMEM_ALOC              'A'
@@ -194,12 +223,27 @@ static osalMemHdr_t *ff1;  // First free block in the small-block bucket.
 
 static uint8 osalMemStat;            // Discrete status flags: 0x01 = kicked.
 
+#if OSALMEM_SIZE_CLASSES
+static const uint16 osalMemClassSz[OSALMEM_CLASS_CNT] = { OSALMEM_CLASS_SIZES };
+// Head of the free list of each size class. Blocks on these lists stay marked in-use so that the
+// first-fit walk neither allocates nor coalesces them.
+static uint16 osalMemClassHead[OSALMEM_CLASS_CNT];
+#endif
+
 #if OSALMEM_METRICS
 static uint16 blkMax;  // Max cnt of all blocks ever seen at once.
 static uint16 blkCnt;  // Current cnt of all blocks.
 static uint16 blkFree; // Current cnt of free blocks.
 static uint16 memAlo;  // Current total memory allocated.
 static uint16 memMax;  // Max total memory ever allocated at once.
+static uint16 srchMax; // Max cnt of blocks visited by one first-fit search.
+#endif
+
+#if OSALMEM_TRACE
+static uint8 osalMemTrace[OSALMEM_TRACE_CNT][OSALMEM_TRACE_REC_SZ];
+static uint8 osalMemTraceIdx;    // Index of the next record to write.
+static uint8 osalMemTraceCnt;    // Number of records not yet read.
+static uint16 osalMemTraceLost;  // Records overwritten before they were read.
 #endif
 
 #if OSALMEM_PROFILER
@@ -216,6 +260,22 @@ static uint16 proTot[OSALMEM_PROMAX+1] = { 0 };
 static uint16 proSmallBlkMiss;
 #endif
 
+/* ------------------------------------------------------------------------------------------------
+ *                                           Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static osalMemHdr_t *osalMemFirstFit(uint16 size);
+#if OSALMEM_TRACE
+static void osalMemTraceRec(uint8 op, uint16 size, osalMemHdr_t *hdr);
+#endif
+#if OSALMEM_SIZE_CLASSES
+static uint8 osalMemClassFind(uint16 size);
+static osalMemHdr_t *osalMemClassAlloc(uint16 *size);
+static uint8 osalMemClassFree(osalMemHdr_t *hdr);
+static uint8 osalMemClassRelease(void);
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Global Variables
  * ------------------------------------------------------------------------------------------------
@@ -263,6 +323,17 @@ void osal_mem_init(void)
   // Setup the wilderness.
   theHeap[OSALMEM_BIGBLK_IDX].val = OSALMEM_BIGBLK_SZ;  // Set 'len' & clear 'inUse' field.
 
+#if OSALMEM_SIZE_CLASSES
+  {
+    uint8 idx;
+
+    for (idx = 0; idx < OSALMEM_CLASS_CNT; idx++)
+    {
+      osalMemClassHead[idx] = OSALMEM_CLASS_NIL;
+    }
+  }
+#endif
+
 #if ( OSALMEM_METRICS )
   /* Start with the small-block bucket and the wilderness - don't count the
    * end-of-heap NULL block nor the end-of-small-block NULL block.
@@ -305,53 +376,37 @@ void osal_mem_kick(void)
   osal_mem_free(tmp);
   osalMemStat = 0x01;  // Set 'osalMemStat' after the free because it enables memory profiling.
 
+#if OSALMEM_TRACE
+  osalMemTraceRec(OSALMEM_TRACE_KICK, 0, ff1);
+#endif
+
   HAL_EXIT_CRITICAL_SECTION(intState);  // Re-enable interrupts.
 }
 
 /**************************************************************************************************
- * @fn          osal_mem_alloc
+ * @fn          osalMemFirstFit
  *
- * @brief       This function implements the OSAL dynamic memory allocation functionality.
+ * @brief       Find the first free block big enough for the given size, coalescing adjacent free
+ *              blocks on the way. Ints must be disabled.
  *
  * input parameters
  *
- * @param size - the number of bytes to allocate from the HEAP.
+ * @param size - the block size, including the header.
  *
  * output parameters
  *
  * None.
  *
- * @return      None.
+ * @return      Pointer to the free block, not yet split nor marked in-use, or NULL if none fits.
  */
-#ifdef DPRINTF_OSALHEAPTRACE
-void *osal_mem_alloc_dbg( uint16 size, const char *fname, unsigned lnum )
-#else /* DPRINTF_OSALHEAPTRACE */
-void *osal_mem_alloc( uint16 size )
-#endif /* DPRINTF_OSALHEAPTRACE */
+static osalMemHdr_t *osalMemFirstFit(uint16 size)
 {
   osalMemHdr_t *prev = NULL;
   osalMemHdr_t *hdr;
-  halIntState_t intState;
   uint8 coal = 0;
-
-  size += OSALMEM_HDRSZ;
-
-  // Calculate required bytes to add to 'size' to align to halDataAlign_t.
-  if ( sizeof( halDataAlign_t ) == 2 )
-  {
-    size += (size & 0x01);
-  }
-  else if ( sizeof( halDataAlign_t ) != 1 )
-  {
-    const uint8 mod = size % sizeof( halDataAlign_t );
-
-    if ( mod != 0 )
-    {
-      size += (sizeof( halDataAlign_t ) - mod);
-    }
-  }
-
-  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+#if ( OSALMEM_METRICS )
+  uint16 srch = 0;
+#endif
 
   // Smaller allocations are first attempted in the small-block bucket, and all long-lived
   // allocations are channelled into the LL block reserved within this bucket.
@@ -366,6 +421,10 @@ void *osal_mem_alloc( uint16 size )
 
   do
   {
+#if ( OSALMEM_METRICS )
+    srch++;
+#endif
+
     if ( hdr->hdr.inUse )
     {
       coal = 0;
@@ -408,37 +467,113 @@ void *osal_mem_alloc( uint16 size )
     }
   } while (1);
 
-  if ( hdr != NULL )
+#if ( OSALMEM_METRICS )
+  if ( srchMax < srch )
+  {
+    srchMax = srch;
+  }
+#endif
+
+  return hdr;
+}
+
+/**************************************************************************************************
+ * @fn          osal_mem_alloc
+ *
+ * @brief       This function implements the OSAL dynamic memory allocation functionality.
+ *
+ * input parameters
+ *
+ * @param size - the number of bytes to allocate from the HEAP.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ */
+#ifdef DPRINTF_OSALHEAPTRACE
+void *osal_mem_alloc_dbg( uint16 size, const char *fname, unsigned lnum )
+#else /* DPRINTF_OSALHEAPTRACE */
+void *osal_mem_alloc( uint16 size )
+#endif /* DPRINTF_OSALHEAPTRACE */
+{
+  osalMemHdr_t *hdr;
+  halIntState_t intState;
+#if OSALMEM_TRACE
+  const uint16 reqSize = size;
+#endif
+
+  size += OSALMEM_HDRSZ;
+
+  // Calculate required bytes to add to 'size' to align to halDataAlign_t.
+  if ( sizeof( halDataAlign_t ) == 2 )
   {
-    uint16 tmp = hdr->hdr.len - size;
+    size += (size & 0x01);
+  }
+  else if ( sizeof( halDataAlign_t ) != 1 )
+  {
+    const uint8 mod = size % sizeof( halDataAlign_t );
 
-    // Determine whether the threshold for splitting is met.
-    if ( tmp >= OSALMEM_MIN_BLKSZ )
+    if ( mod != 0 )
     {
-      // Split the block before allocating it.
-      osalMemHdr_t *next = (osalMemHdr_t *)((uint8 *)hdr + size);
-      next->val = tmp;                     // Set 'len' & clear 'inUse' field.
-      hdr->val = (size | OSALMEM_IN_USE);  // Set 'len' & 'inUse' field.
+      size += (sizeof( halDataAlign_t ) - mod);
+    }
+  }
 
-#if ( OSALMEM_METRICS )
-      blkCnt++;
-      if ( blkMax < blkCnt )
-      {
-        blkMax = blkCnt;
-      }
-      memAlo += size;
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+#if OSALMEM_SIZE_CLASSES
+  hdr = osalMemClassAlloc(&size);
+
+  if ( hdr == NULL )
 #endif
+  {
+    hdr = osalMemFirstFit(size);
+
+#if OSALMEM_SIZE_CLASSES
+    // Give the blocks held by the size classes back to the first-fit heap and try again.
+    if ( (hdr == NULL) && osalMemClassRelease() )
+    {
+      hdr = osalMemFirstFit(size);
     }
-    else
+#endif
+
+    if ( hdr != NULL )
     {
+      uint16 tmp = hdr->hdr.len - size;
+
+      // Determine whether the threshold for splitting is met.
+      if ( tmp >= OSALMEM_MIN_BLKSZ )
+      {
+        // Split the block before allocating it.
+        osalMemHdr_t *next = (osalMemHdr_t *)((uint8 *)hdr + size);
+        next->val = tmp;                     // Set 'len' & clear 'inUse' field.
+        hdr->val = (size | OSALMEM_IN_USE);  // Set 'len' & 'inUse' field.
+
 #if ( OSALMEM_METRICS )
-      memAlo += hdr->hdr.len;
-      blkFree--;
+        blkCnt++;
+        if ( blkMax < blkCnt )
+        {
+          blkMax = blkCnt;
+        }
+        memAlo += size;
+#endif
+      }
+      else
+      {
+#if ( OSALMEM_METRICS )
+        memAlo += hdr->hdr.len;
+        blkFree--;
 #endif
 
-      hdr->hdr.inUse = TRUE;
+        hdr->hdr.inUse = TRUE;
+      }
     }
+  }
 
+  if ( hdr != NULL )
+  {
 #if ( OSALMEM_METRICS )
     if ( memMax < memAlo )
     {
@@ -492,6 +627,10 @@ void *osal_mem_alloc( uint16 size )
     hdr++;
   }
 
+#if OSALMEM_TRACE
+  osalMemTraceRec(OSALMEM_TRACE_ALLOC, reqSize, ((hdr != NULL) ? (hdr - 1) : NULL));
+#endif
+
   HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
 
   HAL_ASSERT(((size_t)hdr % sizeof(halDataAlign_t)) == 0);
@@ -534,12 +673,10 @@ void osal_mem_free(void *ptr)
   HAL_ASSERT(hdr->hdr.inUse);
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
-  hdr->hdr.inUse = FALSE;
 
-  if (ff1 > hdr)
-  {
-    ff1 = hdr;
-  }
+#if OSALMEM_TRACE
+  osalMemTraceRec(OSALMEM_TRACE_FREE, hdr->hdr.len, hdr);
+#endif
 
 #if OSALMEM_PROFILER
 #if !OSALMEM_PROFILER_LL
@@ -566,9 +703,183 @@ void osal_mem_free(void *ptr)
   blkFree++;
 #endif
 
+#if OSALMEM_SIZE_CLASSES
+  if (!osalMemClassFree(hdr))
+#endif
+  {
+    hdr->hdr.inUse = FALSE;
+
+    if (ff1 > hdr)
+    {
+      ff1 = hdr;
+    }
+  }
+
   HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
 }
 
+#if OSALMEM_SIZE_CLASSES
+/**************************************************************************************************
+ * @fn          osalMemClassFind
+ *
+ * @brief       Find the smallest size class that holds a block of the given size.
+ *
+ * input parameters
+ *
+ * @param size - the block size, including the header.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      Index of the size class, or OSALMEM_CLASS_CNT if the size is bigger than all classes.
+ */
+static uint8 osalMemClassFind(uint16 size)
+{
+  uint8 cls;
+
+  for (cls = 0; cls < OSALMEM_CLASS_CNT; cls++)
+  {
+    if (size <= osalMemClassSz[cls])
+    {
+      break;
+    }
+  }
+
+  return cls;
+}
+
+/**************************************************************************************************
+ * @fn          osalMemClassAlloc
+ *
+ * @brief       Take a block off the free list of the size class for the given size.
+ *              Ints must be disabled.
+ *
+ * input parameters
+ *
+ * @param size - the block size, including the header.
+ *
+ * output parameters
+ *
+ * @param size - rounded up to the size of the class, if there is one, so that a block carved by
+ *               first-fit can be recycled through the class when freed.
+ *
+ * @return      Pointer to the in-use block, or NULL if the class list is empty or there is no class.
+ */
+static osalMemHdr_t *osalMemClassAlloc(uint16 *size)
+{
+  osalMemHdr_t *hdr = NULL;
+  uint8 cls;
+
+  // Long-lived allocations are packed into the LL block as they are.
+  if (osalMemStat == 0)
+  {
+    return NULL;
+  }
+
+  cls = osalMemClassFind(*size);
+
+  if (cls < OSALMEM_CLASS_CNT)
+  {
+    *size = osalMemClassSz[cls];
+
+    if (osalMemClassHead[cls] != OSALMEM_CLASS_NIL)
+    {
+      hdr = (osalMemHdr_t *)((uint8 *)theHeap + osalMemClassHead[cls]);
+      osalMemClassHead[cls] = *(uint16 *)(hdr + 1);
+
+#if ( OSALMEM_METRICS )
+      memAlo += hdr->hdr.len;
+      blkFree--;
+#endif
+    }
+  }
+
+  return hdr;
+}
+
+/**************************************************************************************************
+ * @fn          osalMemClassFree
+ *
+ * @brief       Push a freed block onto the free list of its size class, if it has one. The block
+ *              stays marked in-use. Ints must be disabled.
+ *
+ * input parameters
+ *
+ * @param hdr - the header of the block being freed.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the block was taken by a size class, FALSE otherwise.
+ */
+static uint8 osalMemClassFree(osalMemHdr_t *hdr)
+{
+  uint8 cls;
+
+  if ((osalMemStat == 0) || (hdr == theHeap))
+  {
+    return FALSE;
+  }
+
+  cls = osalMemClassFind(hdr->hdr.len);
+
+  // Only blocks carved at exactly the class size; a block that was too small to split is bigger.
+  if ((cls == OSALMEM_CLASS_CNT) || (hdr->hdr.len != osalMemClassSz[cls]))
+  {
+    return FALSE;
+  }
+
+  *(uint16 *)(hdr + 1) = osalMemClassHead[cls];
+  osalMemClassHead[cls] = (uint16)((uint8 *)hdr - (uint8 *)theHeap);
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          osalMemClassRelease
+ *
+ * @brief       Return all blocks held on the size-class free lists to the first-fit heap.
+ *              Ints must be disabled.
+ *
+ * input parameters
+ *
+ * None.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if any block was released, FALSE otherwise.
+ */
+static uint8 osalMemClassRelease(void)
+{
+  uint8 released = FALSE;
+  uint8 cls;
+
+  for (cls = 0; cls < OSALMEM_CLASS_CNT; cls++)
+  {
+    while (osalMemClassHead[cls] != OSALMEM_CLASS_NIL)
+    {
+      osalMemHdr_t *hdr = (osalMemHdr_t *)((uint8 *)theHeap + osalMemClassHead[cls]);
+
+      osalMemClassHead[cls] = *(uint16 *)(hdr + 1);
+      hdr->hdr.inUse = FALSE;  // Already counted as free by the metrics.
+
+      if (ff1 > hdr)
+      {
+        ff1 = hdr;
+      }
+
+      released = TRUE;
+    }
+  }
+
+  return released;
+}
+#endif
+
 #if OSALMEM_METRICS
 /*********************************************************************
  * @fn      osal_heap_block_max
@@ -625,6 +936,182 @@ uint16 osal_heap_mem_used( void )
 {
   return memAlo;
 }
+
+/*********************************************************************
+ * @fn      osal_heap_search_max
+ *
+ * @brief   Return the maximum number of blocks ever visited by one
+ *          first-fit search, the worst case for osal_mem_alloc().
+ *
+ * @param   none
+ *
+ * @return  Maximum number of blocks visited by one search.
+ */
+uint16 osal_heap_search_max( void )
+{
+  return srchMax;
+}
+
+/*********************************************************************
+ * @fn      osal_heap_largest_free
+ *
+ * @brief   Return the largest number of bytes that osal_mem_alloc()
+ *          could hand out at once, counting adjacent free blocks as one.
+ *          Walks the whole heap with interrupts disabled, so it is
+ *          meant for diagnostics only.
+ *
+ * @param   none
+ *
+ * @return  Size of the largest free run, excluding its header.
+ */
+uint16 osal_heap_largest_free( void )
+{
+  osalMemHdr_t *hdr = theHeap;
+  halIntState_t intState;
+  uint16 run = 0;
+  uint16 largest = 0;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  while ( hdr->val != 0 )
+  {
+    if ( hdr->hdr.inUse )
+    {
+      run = 0;
+    }
+    else
+    {
+      run += hdr->hdr.len;
+
+      if ( largest < run )
+      {
+        largest = run;
+      }
+    }
+
+    hdr = (osalMemHdr_t *)((uint8 *)hdr + hdr->hdr.len);
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  return ((largest > OSALMEM_HDRSZ) ? (largest - OSALMEM_HDRSZ) : 0);
+}
+#endif
+
+#if OSALMEM_TRACE
+/**************************************************************************************************
+ * @fn          osalMemTraceRec
+ *
+ * @brief       Write one record into the heap trace ring buffer, overwriting the oldest record
+ *              when it is full. Ints must be disabled.
+ *
+ * input parameters
+ *
+ * @param op - OSALMEM_TRACE_ALLOC, OSALMEM_TRACE_FREE or OSALMEM_TRACE_KICK.
+ * @param size - the requested size or the block length.
+ * @param hdr - the block header, NULL for a failed allocation.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ */
+static void osalMemTraceRec(uint8 op, uint16 size, osalMemHdr_t *hdr)
+{
+  uint8 *pRec = osalMemTrace[osalMemTraceIdx];
+  uint16 offset = OSALMEM_TRACE_NO_BLK;
+  uint16 tick = (uint16)osal_GetSystemClock();
+
+  if (hdr != NULL)
+  {
+    offset = (uint16)((uint8 *)hdr - (uint8 *)theHeap);
+  }
+
+  pRec[0] = op;
+  pRec[1] = osal_self();
+  pRec[2] = LO_UINT16(size);
+  pRec[3] = HI_UINT16(size);
+  pRec[4] = LO_UINT16(offset);
+  pRec[5] = HI_UINT16(offset);
+  pRec[6] = LO_UINT16(tick);
+  pRec[7] = HI_UINT16(tick);
+
+  if (++osalMemTraceIdx == OSALMEM_TRACE_CNT)
+  {
+    osalMemTraceIdx = 0;
+  }
+
+  if (osalMemTraceCnt < OSALMEM_TRACE_CNT)
+  {
+    osalMemTraceCnt++;
+  }
+  else if (osalMemTraceLost < 0xFFFF)
+  {
+    osalMemTraceLost++;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_mem_trace_read
+ *
+ * @brief   Copy the oldest heap trace records into a buffer and remove
+ *          them from the trace, e.g. for the NPI heap trace dump
+ *          (NPI_DumpCBack()). Only whole records are copied.
+ *
+ * @param   buf - where to copy the records
+ * @param   len - size of buf in bytes
+ *
+ * @return  Number of bytes copied, a multiple of OSALMEM_TRACE_REC_SZ.
+ */
+uint16 osal_mem_trace_read( uint8 *buf, uint16 len )
+{
+  halIntState_t intState;
+  uint16 cnt = len / OSALMEM_TRACE_REC_SZ;
+  uint16 idx;
+  uint8 oldest;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+  if (cnt > osalMemTraceCnt)
+  {
+    cnt = osalMemTraceCnt;
+  }
+
+  oldest = (uint8)((osalMemTraceIdx + OSALMEM_TRACE_CNT - osalMemTraceCnt) % OSALMEM_TRACE_CNT);
+
+  for (idx = 0; idx < cnt; idx++)
+  {
+    (void)osal_memcpy(buf, osalMemTrace[oldest], OSALMEM_TRACE_REC_SZ);
+    buf += OSALMEM_TRACE_REC_SZ;
+
+    if (++oldest == OSALMEM_TRACE_CNT)
+    {
+      oldest = 0;
+    }
+  }
+
+  osalMemTraceCnt -= (uint8)cnt;
+
+  HAL_EXIT_CRITICAL_SECTION( intState );  // Re-enable interrupts.
+
+  return (cnt * OSALMEM_TRACE_REC_SZ);
+}
+
+/*********************************************************************
+ * @fn      osal_mem_trace_lost
+ *
+ * @brief   Return the number of trace records that were overwritten
+ *          before osal_mem_trace_read() got to them.
+ *
+ * @param   none
+ *
+ * @return  Number of lost records, saturating at 0xFFFF.
+ */
+uint16 osal_mem_trace_lost( void )
+{
+  return osalMemTraceLost;
+}
 #endif
 
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
@@ -63,6 +63,14 @@
  * CONSTANTS
  */
 
+// Number of timer records held in a static pool, so that starting and
+// expiring timers doesn't go through the heap. Timers beyond the pool
+// are allocated from the heap and counted by osal_timer_pool_overflow().
+// Set to 0 to allocate every timer record from the heap.
+#if !defined OSAL_TIMERS_POOL_SIZE
+#define OSAL_TIMERS_POOL_SIZE  8
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -73,6 +81,8 @@ typedef union {
   uint8 time8[4];
 } osalTime_t;
 
+// Timers are kept sorted by expiry. The timeout of each record is the
+// delta from the record before it, so only the head needs updating.
 typedef struct
 {
   void   *next;
@@ -102,12 +112,25 @@ osalTimerRec_t *timerHead;
 // Milliseconds since last reboot
 static uint32 osal_systemClock;
 
+#if OSAL_TIMERS_POOL_SIZE
+// Timer record pool and its free list
+static osalTimerRec_t osalTimerPool[OSAL_TIMERS_POOL_SIZE];
+static osalTimerRec_t *osalTimerFreeList;
+
+// Number of timer records allocated from the heap since the pool was empty
+static uint16 osalTimerPoolOverflow;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTION PROTOTYPES
  */
 osalTimerRec_t  *osalAddTimer( uint8 task_id, uint16 event_flag, uint32 timeout );
 osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag );
 void osalDeleteTimer( osalTimerRec_t *rmTimer );
+static void osalInsertTimer( osalTimerRec_t *newTimer, uint32 timeout );
+static void osalUnlinkTimer( osalTimerRec_t *rmTimer );
+static osalTimerRec_t *osalTimerAlloc( void );
+static void osalTimerFree( osalTimerRec_t *freeTimer );
 
 /*********************************************************************
  * FUNCTIONS
@@ -124,7 +147,86 @@ void osalDeleteTimer( osalTimerRec_t *rmTimer );
  */
 void osalTimerInit( void )
 {
+#if OSAL_TIMERS_POOL_SIZE
+  uint8 idx;
+#endif
+
   osal_systemClock = 0;
+
+#if OSAL_TIMERS_POOL_SIZE
+  // Chain the pool into the free list
+  osalTimerFreeList = NULL;
+  for ( idx = 0; idx < OSAL_TIMERS_POOL_SIZE; idx++ )
+  {
+    osalTimerPool[idx].next = osalTimerFreeList;
+    osalTimerFreeList = &osalTimerPool[idx];
+  }
+
+  osalTimerPoolOverflow = 0;
+#endif
+}
+
+/*********************************************************************
+ * @fn      osalTimerAlloc
+ *
+ * @brief   Get a timer record from the pool, or from the heap when the
+ *          pool is used up.
+ *          Ints must be disabled.
+ *
+ * @param   none
+ *
+ * @return  osalTimerRec_t * - timer record, NULL if none is available
+ */
+static osalTimerRec_t *osalTimerAlloc( void )
+{
+#if OSAL_TIMERS_POOL_SIZE
+  osalTimerRec_t *newTimer = osalTimerFreeList;
+
+  if ( newTimer )
+  {
+    osalTimerFreeList = newTimer->next;
+
+    return ( newTimer );
+  }
+
+  // Report the overflow
+  if ( osalTimerPoolOverflow < 0xFFFF )
+  {
+    osalTimerPoolOverflow++;
+  }
+#endif
+
+  return ( osal_mem_alloc( sizeof( osalTimerRec_t ) ) );
+}
+
+/*********************************************************************
+ * @fn      osalTimerFree
+ *
+ * @brief   Return a timer record to the pool, or to the heap if it came
+ *          from there.
+ *
+ * @param   freeTimer - timer record, not in the timer list
+ *
+ * @return  none
+ */
+static void osalTimerFree( osalTimerRec_t *freeTimer )
+{
+#if OSAL_TIMERS_POOL_SIZE
+  if ( (freeTimer >= &osalTimerPool[0]) &&
+       (freeTimer < &osalTimerPool[OSAL_TIMERS_POOL_SIZE]) )
+  {
+    halIntState_t intState;
+
+    HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+    freeTimer->next = osalTimerFreeList;
+    osalTimerFreeList = freeTimer;
+    HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
+    return;
+  }
+#endif
+
+  osal_mem_free( freeTimer );
 }
 
 /*********************************************************************
@@ -142,59 +244,128 @@ void osalTimerInit( void )
 osalTimerRec_t * osalAddTimer( uint8 task_id, uint16 event_flag, uint32 timeout )
 {
   osalTimerRec_t *newTimer;
-  osalTimerRec_t *srchTimer;
 
   // Look for an existing timer first
   newTimer = osalFindTimer( task_id, event_flag );
   if ( newTimer )
   {
-    // Timer is found - update it.
-    newTimer->timeout.time32 = timeout;
-
-    return ( newTimer );
+    // Timer is found - take it out to be put back at its new position.
+    osalUnlinkTimer( newTimer );
   }
   else
   {
     // New Timer
-    newTimer = osal_mem_alloc( sizeof( osalTimerRec_t ) );
+    newTimer = osalTimerAlloc();
 
-    if ( newTimer )
+    if ( newTimer == NULL )
     {
-      // Fill in new timer
-      newTimer->task_id = task_id;
-      newTimer->event_flag = event_flag;
-      newTimer->timeout.time32 = timeout;
-      newTimer->next = (void *)NULL;
-      newTimer->reloadTimeout = 0;
-
-      // Does the timer list already exist
-      if ( timerHead == NULL )
-      {
-        // Start task list
-        timerHead = newTimer;
-      }
-      else
-      {
-        // Add it to the end of the timer list
-        srchTimer = timerHead;
+      return ( (osalTimerRec_t *)NULL );
+    }
 
-        // Stop at the last record
-        while ( srchTimer->next )
-          srchTimer = srchTimer->next;
+    // Fill in new timer
+    newTimer->task_id = task_id;
+    newTimer->event_flag = event_flag;
+    newTimer->reloadTimeout = 0;
+  }
 
-        // Add to the list
-        srchTimer->next = newTimer;
-      }
+  osalInsertTimer( newTimer, timeout );
 
-      return ( newTimer );
-    }
-    else
-    {
-      return ( (osalTimerRec_t *)NULL );
-    }
+  return ( newTimer );
+}
+
+/*********************************************************************
+ * @fn      osalInsertTimer
+ *
+ * @brief   Insert a timer into the timer list in order of expiry.
+ *          Timers with equal expiry keep the order they were added in.
+ *          Ints must be disabled.
+ *
+ * @param   newTimer - timer record, not in the list
+ * @param   timeout - in milliseconds from now
+ *
+ * @return  none
+ */
+static void osalInsertTimer( osalTimerRec_t *newTimer, uint32 timeout )
+{
+  osalTimerRec_t *srchTimer;
+  osalTimerRec_t *prevTimer = NULL;
+
+  // Head of the timer list
+  srchTimer = timerHead;
+
+  // Skip the timers that expire first, converting the timeout to a delta
+  while ( srchTimer && (srchTimer->timeout.time32 <= timeout) )
+  {
+    timeout -= srchTimer->timeout.time32;
+    prevTimer = srchTimer;
+    srchTimer = srchTimer->next;
+  }
+
+  newTimer->timeout.time32 = timeout;
+  newTimer->next = srchTimer;
+
+  // The following timer is now relative to the new one
+  if ( srchTimer )
+  {
+    srchTimer->timeout.time32 -= timeout;
+  }
+
+  if ( prevTimer == NULL )
+  {
+    timerHead = newTimer;
+  }
+  else
+  {
+    prevTimer->next = newTimer;
   }
 }
 
+/*********************************************************************
+ * @fn      osalUnlinkTimer
+ *
+ * @brief   Take a timer out of the timer list without freeing it.
+ *          Ints must be disabled.
+ *
+ * @param   rmTimer - timer record in the list
+ *
+ * @return  none
+ */
+static void osalUnlinkTimer( osalTimerRec_t *rmTimer )
+{
+  osalTimerRec_t *srchTimer;
+  osalTimerRec_t *prevTimer = NULL;
+
+  // Find the record before it
+  srchTimer = timerHead;
+  while ( srchTimer && (srchTimer != rmTimer) )
+  {
+    prevTimer = srchTimer;
+    srchTimer = srchTimer->next;
+  }
+
+  if ( srchTimer == NULL )
+  {
+    return;
+  }
+
+  // The following timer inherits the removed delta
+  if ( rmTimer->next )
+  {
+    ((osalTimerRec_t *)rmTimer->next)->timeout.time32 += rmTimer->timeout.time32;
+  }
+
+  if ( prevTimer == NULL )
+  {
+    timerHead = rmTimer->next;
+  }
+  else
+  {
+    prevTimer->next = rmTimer->next;
+  }
+
+  rmTimer->next = NULL;
+}
+
 /*********************************************************************
  * @fn      osalFindTimer
  *
@@ -233,6 +404,7 @@ osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag )
  * @fn      osalDeleteTimer
  *
  * @brief   Delete a timer from a timer list.
+ *          Ints must be disabled.
  *
  * @param   table
  * @param   rmTimer
@@ -244,9 +416,8 @@ void osalDeleteTimer( osalTimerRec_t *rmTimer )
   // Does the timer list really exist
   if ( rmTimer )
   {
-    // Clear the event flag and osalTimerUpdate() will delete
-    // the timer from the list.
-    rmTimer->event_flag = 0;
+    osalUnlinkTimer( rmTimer );
+    osalTimerFree( rmTimer );
   }
 }
 
@@ -365,11 +536,20 @@ uint32 osal_get_timeoutEx( uint8 task_id, uint16 event_id )
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-  tmr = osalFindTimer( task_id, event_id );
+  // Add up the deltas until the timer is found
+  for ( tmr = timerHead; tmr != NULL; tmr = tmr->next )
+  {
+    rtrn += tmr->timeout.time32;
 
-  if ( tmr )
+    if ( tmr->event_flag == event_id && tmr->task_id == task_id )
+    {
+      break;
+    }
+  }
+
+  if ( tmr == NULL )
   {
-    rtrn = tmr->timeout.time32;
+    rtrn = 0;
   }
 
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
@@ -409,6 +589,26 @@ uint8 osal_timer_num_active( void )
   return num_timers;
 }
 
+/*********************************************************************
+ * @fn      osal_timer_pool_overflow
+ *
+ * @brief
+ *
+ *   This function reports how many timers were started while the timer
+ *   record pool was empty and had to be allocated from the heap. A
+ *   non-zero count means OSAL_TIMERS_POOL_SIZE is too small.
+ *
+ * @return  uint16 - number of overflows, saturating at 0xFFFF
+ */
+uint16 osal_timer_pool_overflow( void )
+{
+#if OSAL_TIMERS_POOL_SIZE
+  return ( osalTimerPoolOverflow );
+#else
+  return ( 0 );
+#endif
+}
+
 /*********************************************************************
  * @fn      osalTimerUpdate
  *
@@ -422,113 +622,59 @@ void osalTimerUpdate( uint32 updateTime )
 {
   halIntState_t intState;
   osalTimerRec_t *srchTimer;
-  osalTimerRec_t *prevTimer;
-
-  osalTime_t timeUnion;
-  timeUnion.time32 = updateTime;
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
   // Update the system time
   osal_systemClock += updateTime;
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
 
-  // Look for open timer slot
-  if ( timerHead != NULL )
+  // Only the head of the timer list and the timers that expire are visited
+  for ( ;; )
   {
-    // Add it to the end of the timer list
-    srchTimer = timerHead;
-    prevTimer = (void *)NULL;
+    osalTimerRec_t *freeTimer = NULL;
 
-    // Look for open timer slot
-    while ( srchTimer )
-    {
-      osalTimerRec_t *freeTimer = NULL;
+    HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-      HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+    srchTimer = timerHead;
 
-      // To minimize time in this critical section, avoid 32-bit math
-      if ((timeUnion.time16[1] == 0) && (timeUnion.time8[1] == 0))
-      {
-        // If upper 24 bits are zero, check lower 8 bits for roll over
-        if (srchTimer->timeout.time8[0] >= timeUnion.time8[0])
-        {
-          // 8-bit math
-          srchTimer->timeout.time8[0] -= timeUnion.time8[0];
-        }
-        else
-        {
-          // 32-bit math
-          if (srchTimer->timeout.time32 > timeUnion.time32)
-          {
-            srchTimer->timeout.time32 -= timeUnion.time32;
-          }
-          else
-          {
-            srchTimer->timeout.time32 = 0;
-          }
-        }
-      }
-      else
+    if ( (srchTimer == NULL) || (srchTimer->timeout.time32 > updateTime) )
+    {
+      // Nothing else expires, the rest of the list is relative to the head
+      if ( srchTimer )
       {
-          // 32-bit math
-        if (srchTimer->timeout.time32 > timeUnion.time32)
-        {
-          srchTimer->timeout.time32 -= timeUnion.time32;
-        }
-        else
-        {
-          srchTimer->timeout.time32 = 0;
-        }
+        srchTimer->timeout.time32 -= updateTime;
       }
 
-      // Check for reloading
-      if ( (srchTimer->timeout.time16[0] == 0) && (srchTimer->timeout.time16[1] == 0) &&
-           (srchTimer->reloadTimeout) && (srchTimer->event_flag) )
-      {
-        // Notify the task of a timeout
-        osal_set_event( srchTimer->task_id, srchTimer->event_flag );
+      HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+      break;
+    }
 
-        // Reload the timer timeout value
-        srchTimer->timeout.time32 = srchTimer->reloadTimeout;
-      }
+    // Timeout - take out of list. The time left over is carried on to
+    // the following timers.
+    updateTime -= srchTimer->timeout.time32;
+    timerHead = srchTimer->next;
 
-      // When timeout or delete (event_flag == 0)
-      if ( ((srchTimer->timeout.time16[0] == 0) && (srchTimer->timeout.time16[1] == 0)) ||
-            (srchTimer->event_flag == 0) )
-      {
-        // Take out of list
-        if ( prevTimer == NULL )
-        {
-          timerHead = srchTimer->next;
-        }
-        else
-        {
-          prevTimer->next = srchTimer->next;
-        }
-
-        // Setup to free memory
-        freeTimer = srchTimer;
-
-        // Next
-        srchTimer = srchTimer->next;
-      }
-      else
-      {
-        // Get next
-        prevTimer = srchTimer;
-        srchTimer = srchTimer->next;
-      }
+    // Check for reloading
+    if ( srchTimer->reloadTimeout )
+    {
+      // Notify the task of a timeout
+      osal_set_event( srchTimer->task_id, srchTimer->event_flag );
 
-      HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+      // Reload the timer timeout value, counted from the end of this update
+      osalInsertTimer( srchTimer, srchTimer->reloadTimeout + updateTime );
+    }
+    else
+    {
+      // Setup to free memory
+      freeTimer = srchTimer;
+    }
 
-      if ( freeTimer )
-      {
-        if ( (freeTimer->timeout.time16[0] == 0) && (freeTimer->timeout.time16[1] == 0) )
-        {
-          osal_set_event( freeTimer->task_id, freeTimer->event_flag );
-        }
-        osal_mem_free( freeTimer );
-      }
+    HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
+    if ( freeTimer )
+    {
+      osal_set_event( freeTimer->task_id, freeTimer->event_flag );
+      osalTimerFree( freeTimer );
     }
   }
 }
@@ -566,8 +712,9 @@ void osal_adjust_timers( void )
  *
  * @brief
  *
- *   Search timer table to return the lowest timeout value. If the
- *   timer list is empty, then the returned timeout will be zero.
+ *   Return the lowest timeout value, held by the head of the timer
+ *   list. If the timer list is empty, then the returned timeout will
+ *   be zero.
  *
  * @param   none
  *
@@ -575,33 +722,8 @@ void osal_adjust_timers( void )
  *********************************************************************/
 uint32 osal_next_timeout( void )
 {
-  uint32 nextTimeout;
-  osalTimerRec_t *srchTimer;
-
-  if ( timerHead != NULL )
-  {
-    // Head of the timer list
-    srchTimer = timerHead;
-    nextTimeout = OSAL_TIMERS_MAX_TIMEOUT;
-
-    // Look for the next timeout timer
-    while ( srchTimer != NULL )
-    {
-      if (srchTimer->timeout.time32 < nextTimeout)
-      {
-        nextTimeout = srchTimer->timeout.time32;
-      }
-      // Check next timer
-      srchTimer = srchTimer->next;
-    }
-  }
-  else
-  {
-    // No timers
-    nextTimeout = 0;
-  }
-
-  return ( nextTimeout );
+  // The head of the timer list expires first
+  return ( (timerHead != NULL) ? timerHead->timeout.time32 : 0 );
 }
 #endif // POWER_SAVING || USE_ICALL
 
@@ -61,16 +61,25 @@
 #define START_PTR( bd_ptr )  ( (bd_ptr) + 1 )
 #define END_PTR( bd_ptr )    ( (uint8 *)START_PTR( bd_ptr ) + (bd_ptr)->payload_len )
 
+// Hash bucket of a payload pointer
+#define BM_HASH( ptr )       ( ((uint16)(size_t)(ptr) ^ ((uint16)(size_t)(ptr) >> 6)) & \
+                               (BM_HASH_SIZE - 1) )
+
 /*********************************************************************
  * CONSTANTS
  */
+// Number of hash buckets for the outstanding buffers, a power of 2
+#if !defined ( BM_HASH_SIZE )
+  #define BM_HASH_SIZE       16
+#endif
 
 /*********************************************************************
  * TYPEDEFS
  */
 typedef struct bm_desc
 {
-  struct bm_desc *next_ptr;    // pointer to next buffer descriptor
+  struct bm_desc *next_ptr;    // pointer to next buffer descriptor in the bucket
+  uint8          *payload_ptr; // payload pointer last handed out for this buffer
   uint16          payload_len; // length of user's buffer
 } bm_desc_t;
 
@@ -85,13 +94,15 @@ typedef struct bm_desc
 /*********************************************************************
  * LOCAL VARIABLES
  */
-// Linked list of allocated buffer descriptors
-static bm_desc_t *bm_list_ptr = NULL;
+// Allocated buffer descriptors, hashed by the payload pointer last handed out
+static bm_desc_t *bm_hash_tbl[BM_HASH_SIZE];
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 static bm_desc_t *bm_desc_from_payload ( uint8 *payload_ptr );
+static void bm_hash_add ( bm_desc_t *bd_ptr, uint8 *payload_ptr );
+static void bm_hash_remove ( bm_desc_t *bd_ptr );
 
 /*********************************************************************
  * @fn      osal_bm_alloc
@@ -120,9 +131,8 @@ void *osal_bm_alloc( uint16 size )
     // set the buffer descriptor info
     bd_ptr->payload_len  = size;
 
-    // add item to the beginning of the list
-    bd_ptr->next_ptr = bm_list_ptr;
-    bm_list_ptr = bd_ptr;
+    // add item to the hash table
+    bm_hash_add( bd_ptr, (uint8 *)START_PTR( bd_ptr ) );
 
     // return start of the buffer
     bd_ptr = START_PTR( bd_ptr );
@@ -145,40 +155,18 @@ void *osal_bm_alloc( uint16 size )
 void osal_bm_free( void *payload_ptr )
 {
   halIntState_t cs;
-  bm_desc_t *loop_ptr;
-  bm_desc_t *prev_ptr;
+  bm_desc_t *bd_ptr;
 
   HAL_ENTER_CRITICAL_SECTION(cs);
 
-  prev_ptr = NULL;
-
-  loop_ptr = bm_list_ptr;
-  while ( loop_ptr != NULL )
+  bd_ptr = bm_desc_from_payload( (uint8 *)payload_ptr );
+  if ( bd_ptr != NULL )
   {
-    if ( payload_ptr >= (void *)START_PTR( loop_ptr ) &&
-         payload_ptr <= (void *)END_PTR( loop_ptr) )
-    {
-      // unlink item from the linked list
-      if ( prev_ptr == NULL )
-      {
-        // it's the first item on the list
-        bm_list_ptr = loop_ptr->next_ptr;
-      }
-      else
-      {
-        prev_ptr->next_ptr = loop_ptr->next_ptr;
-      }
-
-      // free the memory
-      osal_mem_free( loop_ptr );
-
-      // we're done here
-      break;
-    }
+    // unlink item from the hash table
+    bm_hash_remove( bd_ptr );
 
-    // move on to next item
-    prev_ptr = loop_ptr;
-    loop_ptr = loop_ptr->next_ptr;
+    // free the memory
+    osal_mem_free( bd_ptr );
   }
 
   HAL_EXIT_CRITICAL_SECTION(cs);
@@ -211,6 +199,17 @@ void *osal_bm_adjust_header( void *payload_ptr, int16 size )
     if ( new_payload_ptr >= (uint8 *)START_PTR( bd_ptr ) &&
          new_payload_ptr <= (uint8 *)END_PTR( bd_ptr ) )
     {
+      // file the buffer under the new payload pointer
+      if ( new_payload_ptr != bd_ptr->payload_ptr )
+      {
+        halIntState_t cs;
+
+        HAL_ENTER_CRITICAL_SECTION(cs);
+        bm_hash_remove( bd_ptr );
+        bm_hash_add( bd_ptr, new_payload_ptr );
+        HAL_EXIT_CRITICAL_SECTION(cs);
+      }
+
       // return new payload pointer
       return ( (void *)new_payload_ptr );
     }
@@ -245,6 +244,17 @@ void *osal_bm_adjust_tail( void *payload_ptr, int16 size )
     if ( new_payload_ptr >= (uint8 *)START_PTR( bd_ptr ) &&
          new_payload_ptr <= (uint8 *)END_PTR( bd_ptr ) )
     {
+      // file the buffer under the new payload pointer
+      if ( new_payload_ptr != bd_ptr->payload_ptr )
+      {
+        halIntState_t cs;
+
+        HAL_ENTER_CRITICAL_SECTION(cs);
+        bm_hash_remove( bd_ptr );
+        bm_hash_add( bd_ptr, new_payload_ptr );
+        HAL_EXIT_CRITICAL_SECTION(cs);
+      }
+
       // return new payload pointer
       return ( (void *)new_payload_ptr );
     }
@@ -257,7 +267,10 @@ void *osal_bm_adjust_tail( void *payload_ptr, int16 size )
 /*********************************************************************
  * @fn      bm_desc_from_payload
  *
- * @brief   Find buffer descriptor from payload pointer
+ * @brief   Find buffer descriptor from payload pointer. The payload
+ *          pointer last handed out for a buffer is found in its hash
+ *          bucket; any other pointer into a buffer falls back to a
+ *          search of all outstanding buffers.
  *
  * @param   payload_ptr - pointer to payload
  *
@@ -266,22 +279,89 @@ void *osal_bm_adjust_tail( void *payload_ptr, int16 size )
 static bm_desc_t *bm_desc_from_payload ( uint8 *payload_ptr )
 {
   bm_desc_t *loop_ptr;
+  uint8 idx;
 
-  loop_ptr = bm_list_ptr;
+  loop_ptr = bm_hash_tbl[BM_HASH( payload_ptr )];
   while ( loop_ptr != NULL )
   {
-    if ( payload_ptr >= (uint8 *)START_PTR( loop_ptr ) &&
-         payload_ptr <= (uint8 *)END_PTR( loop_ptr) )
+    if ( loop_ptr->payload_ptr == payload_ptr )
     {
       // item found
-      break;
+      return ( loop_ptr );
     }
 
     // move on to next item
     loop_ptr = loop_ptr->next_ptr;
   }
 
-  return ( loop_ptr );
+  for ( idx = 0; idx < BM_HASH_SIZE; idx++ )
+  {
+    loop_ptr = bm_hash_tbl[idx];
+    while ( loop_ptr != NULL )
+    {
+      if ( payload_ptr >= (uint8 *)START_PTR( loop_ptr ) &&
+           payload_ptr <= (uint8 *)END_PTR( loop_ptr) )
+      {
+        // item found
+        return ( loop_ptr );
+      }
+
+      // move on to next item
+      loop_ptr = loop_ptr->next_ptr;
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      bm_hash_add
+ *
+ * @brief   Add a buffer descriptor to the hash bucket of its payload
+ *          pointer. Ints must be disabled.
+ *
+ * @param   bd_ptr - pointer to buffer descriptor
+ * @param   payload_ptr - payload pointer handed out for the buffer
+ *
+ * @return  none
+ */
+static void bm_hash_add ( bm_desc_t *bd_ptr, uint8 *payload_ptr )
+{
+  bm_desc_t **head_ptr = &bm_hash_tbl[BM_HASH( payload_ptr )];
+
+  bd_ptr->payload_ptr = payload_ptr;
+
+  // add item to the beginning of the bucket
+  bd_ptr->next_ptr = *head_ptr;
+  *head_ptr = bd_ptr;
+}
+
+/*********************************************************************
+ * @fn      bm_hash_remove
+ *
+ * @brief   Remove a buffer descriptor from its hash bucket.
+ *          Ints must be disabled.
+ *
+ * @param   bd_ptr - pointer to buffer descriptor
+ *
+ * @return  none
+ */
+static void bm_hash_remove ( bm_desc_t *bd_ptr )
+{
+  bm_desc_t **link_ptr = &bm_hash_tbl[BM_HASH( bd_ptr->payload_ptr )];
+
+  while ( *link_ptr != NULL )
+  {
+    if ( *link_ptr == bd_ptr )
+    {
+      // unlink item from the bucket
+      *link_ptr = bd_ptr->next_ptr;
+      break;
+    }
+
+    // move on to next item
+    link_ptr = &(*link_ptr)->next_ptr;
+  }
 }
 
 
@@ -57,26 +57,30 @@
 /*********************************************************************
  * MACROS
  */
-// Macros to convert one-dimensional index 'timer id' to two-dimensional indices
-// 'task id' and 'event id'.
-
-// Find out event id using timer id
-#define EVENT_ID( timerId )            ( 0x0001 << ( ( timerId ) % NUM_CBTIMERS_PER_TASK ) )
-
-// Find out task id using timer id
-#define TASK_ID( timerId )             ( ( ( timerId ) / NUM_CBTIMERS_PER_TASK ) + baseTaskID )
-
-// Find out bank task id using task id
-#define BANK_TASK_ID( taskId )         ( ( baseTaskID - ( taskId ) ) * NUM_CBTIMERS )
 
 /*********************************************************************
  * CONSTANTS
  */
-// Number of callback timers supported per task (limited by the number of OSAL event timers)
-#define NUM_CBTIMERS_PER_TASK          15
+// Number of callback timers. Timer ids are uint8, with INVALID_TIMER_ID and
+// TIMEOUT_TIMER_ID reserved, so at most 254 timers can be configured.
+#if !defined ( OSAL_CBTIMER_NUM_TIMERS )
+  #define OSAL_CBTIMER_NUM_TIMERS      ( OSAL_CBTIMER_NUM_TASKS * 15 )
+#endif
+
+#if ( OSAL_CBTIMER_NUM_TIMERS > 254 )
+  #error Maximum of 254 callback timers are supported!
+#endif
 
-// Total number of callback timers
-#define NUM_CBTIMERS                   ( OSAL_CBTIMER_NUM_TASKS * NUM_CBTIMERS_PER_TASK )
+// OSAL event of the base task used to run the head of the timer list
+#define CBTIMER_EXPIRE_EVT             0x0001
+
+// End of a timer list
+#define CBTIMER_NIL                    INVALID_TIMER_ID
+
+// Callback timer states
+#define CBTIMER_FREE                   0 // on the free list
+#define CBTIMER_ACTIVE                 1 // on the timer list
+#define CBTIMER_FIRED                  2 // expired, callback being dispatched
 
 /*********************************************************************
  * TYPEDEFS
@@ -86,6 +90,10 @@ typedef struct
 {
   pfnCbTimer_t  pfnCbTimer; // callback function to be called when timer expires
   uint8        *pData;      // data to be passed in to callback function
+  uint32        timeout;    // mSecs after the previous timer on the timer list
+  uint32        reload;     // reload timeout in mSecs, 0 if not reloading
+  uint8         next;       // next timer on the timer, free or fired list
+  uint8         state;      // CBTIMER_FREE, CBTIMER_ACTIVE or CBTIMER_FIRED
 } cbTimer_t;
 
 /*********************************************************************
@@ -105,10 +113,17 @@ uint16 baseTaskID = TASK_NO_TASK;
 /*********************************************************************
  * LOCAL VARIABLES
  */
-// Callback Timers table.
-#if ( NUM_CBTIMERS > 0 )
-  cbTimer_t cbTimers[NUM_CBTIMERS];
-#endif
+// Callback Timers table, indexed by timer id.
+static cbTimer_t cbTimers[OSAL_CBTIMER_NUM_TIMERS];
+
+// Active timers sorted by expiry, each timeout relative to the previous one
+static uint8 cbTimerHead;
+
+// Unused timers
+static uint8 cbTimerFreeHead;
+
+// Timeout the OSAL event timer was last started with (the head's timeout)
+static uint32 cbTimerArmed;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
@@ -119,6 +134,12 @@ static Status_t cbTimerSetup( pfnCbTimer_t  pfnCbTimer,
                               uint32        timeout,
                               uint8        *pTimerId,
                               uint8         reload );
+static void cbTimerSync( void );
+static Status_t cbTimerArm( void );
+static void cbTimerInsert( uint8 timerId, uint32 timeout );
+static void cbTimerUnlink( uint8 timerId );
+static void cbTimerRelease( uint8 timerId );
+static void cbTimerDispatch( void );
 
 /*********************************************************************
  * API FUNCTIONS
@@ -130,6 +151,7 @@ static Status_t cbTimerSetup( pfnCbTimer_t  pfnCbTimer,
  *
  * @brief       Callback Timer task initialization function. This function
  *              can be called more than once (OSAL_CBTIMER_NUM_TASKS times).
+ *              All callback timers run on the first task initialized.
  *
  * @param       taskId - Message Timer task ID.
  *
@@ -139,11 +161,23 @@ void osal_CbTimerInit( uint8 taskId )
 {
   if ( baseTaskID == TASK_NO_TASK )
   {
+    uint8 i;
+
     // Only initialize the base task id
     baseTaskID = taskId;
 
-    // Initialize all timer structures
+    // Initialize all timer structures and put them on the free list
     osal_memset( cbTimers, 0, sizeof( cbTimers ) );
+
+    for ( i = 0; i < OSAL_CBTIMER_NUM_TIMERS; i++ )
+    {
+      cbTimers[i].next = i + 1;
+    }
+    cbTimers[OSAL_CBTIMER_NUM_TIMERS-1].next = CBTIMER_NIL;
+
+    cbTimerFreeHead = 0;
+    cbTimerHead = CBTIMER_NIL;
+    cbTimerArmed = 0;
   }
 }
 
@@ -160,6 +194,8 @@ void osal_CbTimerInit( uint8 taskId )
  */
 uint16 osal_CbTimerProcessEvent( uint8 taskId, uint16 events )
 {
+  (void)taskId;  // All timers run on baseTaskID
+
   if ( events & SYS_EVENT_MSG )
   {
     // Process OSAL messages
@@ -168,51 +204,13 @@ uint16 osal_CbTimerProcessEvent( uint8 taskId, uint16 events )
     return ( events ^ SYS_EVENT_MSG );
   }
 
-  if ( events )
+  if ( events & CBTIMER_EXPIRE_EVT )
   {
-    uint8 i;
-    uint16 event = 0;
-    halIntState_t cs;
-
-    HAL_ENTER_CRITICAL_SECTION(cs);
-
-    // Process event timers
-    for ( i = 0; i < NUM_CBTIMERS_PER_TASK; i++ )
-    {
-      if ( ( events >> i ) & 0x0001 )
-      {
-        cbTimer_t *pTimer = &cbTimers[BANK_TASK_ID( taskId )+i];
-
-        // Found the first event
-        event =  0x0001 << i;
-
-        // check there is a callback function to call
-        if ( pTimer->pfnCbTimer != NULL )
-        {
-          // Timer expired, call the registered callback function
-          pTimer->pfnCbTimer( pTimer->pData );
-        }
-
-        // check if the timer is still active
-        // Note: An active timer means the timer was started with reload!
-        if ( osal_get_timeoutEx( taskId, event ) == 0 )
-        {
-          // Mark entry as free
-          pTimer->pfnCbTimer = NULL;
-
-          // Null out data pointer
-          pTimer->pData = NULL;
-        }
-
-        // We only process one event at a time
-        break;
-      }
-    }
-
-    HAL_EXIT_CRITICAL_SECTION(cs);
+    // Call back every timer that has expired
+    cbTimerDispatch();
 
     // return unprocessed events
-    return ( events ^ event );
+    return ( events ^ CBTIMER_EXPIRE_EVT );
   }
 
   // If reach here, the events are unknown
@@ -308,20 +306,32 @@ Status_t osal_CbTimerUpdate( uint8 timerId, uint32 timeout )
   HAL_ENTER_CRITICAL_SECTION(cs);
 
   // Look for the existing timer
-  if ( timerId < NUM_CBTIMERS )
+  if ( timerId < OSAL_CBTIMER_NUM_TIMERS )
   {
-    if ( cbTimers[timerId].pfnCbTimer != NULL )
+    cbTimer_t *pTimer = &cbTimers[timerId];
+
+    if ( pTimer->state == CBTIMER_ACTIVE )
     {
-      // Make sure the corresponding OSAL event timer is still running
-      if ( osal_get_timeoutEx( TASK_ID( timerId ), EVENT_ID( timerId ) ) != 0 )
-      {
-        // Timer exists; update it
-        osal_start_timerEx( TASK_ID( timerId ), EVENT_ID( timerId ), timeout );
+      // Timer exists; move it to its new place on the timer list
+      cbTimerSync();
+      cbTimerUnlink( timerId );
+      cbTimerInsert( timerId, timeout );
+      (void)cbTimerArm();
 
-        HAL_EXIT_CRITICAL_SECTION(cs);
+      HAL_EXIT_CRITICAL_SECTION(cs);
 
-        return (  SUCCESS );
-      }
+      return ( SUCCESS );
+    }
+    else if ( ( pTimer->state == CBTIMER_FIRED ) &&
+              ( pTimer->pfnCbTimer != NULL )     &&
+              ( pTimer->reload != 0 ) )
+    {
+      // Reload timer in its own callback; used instead of the reload timeout
+      pTimer->timeout = timeout;
+
+      HAL_EXIT_CRITICAL_SECTION(cs);
+
+      return ( SUCCESS );
     }
   }
 
@@ -350,18 +360,30 @@ Status_t osal_CbTimerStop( uint8 timerId )
   HAL_ENTER_CRITICAL_SECTION(cs);
 
   // Look for the existing timer
-  if ( timerId < NUM_CBTIMERS )
+  if ( timerId < OSAL_CBTIMER_NUM_TIMERS )
   {
-    if ( cbTimers[timerId].pfnCbTimer != NULL )
+    cbTimer_t *pTimer = &cbTimers[timerId];
+
+    if ( pTimer->state == CBTIMER_ACTIVE )
     {
-      // Timer exists; stop the OSAL event timer first
-      osal_stop_timerEx( TASK_ID( timerId ), EVENT_ID( timerId ) );
+      // Timer exists; take it off the timer list first
+      cbTimerSync();
+      cbTimerUnlink( timerId );
+      cbTimerRelease( timerId );
+      (void)cbTimerArm();
 
-      // Mark entry as free
-      cbTimers[timerId].pfnCbTimer = NULL;
+      HAL_EXIT_CRITICAL_SECTION(cs);
+
+      return ( SUCCESS );
+    }
+    else if ( ( pTimer->state == CBTIMER_FIRED ) &&
+              ( pTimer->pfnCbTimer != NULL ) )
+    {
+      // Timer is being dispatched; it is released once its turn comes
+      pTimer->pfnCbTimer = NULL;
 
       // Null out data pointer
-      cbTimers[timerId].pData = NULL;
+      pTimer->pData = NULL;
 
       HAL_EXIT_CRITICAL_SECTION(cs);
 
@@ -418,34 +440,44 @@ static Status_t cbTimerSetup( pfnCbTimer_t  pfnCbTimer,
     return ( INVALIDPARAMETER );
   }
 
-  // Look for an unused timer first
-  for ( i = 0; i < NUM_CBTIMERS; i++ )
+  // Take an unused timer
+  i = cbTimerFreeHead;
+  if ( i != CBTIMER_NIL )
   {
-    if ( cbTimers[i].pfnCbTimer == NULL )
+    cbTimer_t *pTimer = &cbTimers[i];
+
+    cbTimerFreeHead = pTimer->next;
+
+    // Set up the callback timer
+    pTimer->pfnCbTimer = pfnCbTimer;
+    pTimer->pData      = pData;
+    pTimer->state      = CBTIMER_ACTIVE;
+
+    // A zero reload timeout would never leave the dispatch loop
+    pTimer->reload = ( reload == TRUE ) ? ( ( timeout != 0 ) ? timeout : 1 ) : 0;
+
+    // Put it on the timer list and (re)start the OSAL event timer
+    cbTimerSync();
+    cbTimerInsert( i, timeout );
+
+    if ( cbTimerArm() == SUCCESS )
     {
-      // Start the OSAL event timer first
-      if ( ( (reload==TRUE)          ?
-             osal_start_reload_timer :
-             osal_start_timerEx )( TASK_ID( i ), EVENT_ID( i ), timeout ) == SUCCESS )
+      // Check if the caller wants the timer Id
+      if ( pTimerId != NULL )
       {
-        // Set up the callback timer
-        // Note: An odd pointer will be used to indicate to the process event
-        //       handler that the timer was started with reload.
-        cbTimers[i].pfnCbTimer = pfnCbTimer; //(pfnCbTimer_t)((uint32)pfnCbTimer | reload);
-        cbTimers[i].pData      = pData;
-
-        // Check if the caller wants the timer Id
-        if ( pTimerId != NULL )
-        {
-          // Caller is interested in the timer id
-          *pTimerId = i;
-        }
-
-        HAL_EXIT_CRITICAL_SECTION(cs);
-
-        return ( SUCCESS );
+        // Caller is interested in the timer id
+        *pTimerId = i;
       }
+
+      HAL_EXIT_CRITICAL_SECTION(cs);
+
+      return ( SUCCESS );
     }
+
+    // No OSAL event timer available; undo
+    cbTimerUnlink( i );
+    cbTimerRelease( i );
+    (void)cbTimerArm();
   }
 
   HAL_EXIT_CRITICAL_SECTION(cs);
@@ -454,5 +486,245 @@ static Status_t cbTimerSetup( pfnCbTimer_t  pfnCbTimer,
   return ( NO_TIMER_AVAIL );
 }
 
+/*********************************************************************
+ * @fn      cbTimerSync
+ *
+ * @brief   Take the time elapsed since the OSAL event timer was started
+ *          off the head of the timer list. Ints must be disabled.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void cbTimerSync( void )
+{
+  if ( cbTimerArmed != 0 )
+  {
+    uint32 remaining = osal_get_timeoutEx( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+
+    cbTimers[cbTimerHead].timeout = remaining;
+    cbTimerArmed = remaining;
+  }
+}
+
+/*********************************************************************
+ * @fn      cbTimerArm
+ *
+ * @brief   Start the OSAL event timer with the timeout of the head of
+ *          the timer list, or stop it if the list is empty. Must follow
+ *          cbTimerSync() and any change to the list. Ints must be
+ *          disabled.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS or NO_TIMER_AVAIL
+ */
+static Status_t cbTimerArm( void )
+{
+  if ( cbTimerHead == CBTIMER_NIL )
+  {
+    cbTimerArmed = 0;
+    osal_stop_timerEx( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+
+    return ( SUCCESS );
+  }
+
+  cbTimerArmed = cbTimers[cbTimerHead].timeout;
+  if ( cbTimerArmed == 0 )
+  {
+    // Already expired; dispatch on the next pass of the OSAL loop
+    osal_stop_timerEx( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+    osal_set_event( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+
+    return ( SUCCESS );
+  }
+
+  if ( osal_start_timerEx( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT, cbTimerArmed ) != SUCCESS )
+  {
+    cbTimerArmed = 0;
+
+    return ( NO_TIMER_AVAIL );
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      cbTimerInsert
+ *
+ * @brief   Insert a timer into the timer list after all timers that
+ *          expire no later. Ints must be disabled.
+ *
+ * @param   timerId - timer to insert
+ * @param   timeout - in milliseconds from now
+ *
+ * @return  none
+ */
+static void cbTimerInsert( uint8 timerId, uint32 timeout )
+{
+  uint8 *pLink = &cbTimerHead;
+
+  while ( ( *pLink != CBTIMER_NIL ) && ( cbTimers[*pLink].timeout <= timeout ) )
+  {
+    timeout -= cbTimers[*pLink].timeout;
+    pLink = &cbTimers[*pLink].next;
+  }
+
+  if ( *pLink != CBTIMER_NIL )
+  {
+    // The next timer is now relative to this one
+    cbTimers[*pLink].timeout -= timeout;
+  }
+
+  cbTimers[timerId].timeout = timeout;
+  cbTimers[timerId].next = *pLink;
+  *pLink = timerId;
+}
+
+/*********************************************************************
+ * @fn      cbTimerUnlink
+ *
+ * @brief   Remove a timer from the timer list. Ints must be disabled.
+ *
+ * @param   timerId - timer on the timer list
+ *
+ * @return  none
+ */
+static void cbTimerUnlink( uint8 timerId )
+{
+  uint8 *pLink = &cbTimerHead;
+
+  while ( *pLink != timerId )
+  {
+    pLink = &cbTimers[*pLink].next;
+  }
+
+  *pLink = cbTimers[timerId].next;
+
+  if ( *pLink != CBTIMER_NIL )
+  {
+    // The next timer inherits the time of the removed one
+    cbTimers[*pLink].timeout += cbTimers[timerId].timeout;
+  }
+}
+
+/*********************************************************************
+ * @fn      cbTimerRelease
+ *
+ * @brief   Return a timer to the free list. Ints must be disabled.
+ *
+ * @param   timerId - timer not on the timer list
+ *
+ * @return  none
+ */
+static void cbTimerRelease( uint8 timerId )
+{
+  cbTimer_t *pTimer = &cbTimers[timerId];
+
+  // Mark entry as free
+  pTimer->pfnCbTimer = NULL;
+
+  // Null out data pointer
+  pTimer->pData = NULL;
+
+  pTimer->state = CBTIMER_FREE;
+  pTimer->next = cbTimerFreeHead;
+  cbTimerFreeHead = timerId;
+}
+
+/*********************************************************************
+ * @fn      cbTimerDispatch
+ *
+ * @brief   Take every expired timer off the timer list and call its
+ *          callback function, in expiry order. Reload timers go back
+ *          on the timer list after their callback, the others are
+ *          released. Timers started by the callbacks are dispatched on
+ *          a later pass.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void cbTimerDispatch( void )
+{
+  halIntState_t cs;
+  uint8 fired;
+  uint8 last;
+
+  HAL_ENTER_CRITICAL_SECTION(cs);
+
+  cbTimerSync();
+
+  // Detach the expired timers at the head of the timer list
+  fired = cbTimerHead;
+  last = CBTIMER_NIL;
+  while ( ( cbTimerHead != CBTIMER_NIL ) && ( cbTimers[cbTimerHead].timeout == 0 ) )
+  {
+    last = cbTimerHead;
+    cbTimers[last].state = CBTIMER_FIRED;
+    cbTimerHead = cbTimers[last].next;
+  }
+
+  if ( last == CBTIMER_NIL )
+  {
+    fired = CBTIMER_NIL;
+  }
+  else
+  {
+    cbTimers[last].next = CBTIMER_NIL;
+  }
+
+  if ( cbTimerArm() != SUCCESS )
+  {
+    // Retry on the next pass of the OSAL loop
+    osal_set_event( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(cs);
+
+  while ( fired != CBTIMER_NIL )
+  {
+    cbTimer_t *pTimer = &cbTimers[fired];
+    pfnCbTimer_t pfnCbTimer;
+    uint8 *pData;
+
+    HAL_ENTER_CRITICAL_SECTION(cs);
+    pfnCbTimer = pTimer->pfnCbTimer;
+    pData = pTimer->pData;
+    HAL_EXIT_CRITICAL_SECTION(cs);
+
+    // check there is a callback function to call (it may have been stopped)
+    if ( pfnCbTimer != NULL )
+    {
+      // Timer expired, call the registered callback function
+      pfnCbTimer( pData );
+    }
+
+    HAL_ENTER_CRITICAL_SECTION(cs);
+
+    last = fired;
+    fired = pTimer->next;
+
+    if ( ( pTimer->pfnCbTimer != NULL ) && ( pTimer->reload != 0 ) )
+    {
+      // Reload, unless the callback asked for another timeout
+      pTimer->state = CBTIMER_ACTIVE;
+      cbTimerSync();
+      cbTimerInsert( last, ( pTimer->timeout != 0 ) ? pTimer->timeout : pTimer->reload );
+
+      if ( cbTimerArm() != SUCCESS )
+      {
+        osal_set_event( (uint8)baseTaskID, CBTIMER_EXPIRE_EVT );
+      }
+    }
+    else
+    {
+      cbTimerRelease( last );
+    }
+
+    HAL_EXIT_CRITICAL_SECTION(cs);
+  }
+}
+
 /****************************************************************************
 ****************************************************************************/
@@ -98,6 +98,26 @@ extern "C"
 /*** Interrupts ***/
 #define INTS_ALL    0xFF
 
+/*** Event Loop Trace ***/
+
+// Record the OSAL event loop in a ring buffer and keep per-task run time and
+// queueing delay statistics, see osal_event_trace_read() and osal_task_stats().
+#if !defined ( OSAL_EVENT_TRACE )
+  #define OSAL_EVENT_TRACE  FALSE
+#endif
+
+/* Event loop trace record, 6 bytes, multi-byte fields little endian:
+ *   [0]    op     - OSAL_EVENT_TRACE_SET, OSAL_EVENT_TRACE_RUN or OSAL_EVENT_TRACE_DONE
+ *   [1]    task   - ID of the task the events belong to
+ *   [2..3] events - events set, events passed to the task, or events it returned
+ *   [4..5] tick   - OSAL_EVENT_TRACE_TICK() when the record was written
+ */
+#define OSAL_EVENT_TRACE_REC_SZ  6
+
+#define OSAL_EVENT_TRACE_SET     0x01
+#define OSAL_EVENT_TRACE_RUN     0x02
+#define OSAL_EVENT_TRACE_DONE    0x03
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -125,6 +145,25 @@ typedef struct
 
 typedef void * osal_msg_q_t;
 
+#if ( OSAL_EVENT_TRACE )
+// Distribution of a task's run time or queueing delay, in trace ticks.
+// p99 is an upper bound, exact to a power of two.
+typedef struct
+{
+  uint16 min;
+  uint16 avg;
+  uint16 max;
+  uint16 p99;
+} osal_trace_time_t;
+
+typedef struct
+{
+  uint16            count;  // Dispatches measured, halved whenever it would overflow
+  osal_trace_time_t run;    // From the call of the task's event handler to its return
+  osal_trace_time_t wait;   // From the task becoming ready to the call of its handler
+} osal_task_stats_t;
+#endif
+
 #ifdef USE_ICALL
 /* High resolution timer callback function type */
 typedef void (*osal_highres_timer_cback_t)(void *arg);
@@ -225,6 +264,11 @@ extern void (*osal_eventloop_hook)(void);
    */
   extern uint8 osal_clear_event( uint8 task_id, uint16 event_flag );
 
+  /*
+   * Check whether any task has an event pending
+   */
+  extern uint8 osal_tasks_ready( void );
+
 
 /*** Interrupt Management  ***/
 
@@ -289,6 +333,30 @@ extern void (*osal_eventloop_hook)(void);
    */
   extern uint8 osal_self( void );
 
+#if ( OSAL_EVENT_TRACE )
+/*** Event Loop Trace ***/
+
+  /*
+   * Read the oldest event loop trace records out of the trace buffer
+   */
+  extern uint16 osal_event_trace_read( uint8 *buf, uint16 len );
+
+  /*
+   * Number of event loop trace records overwritten before they were read
+   */
+  extern uint16 osal_event_trace_lost( void );
+
+  /*
+   * Get the run time and queueing delay statistics of a task
+   */
+  extern uint8 osal_task_stats( uint8 task_id, osal_task_stats_t *pStats );
+
+  /*
+   * Clear the statistics of all tasks
+   */
+  extern void osal_task_stats_reset( void );
+#endif
+
 
 /*** Helper Functions ***/
 
@@ -66,6 +66,26 @@ extern "C"
   #define OSALMEM_METRICS  FALSE
 #endif
 
+// Record every allocation and free in a ring buffer, see osal_mem_trace_read().
+#if !defined ( OSALMEM_TRACE )
+  #define OSALMEM_TRACE  FALSE
+#endif
+
+/* Heap trace record, 8 bytes, multi-byte fields little endian:
+ *   [0]    op     - OSALMEM_TRACE_ALLOC, OSALMEM_TRACE_FREE or OSALMEM_TRACE_KICK
+ *   [1]    caller - ID of the OSAL task running at the time, TASK_NO_TASK outside of tasks
+ *   [2..3] size   - bytes requested by osal_mem_alloc(), block length for osal_mem_free()
+ *   [4..5] offset - offset of the block header in the heap, 0xFFFF when an allocation failed
+ *   [6..7] tick   - low 16 bits of osal_GetSystemClock()
+ */
+#define OSALMEM_TRACE_REC_SZ   8
+
+#define OSALMEM_TRACE_ALLOC    0x01
+#define OSALMEM_TRACE_FREE     0x02
+#define OSALMEM_TRACE_KICK     0x03
+
+#define OSALMEM_TRACE_NO_BLK   0xFFFF
+
 /*********************************************************************
  * MACROS
  */
@@ -134,6 +154,28 @@ extern "C"
   * Return the current number of bytes allocated.
   */
   uint16 osal_heap_mem_used( void );
+
+ /*
+  * Return the maximum number of blocks ever visited by one first-fit search.
+  */
+  uint16 osal_heap_search_max( void );
+
+ /*
+  * Return the largest number of bytes that could be allocated at once.
+  */
+  uint16 osal_heap_largest_free( void );
+#endif
+
+#if ( OSALMEM_TRACE )
+ /*
+  * Read the oldest heap trace records out of the trace buffer.
+  */
+  uint16 osal_mem_trace_read( uint8 *buf, uint16 len );
+
+ /*
+  * Return the number of trace records overwritten before they were read.
+  */
+  uint16 osal_mem_trace_lost( void );
 #endif
 
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
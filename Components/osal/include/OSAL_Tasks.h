@@ -61,6 +61,13 @@ extern "C"
  * MACROS
  */
 
+/*
+ * Compile time check that a task table fits the ready map of the
+ * scheduler; a larger table fails with a negative array size.
+ */
+#define OSAL_TASKS_ASSERT_CNT( tbl ) \
+  typedef char osalTasksCnt_assert_t[-1+10*((sizeof(tbl)/sizeof((tbl)[0])) <= OSAL_READY_MAP_TASKS)]
+
 /*********************************************************************
  * CONSTANTS
  */
@@ -70,6 +77,9 @@ extern "C"
 #define TASK_NO_TASK      0xFF
 #endif /* USE_ICALL */
 
+// Maximum number of tasks, one per bit of the scheduler's ready map
+#define OSAL_READY_MAP_TASKS  32
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -126,6 +126,11 @@ extern "C"
    */
   extern uint8 osal_timer_num_active( void );
 
+  /*
+   * Count timers that did not fit in the timer record pool
+   */
+  extern uint16 osal_timer_pool_overflow( void );
+
   /*
    * Set the hardware timer interrupts for sleep mode.
    * These functions should only be called in OSAL_PwrMgr.c
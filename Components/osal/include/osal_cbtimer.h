@@ -74,6 +74,8 @@ extern "C"
 /*********************************************************************
  * MACROS
  */
+// All callback timers run on the first callback timer task; their number is
+// set with OSAL_CBTIMER_NUM_TIMERS (default 15 per callback timer task).
 #if ( OSAL_CBTIMER_NUM_TASKS == 0 )
   #error Callback Timer module shouldn't be included (no callback timer is needed)!
 #elif ( OSAL_CBTIMER_NUM_TASKS == 1 )
@@ -63,6 +63,23 @@ extern "C"
  * CONSTANTS
  */
 
+// Keep short items written with osal_snv_write() in a RAM cache and write
+// them to flash later, see osal_snv_flush(). Requires the callback timer
+// module. The cache is written within OSAL_NV_CACHE_DELAY, and its flush
+// timer keeps the device out of PM3 until then. SystemReset(),
+// SystemResetSoft() and the OAD target flush it before they reset, but a
+// power loss, watchdog or assert reset in that window loses its items.
+#if !defined OSAL_SNV_WRITE_BACK
+#define OSAL_SNV_WRITE_BACK   FALSE
+#endif
+
+// Compact the active page in short steps run from a callback timer, so that
+// a write only waits for compaction when the page is full. Requires the
+// callback timer module.
+#if !defined OSAL_SNV_INCREMENTAL_COMPACT
+#define OSAL_SNV_INCREMENTAL_COMPACT  FALSE
+#endif
+
 /*********************************************************************
  * MACROS
  */
@@ -138,6 +155,29 @@ extern uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf);
  */
 extern uint8 osal_snv_compact( uint8 threshold );
 
+/*********************************************************************
+ * @fn      osal_snv_flush
+ *
+ * @brief   Write the items held in the write-back cache to flash. Call
+ *          before powering down or resetting the device on purpose.
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+extern uint8 osal_snv_flush( void );
+
+/*********************************************************************
+ * @fn      osal_snv_erase_count
+ *
+ * @brief   Read the number of times an NV page was erased. Only the
+ *          wear-leveled implementation, osal_snv_wl.c, counts erases;
+ *          osal_snv.c always returns 0.
+ *
+ * @param   idx - NV page index, below HAL_NV_PAGE_CNT
+ *
+ * @return  erase count, 0 for an invalid page index
+ */
+extern uint32 osal_snv_erase_count( uint8 idx );
+
 /*********************************************************************
 *********************************************************************/
 
@@ -57,9 +57,12 @@
 #include "osal_snv.h"
 #include "hal_assert.h"
 #include "saddr.h"
+#if OSAL_SNV_WRITE_BACK || OSAL_SNV_INCREMENTAL_COMPACT
+#include "osal_cbtimer.h"
+#endif
 
 #ifdef OSAL_SNV_UINT16_ID
-# error "This OSAL SNV implementation does not support the extended ID space"
+# error "This OSAL SNV implementation does not support the extended ID space, use osal_snv_wl.c"
 #endif
 
 /*********************************************************************
@@ -113,6 +116,52 @@
 #define OSAL_NV_MIN_COMPACT_THRESHOLD   70 // Minimum compaction threshold
 #define OSAL_NV_MAX_COMPACT_THRESHOLD   95 // Maximum compaction threshold
 
+// Number of item IDs held by the RAM index of the active page. IDs beyond
+// that are still found by searching the page.
+#if !defined OSAL_NV_INDEX_SIZE
+#define OSAL_NV_INDEX_SIZE      32
+#endif
+
+#if OSAL_SNV_WRITE_BACK
+// Number of items held by the write-back cache
+#if !defined OSAL_NV_CACHE_CNT
+#define OSAL_NV_CACHE_CNT       4
+#endif
+
+// Longest item held by the write-back cache; longer items are written through
+#if !defined OSAL_NV_CACHE_ITEM_LEN
+#define OSAL_NV_CACHE_ITEM_LEN  32
+#endif
+
+// Longest time in milliseconds an item stays in the write-back cache
+#if !defined OSAL_NV_CACHE_DELAY
+#define OSAL_NV_CACHE_DELAY     2000
+#endif
+#endif
+
+#if OSAL_SNV_INCREMENTAL_COMPACT
+// Flash words read or written by one compaction step. A step copies at
+// least one item, whatever its length.
+#if !defined OSAL_NV_COMPACT_STEP
+#define OSAL_NV_COMPACT_STEP    32
+#endif
+
+// Time in milliseconds between compaction steps
+#if !defined OSAL_NV_COMPACT_INTERVAL
+#define OSAL_NV_COMPACT_INTERVAL  10
+#endif
+
+// Active page usage in percent at which a write starts compaction
+#if !defined OSAL_NV_COMPACT_START
+#define OSAL_NV_COMPACT_START   90
+#endif
+
+// Compaction states
+#define OSAL_NV_COMPACT_IDLE    0 // No compaction in progress
+#define OSAL_NV_COMPACT_COPY    1 // Copying the active page to nvCompactPg
+#define OSAL_NV_COMPACT_ERASE   2 // nvCompactPg is the old page, to be erased
+#endif
+
 /*********************************************************************
  * MACROS
  */
@@ -139,6 +188,23 @@ typedef struct
 } osalNvItemHdr_t;
 // Note that osalSnvId_t and osalSnvLen_t cannot be bigger than uint16
 
+// RAM index entry: offset of the latest value of an item in the active page
+typedef struct
+{
+  osalSnvId_t id;
+  uint16      offset;
+} osalNvIndex_t;
+
+#if OSAL_SNV_WRITE_BACK
+// Write-back cache entry
+typedef struct
+{
+  osalSnvId_t  id;
+  osalSnvLen_t len;
+  uint8        buf[OSAL_NV_CACHE_ITEM_LEN];
+} osalNvCache_t;
+#endif
+
 /*********************************************************************
  * EXTERNAL FUNCTIONS
  */
@@ -178,6 +244,49 @@ static uint16 pgOff;
 // another write or erase.
 static uint8 failF;
 
+// Item offsets in the active page, sorted by ID
+static osalNvIndex_t nvIndex[OSAL_NV_INDEX_SIZE];
+static uint8 nvIndexCnt;
+
+// flag to indicate that every valid item of the active page is in nvIndex,
+// so that an ID missing from it does not exist.
+static uint8 nvIndexAll;
+
+#if OSAL_SNV_WRITE_BACK
+// Items not yet written to flash, oldest first
+static osalNvCache_t nvCache[OSAL_NV_CACHE_CNT];
+static uint8 nvCacheCnt;
+
+// Callback timer flushing the cache
+static uint8 nvCacheTimer = INVALID_TIMER_ID;
+#endif
+
+#if OSAL_SNV_INCREMENTAL_COMPACT
+// Compaction state, see OSAL_NV_COMPACT_IDLE
+static uint8 nvCompactState;
+
+// Page being filled while copying, or being erased afterwards
+static uint8 nvCompactPg;
+
+// Active page offset when compaction started. Items past it were written
+// since and are copied by the last step.
+static uint16 nvCompactEnd;
+
+// Next item header to check in the active page, walking down
+static uint16 nvCompactSrcOff;
+
+// Offset where to copy the next item to in nvCompactPg
+static uint16 nvCompactDstOff;
+
+// Callback timer running the compaction steps
+static uint8 nvCompactTimer = INVALID_TIMER_ID;
+
+// Active page offset after the last compaction. Writes start another one
+// only after using half the space that was left, so that a page mostly
+// holding live items is not compacted over and over.
+static uint16 nvCompactBase;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -190,6 +299,29 @@ static void   erasePage( uint8 pg );
 static void   cleanErasedPage( uint8 pg );
 static void   findOffset( void );
 static void   compactPage( uint8 pg );
+static void   buildIndex( void );
+static uint8  indexFind( osalSnvId_t id, uint8 *pIdx );
+static void   indexSet( osalSnvId_t id, uint16 offset );
+static uint16 lookupItem( osalSnvId_t id );
+static uint8  writeNV( osalSnvId_t id, osalSnvLen_t len, void *pBuf );
+static uint8  sameItem( uint16 offset, osalSnvLen_t len, void *pBuf );
+
+#if OSAL_SNV_WRITE_BACK
+static uint8  cacheFind( osalSnvId_t id );
+static uint8  cacheWrite( osalSnvId_t id, osalSnvLen_t len, void *pBuf );
+static uint8  cacheFlushEntry( uint8 idx );
+static void   cacheRemove( uint8 idx );
+static void   cacheTimerCB( uint8 *pData );
+#endif
+
+#if OSAL_SNV_INCREMENTAL_COMPACT
+static void   compactStart( void );
+static uint8  compactCopy( uint16 *pSrcOff, uint16 endOff, uint16 budget );
+static void   compactFinish( void );
+static void   compactNow( void );
+static void   compactStop( void );
+static void   compactTimerCB( uint8 *pData );
+#endif
 
 static void   writeWord( uint8 pg, uint16 offset, uint8 *pBuf );
 static void   writeWordM( uint8 pg, uint16 offset, uint8 *pBuf, osalSnvLen_t cnt );
@@ -262,6 +394,8 @@ static uint8 initNV( void )
       // Pick one page as active page.
       setActivePage(OSAL_NV_PAGE_BEG);
       pgOff = OSAL_NV_PAGE_HDR_SIZE;
+      nvIndexCnt = 0;
+      nvIndexAll = TRUE;
 
       // If setting active page from a completely erased page failed,
       // it is not recommended to operate any further.
@@ -290,6 +424,9 @@ static uint8 initNV( void )
 
     // find the active page offset to write a new variable location item
     findOffset();
+
+    // index the items of the active page
+    buildIndex();
   }
 
   return TRUE;
@@ -357,40 +494,19 @@ static void erasePage( uint8 pg )
 
   // Verify the erase operation
   {
+    uint8 erased[16];
     uint16 offset;
-    // Calculate the offset into the containing flash bank as it gets mapped into XDATA.
-    uint8 *ptr = (uint8 *) HAL_FLASH_PAGE_MAP +
-                 ((pg % HAL_FLASH_PAGE_PER_BANK) * HAL_FLASH_PAGE_SIZE);
-    uint8 memctr = MEMCTR;  // Save to restore.
-    
-#if !defined HAL_OAD_BOOT_CODE
-    halIntState_t is;
-#endif
-
-    pg /= HAL_FLASH_PAGE_PER_BANK;  // Calculate the flash bank from the flash page.
-    
-#if !defined HAL_OAD_BOOT_CODE
-    HAL_ENTER_CRITICAL_SECTION(is);
-#endif
-    
-    // Calculate and map the containing flash bank into XDATA.
-    MEMCTR = (MEMCTR & 0xF8) | pg;
 
+    (void)osal_memset(erased, OSAL_NV_ERASED, sizeof(erased));
 
-    for (offset = 0; offset < OSAL_NV_PAGE_SIZE; offset++)
+    for (offset = 0; offset < OSAL_NV_PAGE_SIZE; offset += sizeof(erased))
     {
-      if (*ptr++ != OSAL_NV_ERASED)
+      if (!HalFlashCompare(pg, offset, erased, sizeof(erased)))
       {
         failF = TRUE;
         break;
       }
     }
-
-    MEMCTR = memctr;
-
-#if !defined HAL_OAD_BOOT_CODE
-    HAL_EXIT_CRITICAL_SECTION(is);
-#endif
   }
 }
 
@@ -463,44 +579,13 @@ static void findOffset(void)
  */
 static uint16 findItem(uint8 pg, uint16 offset, osalSnvId_t id)
 {
-  halIntState_t is;
-  
   offset -= OSAL_NV_WORD_SIZE;
 
-  // Calculate the offset into the containing flash bank as it gets mapped into XDATA.
-  uint8 *ptrBase = (uint8 *)(HAL_FLASH_PAGE_MAP) +
-               ((pg % HAL_FLASH_PAGE_PER_BANK) * HAL_FLASH_PAGE_SIZE);
-
-  // Save to restore
-  uint8 memctr;
-
-  pg /= HAL_FLASH_PAGE_PER_BANK;
-  
   while (offset >= OSAL_NV_PAGE_HDR_SIZE)
   {
     osalNvItemHdr_t hdr;
-    uint8 *ptr;
-    uint8 *ptrHdr;
-
-    ptr = ptrBase + offset;
-    ptrHdr = (uint8*) &hdr;
-    
-    HAL_ENTER_CRITICAL_SECTION(is);
-    memctr = MEMCTR;
-    MEMCTR = (memctr & 0xF8) | pg;
-#if (OSAL_NV_WORD_SIZE == 4)
-    *ptrHdr++ = *ptr++;
-    *ptrHdr++ = *ptr++;
-    *ptrHdr++ = *ptr++;
-    *ptrHdr   = *ptr;
-#else
-    for (uint8 i = 0; i < OSAL_NV_WORD_SIZE; ++i)
-    {
-      *ptrHdr++ = *ptr++;
-    }
-#endif
-    MEMCTR = memctr;
-    HAL_EXIT_CRITICAL_SECTION(is);
+
+    HalFlashRead(pg, offset, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
 
     if (hdr.id == id)
     {
@@ -534,6 +619,158 @@ static uint16 findItem(uint8 pg, uint16 offset, osalSnvId_t id)
   return 0;
 }
 
+/*********************************************************************
+ * @fn      buildIndex
+ *
+ * @brief   Fill the RAM index with the latest offset of every valid item
+ *          in the active page.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void buildIndex( void )
+{
+  uint16 offset = pgOff;
+
+  nvIndexCnt = 0;
+  nvIndexAll = TRUE;
+
+  // Walk the items from the latest one down, so the first offset seen
+  // for an ID is its latest value
+  while (offset >= OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_WORD_SIZE)
+  {
+    osalNvItemHdr_t hdr;
+
+    offset -= OSAL_NV_WORD_SIZE;
+    HalFlashRead(activePg, offset, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+
+    if (hdr.len & OSAL_NV_INVALID_LEN_MARK)
+    {
+      // Header only, no data
+      continue;
+    }
+
+    if (hdr.len > offset - OSAL_NV_PAGE_HDR_SIZE)
+    {
+      // active page is corrupt; leave the searching to findItem
+      nvIndexCnt = 0;
+      nvIndexAll = FALSE;
+      return;
+    }
+
+    offset -= hdr.len;
+
+    if (!(hdr.id & OSAL_NV_INVALID_ID_MARK) && !indexFind((osalSnvId_t) hdr.id, NULL))
+    {
+      indexSet((osalSnvId_t) hdr.id, offset);
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      indexFind
+ *
+ * @brief   Binary search of the RAM index.
+ *
+ * @param   id   - NV item ID to search for
+ * @param   pIdx - where to return the position of the ID, or where it
+ *                 would be inserted, or NULL
+ *
+ * @return  TRUE if the ID is in the index, FALSE otherwise
+ */
+static uint8 indexFind( osalSnvId_t id, uint8 *pIdx )
+{
+  uint8 lo = 0;
+  uint8 hi = nvIndexCnt;
+
+  while (lo < hi)
+  {
+    uint8 mid = (lo + hi) / 2;
+
+    if (nvIndex[mid].id < id)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  if (pIdx != NULL)
+  {
+    *pIdx = lo;
+  }
+
+  return ((lo < nvIndexCnt) && (nvIndex[lo].id == id));
+}
+
+/*********************************************************************
+ * @fn      indexSet
+ *
+ * @brief   Record the offset of the latest value of an item in the
+ *          RAM index. If the index is full, the ID is left out and
+ *          lookups of IDs missing from the index search the page.
+ *
+ * @param   id     - NV item ID
+ * @param   offset - offset of the item data in the active page
+ *
+ * @return  none
+ */
+static void indexSet( osalSnvId_t id, uint16 offset )
+{
+  uint8 idx;
+
+  if (!indexFind(id, &idx))
+  {
+    uint8 i;
+
+    if (nvIndexCnt == OSAL_NV_INDEX_SIZE)
+    {
+      nvIndexAll = FALSE;
+      return;
+    }
+
+    // make room for the new ID
+    for (i = nvIndexCnt; i > idx; i--)
+    {
+      nvIndex[i] = nvIndex[i - 1];
+    }
+    nvIndexCnt++;
+    nvIndex[idx].id = id;
+  }
+
+  nvIndex[idx].offset = offset;
+}
+
+/*********************************************************************
+ * @fn      lookupItem
+ *
+ * @brief   find the latest value of an item in the active page, from the
+ *          RAM index if possible
+ *
+ * @param   id - NV item ID to search for
+ *
+ * @return  offset of the item, 0 when not found
+ */
+static uint16 lookupItem( osalSnvId_t id )
+{
+  uint8 idx;
+
+  if (indexFind(id, &idx))
+  {
+    return nvIndex[idx].offset;
+  }
+
+  if (nvIndexAll)
+  {
+    return 0;
+  }
+
+  return findItem(activePg, pgOff, id);
+}
+
 /*********************************************************************
  * @fn      writeItem
  *
@@ -625,6 +862,10 @@ static void compactPage( uint8 srcPg )
 
   dstOff = OSAL_NV_PAGE_HDR_SIZE;
 
+  // The index is rebuilt for the destination page as items are copied
+  nvIndexCnt = 0;
+  nvIndexAll = TRUE;
+
   // Read from the latest value
   srcOff = pgOff - sizeof(osalNvItemHdr_t);
 
@@ -635,6 +876,8 @@ static void compactPage( uint8 srcPg )
     if (failF)
     {
       // Failure during transfer item will make next findItem error prone.
+      nvIndexCnt = 0;
+      nvIndexAll = FALSE;
       return;
     }
 
@@ -670,6 +913,8 @@ static void compactPage( uint8 srcPg )
           //erasePage(srcPg);
 
           HAL_ASSERT_FORCED();
+          nvIndexCnt = 0;
+          nvIndexAll = FALSE;
           return;
         }
       }
@@ -685,13 +930,15 @@ static void compactPage( uint8 srcPg )
       lastId = (osalSnvId_t) hdr.id;
 
       // Check if the latest value of the item was already written
-      if (findItem(dstPg, dstOff, lastId) == 0)
+      if ( !indexFind(lastId, NULL) &&
+           ( nvIndexAll || (findItem(dstPg, dstOff, lastId) == 0) ) )
       {
         // This item was not copied over yet.
         // This must be the latest value.
         // Write the latest value to the destination page
 
         xferItem(dstPg, dstOff, hdr.len, srcOff - hdr.len);
+        indexSet(lastId, dstOff);
 
         dstOff += hdr.len + OSAL_NV_WORD_SIZE;
       }
@@ -707,71 +954,274 @@ static void compactPage( uint8 srcPg )
   {
     pgOff = dstOff; // update active page offset
   }
+  else
+  {
+    // The active page did not change; stop trusting the index
+    nvIndexCnt = 0;
+    nvIndexAll = FALSE;
+  }
 
   // Erase the currently active page
   erasePage(srcPg);
 }
 
+#if OSAL_SNV_INCREMENTAL_COMPACT
 /*********************************************************************
- * @fn      verifyWordM
+ * @fn      compactStart
  *
- * @brief   verify the written word.
+ * @brief   Start compacting the active page in the background, unless
+ *          compaction is already in progress.
  *
- * @param   pg - A valid NV Flash page.
- * @param   offset - A valid offset into the page.
- * @param   pBuf - Pointer to source buffer.
- * @param   cnt - Number of 4-byte blocks to verify.
+ *          The active page keeps taking writes while its items are copied
+ *          to the other page, and only turns to transfer state in the last
+ *          step. Until then a reset just erases the partly filled page.
+ *
+ * @param   none
  *
  * @return  none
  */
-static void verifyWordM( uint8 pg, uint16 offset, uint8 *pBuf, osalSnvLen_t cnt )
+static void compactStart( void )
 {
-  // Calculate the offset into the containing flash bank as it gets mapped into XDATA.
-  uint8 *ptr = (uint8 *)(offset + HAL_FLASH_PAGE_MAP) +
-               ((pg % HAL_FLASH_PAGE_PER_BANK) * HAL_FLASH_PAGE_SIZE);
-  uint8 memctr = MEMCTR;  // Save to restore.
-
-#if !defined HAL_OAD_BOOT_CODE
-  halIntState_t is;
-#endif
+  if ((nvCompactState != OSAL_NV_COMPACT_IDLE) || failF)
+  {
+    return;
+  }
 
-  pg /= HAL_FLASH_PAGE_PER_BANK;  // Calculate the flash bank from the flash page.
+  nvCompactPg = (activePg == OSAL_NV_PAGE_BEG)? OSAL_NV_PAGE_END : OSAL_NV_PAGE_BEG;
+  nvCompactEnd = pgOff;
+  nvCompactSrcOff = pgOff;
+  nvCompactDstOff = OSAL_NV_PAGE_HDR_SIZE;
+  nvCompactState = OSAL_NV_COMPACT_COPY;
 
-#if !defined HAL_OAD_BOOT_CODE
-  HAL_ENTER_CRITICAL_SECTION(is);
-#endif
+  if (nvCompactTimer == INVALID_TIMER_ID)
+  {
+    if (osal_CbTimerStartReload(compactTimerCB, NULL, OSAL_NV_COMPACT_INTERVAL,
+                                &nvCompactTimer) != SUCCESS)
+    {
+      // Compaction completes when a write runs out of space
+      nvCompactTimer = INVALID_TIMER_ID;
+    }
+  }
+}
 
-  // Calculate and map the containing flash bank into XDATA.
-  MEMCTR = (MEMCTR & 0xF8) | pg;
+/*********************************************************************
+ * @fn      compactCopy
+ *
+ * @brief   Copy the latest values of the items of the active page between
+ *          two offsets to nvCompactPg, walking down from the higher one.
+ *          An item is copied only if no newer value of it was written.
+ *
+ * @param   pSrcOff - offset of the end of the items to copy; updated with
+ *                    the offset where copying stopped
+ * @param   endOff  - offset of the start of the items to copy
+ * @param   budget  - number of flash words to read or write before
+ *                    stopping
+ *
+ * @return  FALSE if the active page is corrupt, TRUE otherwise
+ */
+static uint8 compactCopy( uint16 *pSrcOff, uint16 endOff, uint16 budget )
+{
+  uint16 srcOff = *pSrcOff;
 
-  while (cnt--)
+  while ((srcOff >= endOff + OSAL_NV_WORD_SIZE) && (budget > 0) && !failF)
   {
-#if (OSAL_NV_WORD_SIZE == 4)
-    if ((ptr[0] != pBuf[0]) ||
-        (ptr[1] != pBuf[1]) ||
-        (ptr[2] != pBuf[2]) ||
-        (ptr[3] != pBuf[3]))
+    osalNvItemHdr_t hdr;
+
+    srcOff -= OSAL_NV_WORD_SIZE;
+    HalFlashRead(activePg, srcOff, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+    budget--;
+
+    if (hdr.len & OSAL_NV_INVALID_LEN_MARK)
     {
-      failF = TRUE;
-      break;
+      // Header only, no data
+      continue;
     }
-#else
-    if (FALSE == osal_memcmp(ptr, pBuf, OSAL_NV_WORD_SIZE))
+
+    if (hdr.len > srcOff - endOff)
     {
-      failF = TRUE;
-      break;
+      HAL_ASSERT_FORCED();
+      *pSrcOff = srcOff;
+      return FALSE;
     }
-#endif
 
-    ptr += OSAL_NV_WORD_SIZE;
-    pBuf += OSAL_NV_WORD_SIZE;
+    srcOff -= hdr.len;
+
+    if (!(hdr.id & OSAL_NV_INVALID_ID_MARK) &&
+        (lookupItem((osalSnvId_t) hdr.id) == srcOff))
+    {
+      xferItem(nvCompactPg, nvCompactDstOff, hdr.len, srcOff);
+      nvCompactDstOff += hdr.len + OSAL_NV_WORD_SIZE;
+
+      budget = (budget > hdr.len / OSAL_NV_WORD_SIZE)? budget - hdr.len / OSAL_NV_WORD_SIZE : 0;
+    }
+  }
+
+  *pSrcOff = srcOff;
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * @fn      compactFinish
+ *
+ * @brief   Copy what is left of the active page, including the items
+ *          written since compaction started, and activate the new page.
+ *          The old page is erased by the next step.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void compactFinish( void )
+{
+  uint16 tailOff = pgOff;
+  uint8 srcPg = activePg;
+
+  if (!compactCopy(&nvCompactSrcOff, OSAL_NV_PAGE_HDR_SIZE, 0xFFFF))
+  {
+    compactStop();
+    return;
   }
 
-  MEMCTR = memctr;
+  // From here on a reset completes compaction from the old page
+  setXferPage();
 
-#if !defined HAL_OAD_BOOT_CODE
-  HAL_EXIT_CRITICAL_SECTION(is);
+  if (!compactCopy(&tailOff, nvCompactEnd, 0xFFFF) || failF)
+  {
+    compactStop();
+    return;
+  }
+
+  setActivePage(nvCompactPg);
+
+  if (failF)
+  {
+    // The active page did not change; stop trusting the index
+    nvIndexCnt = 0;
+    nvIndexAll = FALSE;
+    compactStop();
+    return;
+  }
+
+  pgOff = nvCompactDstOff;
+  nvCompactBase = pgOff;
+  buildIndex();
+
+  nvCompactPg = srcPg;
+  nvCompactState = OSAL_NV_COMPACT_ERASE;
+}
+
+/*********************************************************************
+ * @fn      compactNow
+ *
+ * @brief   Complete compaction of the active page before returning, for
+ *          a write which does not fit in it.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void compactNow( void )
+{
+  if (nvCompactState == OSAL_NV_COMPACT_ERASE)
+  {
+    // The page to copy to is still to be erased
+    erasePage(nvCompactPg);
+    nvCompactState = OSAL_NV_COMPACT_IDLE;
+  }
+
+  compactStart();
+
+  if (nvCompactState == OSAL_NV_COMPACT_COPY)
+  {
+    compactFinish();
+  }
+}
+
+/*********************************************************************
+ * @fn      compactStop
+ *
+ * @brief   Return to the idle compaction state and stop the step timer.
+ *          A page left partly filled is erased.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void compactStop( void )
+{
+  if (nvCompactState == OSAL_NV_COMPACT_COPY)
+  {
+    cleanErasedPage(nvCompactPg);
+  }
+
+  nvCompactState = OSAL_NV_COMPACT_IDLE;
+
+  if (nvCompactTimer != INVALID_TIMER_ID)
+  {
+    osal_CbTimerStop(nvCompactTimer);
+    nvCompactTimer = INVALID_TIMER_ID;
+  }
+}
+
+/*********************************************************************
+ * @fn      compactTimerCB
+ *
+ * @brief   Run one compaction step.
+ *
+ * @param   pData - unused
+ *
+ * @return  none
+ */
+static void compactTimerCB( uint8 *pData )
+{
+  (void)pData;
+
+  if (failF)
+  {
+    compactStop();
+  }
+  else if (nvCompactState == OSAL_NV_COMPACT_COPY)
+  {
+    if (!compactCopy(&nvCompactSrcOff, OSAL_NV_PAGE_HDR_SIZE, OSAL_NV_COMPACT_STEP))
+    {
+      compactStop();
+    }
+    else if (nvCompactSrcOff < OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_WORD_SIZE)
+    {
+      compactFinish();
+    }
+  }
+  else
+  {
+    if (nvCompactState == OSAL_NV_COMPACT_ERASE)
+    {
+      erasePage(nvCompactPg);
+    }
+
+    compactStop();
+  }
+}
 #endif
+
+/*********************************************************************
+ * @fn      verifyWordM
+ *
+ * @brief   verify the written word.
+ *
+ * @param   pg - A valid NV Flash page.
+ * @param   offset - A valid offset into the page.
+ * @param   pBuf - Pointer to source buffer.
+ * @param   cnt - Number of 4-byte blocks to verify.
+ *
+ * @return  none
+ */
+static void verifyWordM( uint8 pg, uint16 offset, uint8 *pBuf, osalSnvLen_t cnt )
+{
+  if (!HalFlashCompare(pg, offset, pBuf, cnt * OSAL_NV_WORD_SIZE))
+  {
+    failF = TRUE;
+  }
 }
 
 /*********************************************************************
@@ -828,6 +1278,22 @@ static void writeWordM( uint8 pg, uint16 offset, uint8 *buf, osalSnvLen_t cnt )
  */
 uint8 osal_snv_init( void )
 {
+#if OSAL_SNV_WRITE_BACK
+  // Anything cached was lost with the RAM
+  nvCacheCnt = 0;
+  if (nvCacheTimer != INVALID_TIMER_ID)
+  {
+    osal_CbTimerStop(nvCacheTimer);
+    nvCacheTimer = INVALID_TIMER_ID;
+  }
+#endif
+
+#if OSAL_SNV_INCREMENTAL_COMPACT
+  // initNV() cleans up after a compaction in progress
+  nvCompactState = OSAL_NV_COMPACT_IDLE;
+  compactStop();
+#endif
+
   if (!initNV())
   {
     // NV initialization failed
@@ -836,6 +1302,10 @@ uint8 osal_snv_init( void )
     return FAILURE;
   }
 
+#if OSAL_SNV_INCREMENTAL_COMPACT
+  nvCompactBase = pgOff;
+#endif
+
   return SUCCESS;
 }
 
@@ -852,32 +1322,50 @@ uint8 osal_snv_init( void )
  */
 uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
 {
-  uint16 alignedLen;
-
+#if OSAL_SNV_WRITE_BACK
+  if (len <= OSAL_NV_CACHE_ITEM_LEN)
+  {
+    return cacheWrite(id, len, pBuf);
+  }
+  else
   {
-    uint16 offset = findItem(activePg, pgOff, id);
+    // The value written through supersedes a cached one
+    uint8 idx = cacheFind(id);
 
-    if (offset > 0)
+    if (idx < nvCacheCnt)
     {
-      uint8 tmp;
-      osalSnvLen_t i;
+      cacheRemove(idx);
+    }
+  }
+#endif
 
-      for (i = 0; i < len; i++)
-      {
-        HalFlashRead(activePg, offset, &tmp, 1);
-        if (tmp != ((uint8 *)pBuf)[i])
-        {
-          break;
-        }
-        offset++;
-      }
+  return writeNV(id, len, pBuf);
+}
 
-      if (i == len)
-      {
-        // Changed value is the same value as before.
-        // Return here instead of re-writing the same value to NV.
-        return SUCCESS;
-      }
+/*********************************************************************
+ * @fn      writeNV
+ *
+ * @brief   Write a data item to the active page, unless it already holds
+ *          the same value.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   len - Length of data to write.
+ * @param   *pBuf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+static uint8 writeNV( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
+{
+  uint16 alignedLen;
+
+  {
+    uint16 offset = lookupItem(id);
+
+    if ((offset > 0) && sameItem(offset, len, pBuf))
+    {
+      // Changed value is the same value as before.
+      // Return here instead of re-writing the same value to NV.
+      return SUCCESS;
     }
   }
 
@@ -885,8 +1373,12 @@ uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
 
   if ( pgOff + alignedLen + OSAL_NV_WORD_SIZE > OSAL_NV_PAGE_SIZE )
   {
+#if OSAL_SNV_INCREMENTAL_COMPACT
+    compactNow();
+#else
     setXferPage();
     compactPage(activePg);
+#endif
   }
 
   // pBuf shall be referenced beyond its valid length to save code size.
@@ -896,11 +1388,36 @@ uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
     return NV_OPER_FAILED;
   }
 
+  indexSet(id, pgOff);
   pgOff += alignedLen + OSAL_NV_WORD_SIZE;
 
+#if OSAL_SNV_INCREMENTAL_COMPACT
+  if ( ( ( (uint32)pgOff * 100 ) >= ( OSAL_NV_PAGE_SIZE * (uint32)OSAL_NV_COMPACT_START ) ) &&
+       ( (pgOff - nvCompactBase) * 2 >= OSAL_NV_PAGE_SIZE - nvCompactBase ) )
+  {
+    compactStart();
+  }
+#endif
+
   return SUCCESS;
 }
 
+/*********************************************************************
+ * @fn      sameItem
+ *
+ * @brief   Compare a data item in the active page with a buffer.
+ *
+ * @param   offset - offset of the item data in the active page
+ * @param   len - number of bytes to compare
+ * @param   *pBuf - data to compare with
+ *
+ * @return  TRUE if the item starts with the same len bytes, FALSE otherwise.
+ */
+static uint8 sameItem( uint16 offset, osalSnvLen_t len, void *pBuf )
+{
+  return HalFlashCompare(activePg, offset, (uint8 *)pBuf, len);
+}
+
 /*********************************************************************
  * @fn      osal_snv_read
  *
@@ -915,7 +1432,30 @@ uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
  */
 uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
 {
-  uint16 offset = findItem(activePg, pgOff, id);
+  uint16 offset;
+
+#if OSAL_SNV_WRITE_BACK
+  {
+    uint8 idx = cacheFind(id);
+
+    if (idx < nvCacheCnt)
+    {
+      if (len <= nvCache[idx].len)
+      {
+        (void)osal_memcpy(pBuf, nvCache[idx].buf, len);
+        return SUCCESS;
+      }
+
+      // Read past the cached value from flash, like the original read
+      if (cacheFlushEntry(idx) != SUCCESS)
+      {
+        return NV_OPER_FAILED;
+      }
+    }
+  }
+#endif
+
+  offset = lookupItem(id);
 
   if (offset != 0)
   {
@@ -929,6 +1469,8 @@ uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
  * @fn      osal_snv_compact
  *
  * @brief   Compacts NV if its usage has reached a specific threshold.
+ *          With OSAL_SNV_INCREMENTAL_COMPACT, compaction is started in
+ *          the background instead.
  *
  * @param   threshold - compaction threshold
  *
@@ -947,8 +1489,12 @@ uint8 osal_snv_compact( uint8 threshold )
   // See if NV active page usage has reached compaction threshold
   if ( ( (uint32)pgOff * 100 ) >= ( OSAL_NV_PAGE_SIZE * (uint32)threshold ) )
   {
+#if OSAL_SNV_INCREMENTAL_COMPACT
+    compactStart();
+#else
     setXferPage();
     compactPage(activePg);
+#endif
 
     return SUCCESS;
   }
@@ -956,5 +1502,193 @@ uint8 osal_snv_compact( uint8 threshold )
   return NV_OPER_FAILED;
 }
 
+/*********************************************************************
+ * @fn      osal_snv_flush
+ *
+ * @brief   Write the items held in the write-back cache to flash. Call
+ *          before powering down or resetting the device on purpose.
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+uint8 osal_snv_flush( void )
+{
+#if OSAL_SNV_WRITE_BACK
+  while (nvCacheCnt > 0)
+  {
+    if (cacheFlushEntry(0) != SUCCESS)
+    {
+      return NV_OPER_FAILED;
+    }
+  }
+#endif
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_erase_count
+ *
+ * @brief   Read the number of times an NV page was erased. This
+ *          implementation doesn't count erases.
+ *
+ * @param   idx - NV page index, below HAL_NV_PAGE_CNT
+ *
+ * @return  0
+ */
+uint32 osal_snv_erase_count( uint8 idx )
+{
+  (void)idx;
+
+  return 0;
+}
+
+#if OSAL_SNV_WRITE_BACK
+/*********************************************************************
+ * @fn      cacheFind
+ *
+ * @brief   Find an item in the write-back cache.
+ *
+ * @param   id - NV item ID to search for
+ *
+ * @return  index of the item, nvCacheCnt when not found
+ */
+static uint8 cacheFind( osalSnvId_t id )
+{
+  uint8 idx;
+
+  for (idx = 0; idx < nvCacheCnt; idx++)
+  {
+    if (nvCache[idx].id == id)
+    {
+      break;
+    }
+  }
+
+  return idx;
+}
+
+/*********************************************************************
+ * @fn      cacheWrite
+ *
+ * @brief   Write a data item to the write-back cache. A rewrite of a
+ *          cached item replaces its value; a new item makes room by
+ *          writing the oldest item to flash if the cache is full.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   len - Length of data to write, at most OSAL_NV_CACHE_ITEM_LEN.
+ * @param   *pBuf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+static uint8 cacheWrite( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
+{
+  uint8 idx = cacheFind(id);
+
+  if (idx == nvCacheCnt)
+  {
+    uint16 offset = lookupItem(id);
+
+    // Same value as in flash; nothing to write
+    if ((offset > 0) && sameItem(offset, len, pBuf))
+    {
+      return SUCCESS;
+    }
+
+    if (nvCacheCnt == OSAL_NV_CACHE_CNT)
+    {
+      if (cacheFlushEntry(0) != SUCCESS)
+      {
+        return NV_OPER_FAILED;
+      }
+    }
+
+    if (nvCacheTimer == INVALID_TIMER_ID)
+    {
+      if (osal_CbTimerStart(cacheTimerCB, NULL, OSAL_NV_CACHE_DELAY, &nvCacheTimer) != SUCCESS)
+      {
+        // Nothing to flush the cache later; write through
+        nvCacheTimer = INVALID_TIMER_ID;
+        return writeNV(id, len, pBuf);
+      }
+    }
+
+    idx = nvCacheCnt++;
+    nvCache[idx].id = id;
+  }
+
+  nvCache[idx].len = len;
+  (void)osal_memcpy(nvCache[idx].buf, pBuf, len);
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      cacheFlushEntry
+ *
+ * @brief   Write an item of the write-back cache to flash and remove it
+ *          from the cache.
+ *
+ * @param   idx - index of the item in the cache
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+static uint8 cacheFlushEntry( uint8 idx )
+{
+  if (writeNV(nvCache[idx].id, nvCache[idx].len, nvCache[idx].buf) != SUCCESS)
+  {
+    return NV_OPER_FAILED;
+  }
+
+  cacheRemove(idx);
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      cacheRemove
+ *
+ * @brief   Remove an item from the write-back cache, and stop the flush
+ *          timer when the cache becomes empty.
+ *
+ * @param   idx - index of the item in the cache
+ *
+ * @return  none
+ */
+static void cacheRemove( uint8 idx )
+{
+  nvCacheCnt--;
+
+  for (; idx < nvCacheCnt; idx++)
+  {
+    nvCache[idx] = nvCache[idx + 1];
+  }
+
+  if ((nvCacheCnt == 0) && (nvCacheTimer != INVALID_TIMER_ID))
+  {
+    osal_CbTimerStop(nvCacheTimer);
+    nvCacheTimer = INVALID_TIMER_ID;
+  }
+}
+
+/*********************************************************************
+ * @fn      cacheTimerCB
+ *
+ * @brief   Flush timer callback.
+ *
+ * @param   pData - unused
+ *
+ * @return  none
+ */
+static void cacheTimerCB( uint8 *pData )
+{
+  (void)pData;
+
+  // The timer has expired and is released after this callback
+  nvCacheTimer = INVALID_TIMER_ID;
+
+  (void)osal_snv_flush();
+}
+#endif
+
 /*********************************************************************
 *********************************************************************/
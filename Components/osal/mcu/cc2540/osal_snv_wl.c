@@ -0,0 +1,1188 @@
+/******************************************************************************
+
+ @file  osal_snv_wl.c
+
+ @brief This module contains the OSAL simple non-volatile memory functions
+        for N flash pages used as a wear-leveled log, with 16-bit item IDs.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2009-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+
+/*
+ * Build this file instead of osal_snv.c to spread NV over more than two
+ * flash pages. Define OSAL_SNV_UINT16_ID for 16-bit item IDs and lengths,
+ * and set HAL_NV_PAGE_CNT to the number of pages, which the linker .xcl
+ * file must reserve as well.
+ *
+ * The pages form a circular log. Items are appended to the head page and
+ * when it is full the next page in physical order becomes the head. One
+ * page is always kept erased. When it is the only one left, the oldest page
+ * (the tail) is reclaimed: the items it holds the latest value of are
+ * appended to the head, and the tail is erased. The pages are thus erased
+ * in turn, each as often as the others.
+ *
+ * A page starts with three flash words: its sequence number in the log,
+ * left erased while the page is free, its erase count, written right after
+ * the page is erased, and a retire mark, cleared before the page is erased.
+ * Items have the same layout as in osal_snv.c: the data padded to a flash
+ * word, followed by a 16-bit ID and a 16-bit length. The top bit of both is
+ * used to mark partly written items, so IDs range from 0x0000 to 0x7FFF.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "hal_adc.h"
+#include "hal_flash.h"
+#include "hal_types.h"
+#include "comdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+#include "hal_assert.h"
+#include "saddr.h"
+
+#if OSAL_SNV_WRITE_BACK || OSAL_SNV_INCREMENTAL_COMPACT
+# error "This OSAL SNV implementation supports neither the write-back cache nor incremental compaction"
+#endif
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// NV page configuration
+#define OSAL_NV_PAGE_SIZE       HAL_FLASH_PAGE_SIZE
+#define OSAL_NV_PAGES_USED      HAL_NV_PAGE_CNT
+#define OSAL_NV_PAGE_BEG        HAL_NV_PAGE_BEG
+
+#if (OSAL_NV_PAGES_USED < 2) || (OSAL_NV_PAGES_USED > 16)
+# error "HAL_NV_PAGE_CNT must be between 2 and 16"
+#endif
+
+// Default byte value when flash is erased
+#define OSAL_NV_ERASED          0xFF
+
+// Value of an erased flash word
+#define OSAL_NV_ERASED_WORD     0xFFFFFFFF
+
+// Length in bytes of a flash word
+#define OSAL_NV_WORD_SIZE       HAL_FLASH_WORD_SIZE
+
+// Page header fields, one flash word each
+#define OSAL_NV_PAGE_SEQ_OFFSET     0
+#define OSAL_NV_PAGE_ERASES_OFFSET  (OSAL_NV_WORD_SIZE)
+#define OSAL_NV_PAGE_RETIRE_OFFSET  (OSAL_NV_WORD_SIZE * 2)
+
+// NV page header size in bytes
+#define OSAL_NV_PAGE_HDR_SIZE   (OSAL_NV_WORD_SIZE * 3)
+
+// Longest item that fits in a page
+#define OSAL_NV_MAX_ITEM_LEN    (OSAL_NV_PAGE_SIZE - OSAL_NV_PAGE_HDR_SIZE - OSAL_NV_WORD_SIZE)
+
+// Page index of no page
+#define OSAL_NV_PAGE_NONE       OSAL_NV_PAGES_USED
+
+// Flag in a length field of an item header to indicate validity
+// of the length field
+#define OSAL_NV_INVALID_LEN_MARK 0x8000
+
+// Flag in an ID field of an item header to indicate validity of
+// the identifier field
+#define OSAL_NV_INVALID_ID_MARK  0x8000
+
+#define OSAL_NV_MIN_COMPACT_THRESHOLD   70 // Minimum compaction threshold
+#define OSAL_NV_MAX_COMPACT_THRESHOLD   95 // Maximum compaction threshold
+
+// Number of item IDs held by the RAM index. IDs beyond that are still
+// found by searching the pages.
+#if !defined OSAL_NV_INDEX_SIZE
+#define OSAL_NV_INDEX_SIZE      32
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Flash page number of a page index
+#define OSAL_NV_PG( idx )       ((uint8)(OSAL_NV_PAGE_BEG + (idx)))
+
+// Macro to check supply voltage
+#if (defined HAL_MCU_CC2530 || defined HAL_MCU_CC2531)
+# define  OSAL_NV_CHECK_BUS_VOLTAGE  (HalAdcCheckVdd(VDD_MIN_FLASH))
+#elif defined HAL_MCU_CC2533
+# define  OSAL_NV_CHECK_BUS_VOLTAGE  (HalBatMonRead( HAL_BATMON_MIN_FLASH ))
+#else
+// The radio chip does not support voltage monitoring
+# define  OSAL_NV_CHECK_BUS_VOLTAGE TRUE
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// NV item header structure
+typedef struct
+{
+  uint16 id;
+  uint16 len;
+} osalNvItemHdr_t;
+
+// RAM index entry: location of the latest value of an item
+typedef struct
+{
+  uint16 id;
+  uint8  pg;      // page index
+  uint16 offset;
+} osalNvIndex_t;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+extern bool HalAdcCheckVdd(uint8 limit);
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+#ifndef OAD_KEEP_NV_PAGES
+// When NV pages are to remain intact during OAD download,
+// the image itself should not include NV pages.
+#pragma location="BLENV_ADDRESS_SPACE"
+__no_init uint8 _nvBuf[OSAL_NV_PAGES_USED * OSAL_NV_PAGE_SIZE];
+#pragma required=_nvBuf
+#endif // OAD_KEEP_NV_PAGES
+
+#if defined MAKE_CRC_SHDW
+#pragma location="CRC_SHDW"
+const CODE uint16 _crcShdw = 0xFFFF;
+#pragma required=_crcShdw
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Sequence number of each page in the log, OSAL_NV_ERASED_WORD if free
+static uint32 nvSeq[OSAL_NV_PAGES_USED];
+
+// Erase count of each page
+static uint32 nvErases[OSAL_NV_PAGES_USED];
+
+// Offset past the last item of each page
+static uint16 nvEnd[OSAL_NV_PAGES_USED];
+
+// Page taking new items, and number of free pages
+static uint8 nvHead;
+static uint8 nvFree;
+
+// flag to indicate that reclaiming every page in use freed no space, so
+// that only a successful write can make room again.
+static uint8 nvFull;
+
+// flag to indicate that an error has occurred while writing to or erasing the
+// flash device. Once this flag indicates failure, it is unsafe to attempt
+// another write or erase.
+static uint8 failF;
+
+// Item locations, sorted by ID
+static osalNvIndex_t nvIndex[OSAL_NV_INDEX_SIZE];
+static uint8 nvIndexCnt;
+
+// flag to indicate that every valid item is in nvIndex, so that an ID
+// missing from it does not exist.
+static uint8 nvIndexAll;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint8  initNV( void );
+
+static uint8  pageErased( uint8 idx );
+static void   erasePage( uint8 idx );
+static void   findOffset( uint8 idx );
+static uint8  prevPage( uint8 idx );
+static uint8  oldestPage( void );
+static void   openHead( void );
+static uint8  reclaimPage( uint16 *pGain );
+static uint8  makeRoom( uint16 size );
+static uint16 findItem( uint8 idx, osalSnvId_t id );
+static void   buildIndex( void );
+static uint8  indexFind( osalSnvId_t id, uint8 *pIdx );
+static void   indexSet( osalSnvId_t id, uint8 pg, uint16 offset );
+static uint16 lookupItem( osalSnvId_t id, uint8 *pPg );
+
+static void   writeItem( uint8 idx, uint16 offset, osalSnvId_t id, uint16 alignedLen, uint8 *pBuf );
+static void   xferItem( uint8 srcIdx, uint16 srcOff, uint16 alignedLen );
+static void   writeWord( uint8 idx, uint16 offset, uint8 *pBuf );
+static void   writeWordM( uint8 idx, uint16 offset, uint8 *pBuf, uint16 cnt );
+
+/*********************************************************************
+ * @fn      initNV
+ *
+ * @brief   Initialize the NV flash pages.
+ *
+ * @param   none
+ *
+ * @return  TRUE if initialization succeeds. FALSE, otherwise.
+ */
+static uint8 initNV( void )
+{
+  uint32 hdr[OSAL_NV_PAGE_HDR_SIZE / OSAL_NV_WORD_SIZE];
+  uint32 maxErases = 0;
+  uint16 eraseMask = 0;
+  uint8 idx;
+
+  failF = FALSE;
+  nvFull = FALSE;
+  nvHead = OSAL_NV_PAGE_NONE;
+  nvFree = 0;
+
+  for (idx = 0; idx < OSAL_NV_PAGES_USED; idx++)
+  {
+    HalFlashRead(OSAL_NV_PG(idx), OSAL_NV_PAGE_SEQ_OFFSET, (uint8 *)hdr, OSAL_NV_PAGE_HDR_SIZE);
+
+    nvErases[idx] = hdr[OSAL_NV_PAGE_ERASES_OFFSET / OSAL_NV_WORD_SIZE];
+    if ((nvErases[idx] != OSAL_NV_ERASED_WORD) && (nvErases[idx] > maxErases))
+    {
+      maxErases = nvErases[idx];
+    }
+
+    if ((hdr[OSAL_NV_PAGE_RETIRE_OFFSET / OSAL_NV_WORD_SIZE] != OSAL_NV_ERASED_WORD) ||
+        ((hdr[OSAL_NV_PAGE_SEQ_OFFSET] == OSAL_NV_ERASED_WORD) && !pageErased(idx)))
+    {
+      // Reclaiming the page was interrupted, or erasing it was.
+      // Its latest items were copied to the head first.
+      eraseMask |= (uint16)1 << idx;
+      nvSeq[idx] = OSAL_NV_ERASED_WORD;
+    }
+    else
+    {
+      nvSeq[idx] = hdr[OSAL_NV_PAGE_SEQ_OFFSET];
+    }
+
+    if (nvSeq[idx] == OSAL_NV_ERASED_WORD)
+    {
+      nvFree++;
+    }
+    else
+    {
+      findOffset(idx);
+
+      if ((nvHead == OSAL_NV_PAGE_NONE) || (nvSeq[idx] > nvSeq[nvHead]))
+      {
+        nvHead = idx;
+      }
+    }
+  }
+
+  // A page whose count was lost, by a reset right after erasing it,
+  // counts as worn as the most worn page.
+  for (idx = 0; idx < OSAL_NV_PAGES_USED; idx++)
+  {
+    if (nvErases[idx] == OSAL_NV_ERASED_WORD)
+    {
+      nvErases[idx] = maxErases;
+    }
+
+    if (eraseMask & ((uint16)1 << idx))
+    {
+      erasePage(idx);
+    }
+  }
+
+  if (nvHead == OSAL_NV_PAGE_NONE)
+  {
+    // All pages are free. This must be initial state.
+    openHead();
+  }
+
+  buildIndex();
+
+  if (nvFree == 0)
+  {
+    uint16 gain;
+
+    // Reset while reclaiming the tail, after opening the last free page
+    (void)reclaimPage(&gain);
+  }
+
+  return (!failF);
+}
+
+/*********************************************************************
+ * @fn      pageErased
+ *
+ * @brief   Check that a free page is erased, except for its erase count.
+ *
+ * @param   idx - Valid NV page index.
+ *
+ * @return  TRUE if the page is erased, FALSE otherwise.
+ */
+static uint8 pageErased( uint8 idx )
+{
+  uint8 buf[16];
+  uint16 offset;
+  uint8 i;
+
+  for (offset = 0; offset < OSAL_NV_PAGE_SIZE; offset += sizeof(buf))
+  {
+    HalFlashRead(OSAL_NV_PG(idx), offset, buf, sizeof(buf));
+
+    for (i = 0; i < sizeof(buf); i++)
+    {
+      if ((buf[i] != OSAL_NV_ERASED) &&
+          ((offset + i < OSAL_NV_PAGE_ERASES_OFFSET) ||
+           (offset + i >= OSAL_NV_PAGE_ERASES_OFFSET + OSAL_NV_WORD_SIZE)))
+      {
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * @fn      erasePage
+ *
+ * @brief   Erases a page in Flash and writes its new erase count.
+ *
+ * @param   idx - Valid NV page index.
+ *
+ * @return  none
+ */
+static void erasePage( uint8 idx )
+{
+  if ( !OSAL_NV_CHECK_BUS_VOLTAGE || failF)
+  {
+    failF = TRUE;
+    return;
+  }
+
+  HalFlashErase(OSAL_NV_PG(idx));
+
+  nvErases[idx]++;
+
+  if (!pageErased(idx))
+  {
+    failF = TRUE;
+    return;
+  }
+
+  writeWord(idx, OSAL_NV_PAGE_ERASES_OFFSET, (uint8 *)&nvErases[idx]);
+}
+
+/*********************************************************************
+ * @fn      findOffset
+ *
+ * @brief   find the offset past the last item of a page in use.
+ *
+ * @param   idx - Valid NV page index.
+ *
+ * @return  none
+ */
+static void findOffset( uint8 idx )
+{
+  uint16 offset;
+
+  for (offset = OSAL_NV_PAGE_SIZE - OSAL_NV_WORD_SIZE;
+       offset >= OSAL_NV_PAGE_HDR_SIZE;
+       offset -= OSAL_NV_WORD_SIZE)
+  {
+    uint32 tmp;
+
+    HalFlashRead(OSAL_NV_PG(idx), offset, (uint8 *)&tmp, OSAL_NV_WORD_SIZE);
+    if (tmp != OSAL_NV_ERASED_WORD)
+    {
+      break;
+    }
+  }
+  nvEnd[idx] = offset + OSAL_NV_WORD_SIZE;
+}
+
+/*********************************************************************
+ * @fn      prevPage
+ *
+ * @brief   Find the page preceding a page in the log.
+ *
+ * @param   idx - Page index of a page in use.
+ *
+ * @return  page index, OSAL_NV_PAGE_NONE for the oldest page
+ */
+static uint8 prevPage( uint8 idx )
+{
+  uint8 prev = OSAL_NV_PAGE_NONE;
+  uint8 i;
+
+  for (i = 0; i < OSAL_NV_PAGES_USED; i++)
+  {
+    if ((nvSeq[i] != OSAL_NV_ERASED_WORD) && (nvSeq[i] < nvSeq[idx]) &&
+        ((prev == OSAL_NV_PAGE_NONE) || (nvSeq[i] > nvSeq[prev])))
+    {
+      prev = i;
+    }
+  }
+
+  return prev;
+}
+
+/*********************************************************************
+ * @fn      oldestPage
+ *
+ * @brief   Find the tail of the log.
+ *
+ * @param   none
+ *
+ * @return  page index of the oldest page in use
+ */
+static uint8 oldestPage( void )
+{
+  uint8 tail = nvHead;
+  uint8 prev;
+
+  while ((prev = prevPage(tail)) != OSAL_NV_PAGE_NONE)
+  {
+    tail = prev;
+  }
+
+  return tail;
+}
+
+/*********************************************************************
+ * @fn      openHead
+ *
+ * @brief   Make the next free page in physical order the head of the log.
+ *          At least one page must be free.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void openHead( void )
+{
+  uint32 seq = 1;
+  uint8 idx = 0;
+
+  if (nvHead != OSAL_NV_PAGE_NONE)
+  {
+    seq = nvSeq[nvHead] + 1;
+    idx = (nvHead + 1) % OSAL_NV_PAGES_USED;
+  }
+
+  while (nvSeq[idx] != OSAL_NV_ERASED_WORD)
+  {
+    idx = (idx + 1) % OSAL_NV_PAGES_USED;
+  }
+
+  writeWord(idx, OSAL_NV_PAGE_SEQ_OFFSET, (uint8 *)&seq);
+  if (!failF)
+  {
+    nvSeq[idx] = seq;
+    nvEnd[idx] = OSAL_NV_PAGE_HDR_SIZE;
+    nvHead = idx;
+    nvFree--;
+  }
+}
+
+/*********************************************************************
+ * @fn      reclaimPage
+ *
+ * @brief   Copy the latest values held by the tail of the log to the head,
+ *          opening a new head if they might not fit, and erase the tail.
+ *
+ * @param   pGain - where to return the number of bytes of the tail which
+ *                  were not copied
+ *
+ * @return  TRUE if a page was freed, FALSE otherwise.
+ */
+static uint8 reclaimPage( uint16 *pGain )
+{
+  uint8 tail = oldestPage();
+  uint16 offset;
+  uint32 retire = 0;
+
+  *pGain = nvEnd[tail] - OSAL_NV_PAGE_HDR_SIZE;
+
+  if ((tail == nvHead) ||
+      (nvEnd[nvHead] + (nvEnd[tail] - OSAL_NV_PAGE_HDR_SIZE) > OSAL_NV_PAGE_SIZE))
+  {
+    if (nvFree > 0)
+    {
+      openHead();
+    }
+    else if (tail == nvHead)
+    {
+      return FALSE;
+    }
+    // else a reset interrupted the copy into the head, where what is left
+    // to copy still fits
+  }
+
+  offset = nvEnd[tail];
+
+  while ((offset >= OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_WORD_SIZE) && !failF)
+  {
+    osalNvItemHdr_t hdr;
+
+    offset -= OSAL_NV_WORD_SIZE;
+    HalFlashRead(OSAL_NV_PG(tail), offset, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+
+    if (hdr.len & OSAL_NV_INVALID_LEN_MARK)
+    {
+      // Header only, no data
+      continue;
+    }
+
+    if (hdr.len > offset - OSAL_NV_PAGE_HDR_SIZE)
+    {
+      // tail page is corrupt; keep it
+      HAL_ASSERT_FORCED();
+      return FALSE;
+    }
+
+    offset -= hdr.len;
+
+    if (!(hdr.id & OSAL_NV_INVALID_ID_MARK))
+    {
+      uint8 pg;
+
+      if ((lookupItem((osalSnvId_t) hdr.id, &pg) == offset) && (pg == tail))
+      {
+        if (nvEnd[nvHead] + hdr.len + OSAL_NV_WORD_SIZE > OSAL_NV_PAGE_SIZE)
+        {
+          return FALSE;
+        }
+
+        indexSet((osalSnvId_t) hdr.id, nvHead, nvEnd[nvHead]);
+        xferItem(tail, offset, hdr.len);
+        *pGain -= hdr.len + OSAL_NV_WORD_SIZE;
+      }
+    }
+  }
+
+  // From here on a reset finishes the erase
+  writeWord(tail, OSAL_NV_PAGE_RETIRE_OFFSET, (uint8 *)&retire);
+  erasePage(tail);
+
+  if (failF)
+  {
+    // Stop trusting the index
+    nvIndexCnt = 0;
+    nvIndexAll = FALSE;
+    return FALSE;
+  }
+
+  nvSeq[tail] = OSAL_NV_ERASED_WORD;
+  nvFree++;
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * @fn      makeRoom
+ *
+ * @brief   Make room for an item at the head of the log, opening pages
+ *          and reclaiming the oldest ones as needed.
+ *
+ * @param   size - size of the item including its header
+ *
+ * @return  TRUE if the item fits, FALSE if NV is full or failed.
+ */
+static uint8 makeRoom( uint16 size )
+{
+  uint8 idle = 0;
+
+  while (!failF)
+  {
+    uint16 gain;
+
+    if (nvEnd[nvHead] + size <= OSAL_NV_PAGE_SIZE)
+    {
+      return TRUE;
+    }
+
+    if (nvFree >= 2)
+    {
+      openHead();
+    }
+    else if (nvFull || !reclaimPage(&gain))
+    {
+      break;
+    }
+    else if (gain > 0)
+    {
+      idle = 0;
+    }
+    else if (++idle >= OSAL_NV_PAGES_USED - nvFree)
+    {
+      // A whole turn of the log freed nothing
+      nvFull = TRUE;
+      break;
+    }
+  }
+
+  return FALSE;
+}
+
+/*********************************************************************
+ * @fn      findItem
+ *
+ * @brief   find the latest value of an item in a page
+ *
+ * @param   idx - Page index of a page in use
+ * @param   id  - NV item ID to search for
+ *
+ * @return  offset of the item, 0 when not found
+ */
+static uint16 findItem( uint8 idx, osalSnvId_t id )
+{
+  uint16 offset = nvEnd[idx];
+
+  while (offset >= OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_WORD_SIZE)
+  {
+    osalNvItemHdr_t hdr;
+
+    offset -= OSAL_NV_WORD_SIZE;
+    HalFlashRead(OSAL_NV_PG(idx), offset, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+
+    if (hdr.len & OSAL_NV_INVALID_LEN_MARK)
+    {
+      continue;
+    }
+
+    if (hdr.len > offset - OSAL_NV_PAGE_HDR_SIZE)
+    {
+      // page is corrupt
+      HAL_ASSERT_FORCED();
+      return 0;
+    }
+
+    offset -= hdr.len;
+
+    if (hdr.id == id)
+    {
+      return offset;
+    }
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+ * @fn      buildIndex
+ *
+ * @brief   Fill the RAM index with the latest location of every valid
+ *          item, walking the log from its head.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void buildIndex( void )
+{
+  uint8 idx;
+
+  nvIndexCnt = 0;
+  nvIndexAll = TRUE;
+
+  for (idx = nvHead; idx != OSAL_NV_PAGE_NONE; idx = prevPage(idx))
+  {
+    uint16 offset = nvEnd[idx];
+
+    while (offset >= OSAL_NV_PAGE_HDR_SIZE + OSAL_NV_WORD_SIZE)
+    {
+      osalNvItemHdr_t hdr;
+
+      offset -= OSAL_NV_WORD_SIZE;
+      HalFlashRead(OSAL_NV_PG(idx), offset, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+
+      if (hdr.len & OSAL_NV_INVALID_LEN_MARK)
+      {
+        continue;
+      }
+
+      if (hdr.len > offset - OSAL_NV_PAGE_HDR_SIZE)
+      {
+        // page is corrupt; leave the searching to findItem
+        nvIndexCnt = 0;
+        nvIndexAll = FALSE;
+        return;
+      }
+
+      offset -= hdr.len;
+
+      if (!(hdr.id & OSAL_NV_INVALID_ID_MARK) && !indexFind((osalSnvId_t) hdr.id, NULL))
+      {
+        indexSet((osalSnvId_t) hdr.id, idx, offset);
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      indexFind
+ *
+ * @brief   Binary search of the RAM index.
+ *
+ * @param   id   - NV item ID to search for
+ * @param   pIdx - where to return the position of the ID, or where it
+ *                 would be inserted, or NULL
+ *
+ * @return  TRUE if the ID is in the index, FALSE otherwise
+ */
+static uint8 indexFind( osalSnvId_t id, uint8 *pIdx )
+{
+  uint8 lo = 0;
+  uint8 hi = nvIndexCnt;
+
+  while (lo < hi)
+  {
+    uint8 mid = (lo + hi) / 2;
+
+    if (nvIndex[mid].id < id)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  if (pIdx != NULL)
+  {
+    *pIdx = lo;
+  }
+
+  return ((lo < nvIndexCnt) && (nvIndex[lo].id == id));
+}
+
+/*********************************************************************
+ * @fn      indexSet
+ *
+ * @brief   Record the location of the latest value of an item in the
+ *          RAM index. If the index is full, the ID is left out and
+ *          lookups of IDs missing from the index search the pages.
+ *
+ * @param   id     - NV item ID
+ * @param   pg     - page index
+ * @param   offset - offset of the item data in the page
+ *
+ * @return  none
+ */
+static void indexSet( osalSnvId_t id, uint8 pg, uint16 offset )
+{
+  uint8 idx;
+
+  if (!indexFind(id, &idx))
+  {
+    uint8 i;
+
+    if (nvIndexCnt == OSAL_NV_INDEX_SIZE)
+    {
+      nvIndexAll = FALSE;
+      return;
+    }
+
+    // make room for the new ID
+    for (i = nvIndexCnt; i > idx; i--)
+    {
+      nvIndex[i] = nvIndex[i - 1];
+    }
+    nvIndexCnt++;
+    nvIndex[idx].id = id;
+  }
+
+  nvIndex[idx].pg = pg;
+  nvIndex[idx].offset = offset;
+}
+
+/*********************************************************************
+ * @fn      lookupItem
+ *
+ * @brief   find the latest value of an item, from the RAM index if
+ *          possible
+ *
+ * @param   id  - NV item ID to search for
+ * @param   pPg - where to return the page index of the item
+ *
+ * @return  offset of the item, 0 when not found
+ */
+static uint16 lookupItem( osalSnvId_t id, uint8 *pPg )
+{
+  uint8 idx;
+
+  if (indexFind(id, &idx))
+  {
+    *pPg = nvIndex[idx].pg;
+    return nvIndex[idx].offset;
+  }
+
+  if (!nvIndexAll)
+  {
+    for (idx = nvHead; idx != OSAL_NV_PAGE_NONE; idx = prevPage(idx))
+    {
+      uint16 offset = findItem(idx, id);
+
+      if (offset > 0)
+      {
+        *pPg = idx;
+        return offset;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*********************************************************************
+ * @fn      writeItem
+ *
+ * @brief   Write a data item to NV. Function can write an entire item to NV
+ *
+ * @param   idx    - Page index
+ * @param   offset - offset within the NV page where to write the new item
+ * @param   id     - NV item ID
+ * @param   alignedLen - Length of data to write, alinged in flash word
+ *                       boundary
+ * @param  *pBuf   - Data to write.
+ *
+ * @return  none
+ */
+static void writeItem( uint8 idx, uint16 offset, osalSnvId_t id, uint16 alignedLen, uint8 *pBuf )
+{
+  osalNvItemHdr_t hdr;
+
+  hdr.id = 0xFFFF;
+  hdr.len = alignedLen | OSAL_NV_INVALID_LEN_MARK;
+
+  // Write the len portion of the header first
+  writeWord(idx, offset + alignedLen, (uint8 *) &hdr);
+
+  // remove invalid len mark
+  hdr.len &= ~OSAL_NV_INVALID_LEN_MARK;
+  writeWord(idx, offset + alignedLen, (uint8 *) &hdr);
+
+  // Copy over the data
+  writeWordM(idx, offset, pBuf, alignedLen / OSAL_NV_WORD_SIZE);
+
+  // value is valid. Write header except for the most significant bit.
+  hdr.id = id | OSAL_NV_INVALID_ID_MARK;
+  writeWord(idx, offset + alignedLen, (uint8 *) &hdr);
+
+  // write the most significant bit
+  hdr.id &= ~OSAL_NV_INVALID_ID_MARK;
+  writeWord(idx, offset + alignedLen, (uint8 *) &hdr);
+}
+
+/*********************************************************************
+ * @fn      xferItem
+ *
+ * @brief   Copy an NV item, with its header, to the head of the log.
+ *
+ * @param   srcIdx     - Page index of the original item.
+ * @param   srcOff     - NV page offset of the original data.
+ * @param   alignedLen - Length of data, aligned in flash word boundary.
+ *
+ * @return  none.
+ */
+static void xferItem( uint8 srcIdx, uint16 srcOff, uint16 alignedLen )
+{
+  osalNvItemHdr_t hdr;
+  uint8 tmp[OSAL_NV_WORD_SIZE];
+  uint16 dstOff = nvEnd[nvHead];
+  uint16 i;
+
+  // Write the header with the ID marked invalid first, so that a partly
+  // copied item is skipped rather than taken for the end of the page
+  HalFlashRead(OSAL_NV_PG(srcIdx), srcOff + alignedLen, (uint8 *) &hdr, OSAL_NV_WORD_SIZE);
+  hdr.id |= OSAL_NV_INVALID_ID_MARK;
+  writeWord(nvHead, dstOff + alignedLen, (uint8 *) &hdr);
+
+  // Copy over the data
+  for (i = 0; i < alignedLen; i += OSAL_NV_WORD_SIZE)
+  {
+    HalFlashRead(OSAL_NV_PG(srcIdx), srcOff + i, tmp, OSAL_NV_WORD_SIZE);
+    writeWord(nvHead, dstOff + i, tmp);
+  }
+
+  // write the most significant bit
+  hdr.id &= ~OSAL_NV_INVALID_ID_MARK;
+  writeWord(nvHead, dstOff + alignedLen, (uint8 *) &hdr);
+
+  nvEnd[nvHead] += alignedLen + OSAL_NV_WORD_SIZE;
+}
+
+/*********************************************************************
+ * @fn      writeWord
+ *
+ * @brief   Writes a Flash-WORD to NV.
+ *
+ * @param   idx - A valid NV page index.
+ * @param   offset - A valid offset into the page.
+ * @param   pBuf - Pointer to source buffer.
+ *
+ * @return  none
+ */
+static void writeWord( uint8 idx, uint16 offset, uint8 *pBuf )
+{
+  writeWordM(idx, offset, pBuf, 1);
+}
+
+/*********************************************************************
+ * @fn      writeWordM
+ *
+ * @brief   Writes multiple Flash-WORDs to NV and verifies them.
+ *
+ * @param   idx - A valid NV page index.
+ * @param   offset - A valid offset into the page.
+ * @param   pBuf - Pointer to source buffer.
+ * @param   cnt - Number of 4-byte blocks to write.
+ *
+ * @return  none
+ */
+static void writeWordM( uint8 idx, uint16 offset, uint8 *pBuf, uint16 cnt )
+{
+  uint16 addr = (offset / OSAL_NV_WORD_SIZE) +
+                ((uint16)OSAL_NV_PG(idx) * (OSAL_NV_PAGE_SIZE / OSAL_NV_WORD_SIZE));
+
+  if ( !failF )
+  {
+    HalFlashWrite(addr, pBuf, cnt);
+
+    if (!HalFlashCompare(OSAL_NV_PG(idx), offset, pBuf, cnt * OSAL_NV_WORD_SIZE))
+    {
+      failF = TRUE;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_snv_init
+ *
+ * @brief   Initialize NV service.
+ *
+ * @return  SUCCESS if initialization succeeds. FAILURE, otherwise.
+ */
+uint8 osal_snv_init( void )
+{
+  if (!initNV())
+  {
+    // NV initialization failed
+    HAL_ASSERT_FORCED();
+
+    return FAILURE;
+  }
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_write
+ *
+ * @brief   Write a data item to NV.
+ *
+ * @param   id  - Valid NV item Id, up to 0x7FFF.
+ * @param   len - Length of data to write.
+ * @param   *pBuf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+ */
+uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
+{
+  uint16 alignedLen;
+  uint16 offset;
+  uint8 pg;
+
+  if ((id & OSAL_NV_INVALID_ID_MARK) || failF)
+  {
+    return NV_OPER_FAILED;
+  }
+
+#if defined(OSAL_SNV_UINT16_ID)
+  // An 8-bit length always fits in a page
+  if (len > OSAL_NV_MAX_ITEM_LEN)
+  {
+    return NV_OPER_FAILED;
+  }
+#endif
+
+  offset = lookupItem(id, &pg);
+
+  if ((offset > 0) && HalFlashCompare(OSAL_NV_PG(pg), offset, (uint8 *)pBuf, len))
+  {
+    // Changed value is the same value as before.
+    // Return here instead of re-writing the same value to NV.
+    return SUCCESS;
+  }
+
+  alignedLen = ((len + OSAL_NV_WORD_SIZE - 1) / OSAL_NV_WORD_SIZE) * OSAL_NV_WORD_SIZE;
+
+  if (!makeRoom(alignedLen + OSAL_NV_WORD_SIZE))
+  {
+    return NV_OPER_FAILED;
+  }
+
+  // pBuf shall be referenced beyond its valid length to save code size.
+  writeItem(nvHead, nvEnd[nvHead], id, alignedLen, pBuf);
+  if (failF)
+  {
+    return NV_OPER_FAILED;
+  }
+
+  indexSet(id, nvHead, nvEnd[nvHead]);
+  nvEnd[nvHead] += alignedLen + OSAL_NV_WORD_SIZE;
+
+  // The previous value, if any, is now space to reclaim
+  nvFull = FALSE;
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_read
+ *
+ * @brief   Read data from NV.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   len - Length of data to read.
+ * @param   *pBuf - Data is read into this buffer.
+ *
+ * @return  SUCCESS if successful.
+ *          Otherwise, NV_OPER_FAILED for failure.
+ */
+uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
+{
+  uint8 pg;
+  uint16 offset = lookupItem(id, &pg);
+
+  if (offset != 0)
+  {
+    HalFlashRead(OSAL_NV_PG(pg), offset, pBuf, len);
+    return SUCCESS;
+  }
+  return NV_OPER_FAILED;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_compact
+ *
+ * @brief   Reclaims the oldest page if NV usage has reached a specific
+ *          threshold. Usage counts the pages in use, bar the one kept
+ *          free.
+ *
+ * @param   threshold - compaction threshold
+ *
+ * @return  SUCCESS if successful,
+ *          NV_OPER_FAILED if failed, or
+ *          INVALIDPARAMETER if threshold invalid.
+ */
+uint8 osal_snv_compact( uint8 threshold )
+{
+  uint32 used = 0;
+  uint8 idx;
+
+  if ( ( threshold < OSAL_NV_MIN_COMPACT_THRESHOLD ) ||
+       ( threshold > OSAL_NV_MAX_COMPACT_THRESHOLD ) )
+  {
+    return INVALIDPARAMETER;
+  }
+
+  for (idx = 0; idx < OSAL_NV_PAGES_USED; idx++)
+  {
+    if (nvSeq[idx] != OSAL_NV_ERASED_WORD)
+    {
+      used += nvEnd[idx];
+    }
+  }
+
+  // See if NV usage has reached compaction threshold
+  if ( ( used * 100 ) >=
+       ( (uint32)OSAL_NV_PAGE_SIZE * (OSAL_NV_PAGES_USED - 1) * threshold ) )
+  {
+    uint16 gain;
+
+    if (!nvFull && reclaimPage(&gain))
+    {
+      return SUCCESS;
+    }
+  }
+
+  return NV_OPER_FAILED;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_flush
+ *
+ * @brief   Write the items held in the write-back cache to flash. This
+ *          implementation writes items through, so there is nothing to do.
+ *
+ * @return  SUCCESS
+ */
+uint8 osal_snv_flush( void )
+{
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_snv_erase_count
+ *
+ * @brief   Read the number of times an NV page was erased.
+ *
+ * @param   idx - NV page index, below HAL_NV_PAGE_CNT
+ *
+ * @return  erase count, 0 for an invalid page index
+ */
+uint32 osal_snv_erase_count( uint8 idx )
+{
+  if (idx >= OSAL_NV_PAGES_USED)
+  {
+    return 0;
+  }
+
+  return nvErases[idx];
+}
+
+/*********************************************************************
+*********************************************************************/
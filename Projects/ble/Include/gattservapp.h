@@ -476,6 +476,74 @@ bStatus_t GATTServApp_DeregisterService( uint16 handle, gattAttribute_t **p2pAtt
  */
 extern gattAttribute_t *GATTServApp_FindAttr( gattAttribute_t *pAttrTbl,
                                               uint16 numAttrs, uint8 *pValue );
+
+/**
+ * @brief       Build an index of a service attribute table sorted by
+ *              attribute value pointer, so that GATTServApp_FindAttr()
+ *              does a binary search instead of a linear one. Call it
+ *              once the service is registered; short tables are left
+ *              unindexed and, like tables that are not indexed, are
+ *              searched linearly.
+ *
+ * @param       pAttrTbl - pointer to attribute table
+ * @param       numAttrs - number of attributes in attribute table
+ *
+ * @return      SUCCESS: Table indexed, or too short to need it.<BR>
+ *              bleInvalidRange: More than 255 attributes.<BR>
+ *              bleNoResources: No free index.<BR>
+ *              bleMemAllocError: Memory allocation error occurred.<BR>
+ */
+extern bStatus_t GATTServApp_IndexAttrTbl( gattAttribute_t *pAttrTbl, uint16 numAttrs );
+
+/**
+ * @brief       Free the index of a service attribute table, when the
+ *              service is deregistered.
+ *
+ * @param       pAttrTbl - pointer to attribute table
+ *
+ * @return      none
+ */
+extern void GATTServApp_UnindexAttrTbl( gattAttribute_t *pAttrTbl );
+
+/**
+ * @brief       Turn on the notification queue. Notifications and
+ *              indications sent by GATTServApp_ProcessCharCfg() that
+ *              find no buffers wait in the queue, one entry per link
+ *              and characteristic value, and are sent with the value
+ *              current at that time. The task is sent the event at the
+ *              end of a connection event while the queue is in use,
+ *              and must then call GATTServApp_ProcessNotiQ().
+ *
+ * @param       taskId - task to be sent the event
+ * @param       event - event to be sent
+ *
+ * @return      SUCCESS: Queue on.<BR>
+ *              bleMemAllocError: Memory allocation error occurred.<BR>
+ */
+extern bStatus_t GATTServApp_InitNotiQ( uint8 taskId, uint16 event );
+
+/**
+ * @brief       Send what waits in the notification queue.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+extern void GATTServApp_ProcessNotiQ( void );
+
+/**
+ * @brief       Keep the connection event notice of a link on, so that
+ *              a task streaming notifications itself gets the event
+ *              passed to GATTServApp_InitNotiQ() after every connection
+ *              event of the link. Released when the link goes down.
+ *
+ * @param       connHandle - connection handle
+ * @param       hold - TRUE to keep the notice on, FALSE to release it
+ *
+ * @return      none
+ */
+extern void GATTServApp_HoldNotiQ( uint16 connHandle, uint8 hold );
+
 /**
  * @brief   Add function for the GATT Service.
  *
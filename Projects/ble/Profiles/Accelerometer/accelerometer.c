@@ -420,6 +420,12 @@ bStatus_t Accel_AddService( uint32 services )
                                           GATT_NUM_ATTRS( accelAttrTbl ),
                                           GATT_MAX_ENCRYPT_KEY_SIZE,
                                           &accelCBs );
+
+    // Index the attribute table for notifications
+    if ( status == SUCCESS )
+    {
+      VOID GATTServApp_IndexAttrTbl( accelAttrTbl, GATT_NUM_ATTRS( accelAttrTbl ) );
+    }
   }
 
   return ( status );
@@ -49,6 +49,8 @@
  * INCLUDES
  */
 #include "bcomdef.h"
+#include "OSAL.h"
+#include "hci.h"
 #include "linkdb.h"
 
 #include "gatt.h"
@@ -58,14 +60,63 @@
  * MACROS
  */
 
+// Whether a send failed for lack of buffers and can be retried
+#define gattServApp_NotiRetry( status )  ( ( (status) == MSG_BUFFER_NOT_AVAIL ) || \
+                                           ( (status) == bleNoResources )       || \
+                                           ( (status) == bleMemAllocError )     || \
+                                           ( (status) == blePending ) )
+
 /*********************************************************************
  * CONSTANTS
  */
 
+// Number of attribute tables that can be indexed for GATTServApp_FindAttr()
+#if !defined GATT_SERV_APP_MAX_ATTR_IDX
+  #define GATT_SERV_APP_MAX_ATTR_IDX  8
+#endif
+
+// Shortest attribute table worth indexing; a linear search of a shorter
+// table is as quick as the binary search
+#if !defined GATT_SERV_APP_MIN_ATTR_IDX
+  #define GATT_SERV_APP_MIN_ATTR_IDX  16
+#endif
+
+// Number of notifications and indications that can wait for link layer
+// buffers; updates of a waiting characteristic value are coalesced
+#if !defined GATT_SERV_APP_NOTI_Q_LEN
+  #define GATT_SERV_APP_NOTI_Q_LEN    8
+#endif
+
+// Number of notifications and indications handed to a link per
+// connection event
+#if !defined GATT_SERV_APP_NOTI_CREDITS
+  #define GATT_SERV_APP_NOTI_CREDITS  4
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// Index of an attribute table
+typedef struct
+{
+  gattAttribute_t *pAttrTbl; // Attribute table, NULL for a free index
+  uint16 numAttrs;           // Number of attributes in the table
+  uint8 *pOrder;             // Attribute positions sorted by pValue, ties
+                             // in table order
+} gattServAppAttrIdx_t;
+
+// Notification or indication of a characteristic value
+typedef struct
+{
+  uint16 connHandle;                 // Link, INVALID_CONNHANDLE for a free entry
+  uint8 cccValue;                    // Notification and/or indication
+  uint8 authenticated;               // Whether an authenticated link is required
+  uint8 taskId;                      // Task to be notified of confirmation
+  gattAttribute_t *pAttr;            // Characteristic value attribute
+  pfnGATTReadAttrCB_t pfnReadAttrCB; // Read callback, run when the value is sent
+} gattServAppNoti_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -82,15 +133,31 @@
  * LOCAL VARIABLES
  */
 
+static gattServAppAttrIdx_t gattServAppAttrIdx[GATT_SERV_APP_MAX_ATTR_IDX];
+
+// Notification queue, used once GATTServApp_InitNotiQ() is called
+static gattServAppNoti_t gattServAppNotiQ[GATT_SERV_APP_NOTI_Q_LEN];
+static uint8 *gattServAppNotiCredits = NULL; // Credits left per link
+static uint8 gattServAppNotiNotice = 0;      // Links with connection event notice on
+static uint8 gattServAppNotiHold = 0;        // Links held by GATTServApp_HoldNotiQ()
+static uint8 gattServAppNotiTaskId;
+static uint16 gattServAppNotiEvent;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 
 static gattCharCfg_t *gattServApp_FindCharCfgItem( uint16 connHandle,
                                                    gattCharCfg_t *charCfgTbl );
-static bStatus_t gattServApp_SendNotiInd( uint16 connHandle, uint8 cccValue,
-                                          uint8 authenticated, gattAttribute_t *pAttr,
-                                          uint8 taskId, pfnGATTReadAttrCB_t pfnReadAttrCB );
+static gattServAppAttrIdx_t *gattServApp_FindAttrIdx( gattAttribute_t *pAttrTbl );
+static bStatus_t gattServApp_SendNotiInd( gattServAppNoti_t *pReq,
+                                          attHandleValueNoti_t *pNoti, uint8 copy );
+static void gattServApp_SendQueuedNoti( gattServAppNoti_t *pItem );
+static bStatus_t gattServApp_EnqueueNoti( gattServAppNoti_t *pReq );
+static gattServAppNoti_t *gattServApp_FindNoti( uint16 connHandle, gattAttribute_t *pAttr );
+static uint8 *gattServApp_NotiCredits( uint16 connHandle );
+static void gattServApp_UpdateNotice( uint16 connHandle );
+static void gattServApp_NotiLinkCB( uint16 connHandle, uint8 changeType );
 
 /*********************************************************************
  * API FUNCTIONS
@@ -139,6 +206,12 @@ void GATTServApp_InitCharCfg( uint16 connHandle, gattCharCfg_t *charCfgTbl )
  *
  * @brief   Process Client Charateristic Configuration change.
  *
+ *          The attribute is found and its value read once, into a
+ *          buffer for the subscribed link with the largest MTU. The
+ *          other links are sent copies sized to the value, and that
+ *          buffer is sent last. With the notification queue on, sends
+ *          that find no buffers wait for the next connection event.
+ *
  * @param   charCfgTbl - characteristic configuration table.
  * @param   pValue - pointer to attribute value.
  * @param   authenticated - whether an authenticated link is required.
@@ -155,6 +228,12 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
                                       pfnGATTReadAttrCB_t pfnReadAttrCB )
 {
   uint8 i;
+  uint8 first = linkDBNumConns;
+  uint8 lastCfg;
+  uint16 mtu = 0;
+  uint16 len;
+  gattServAppNoti_t req;
+  attHandleValueNoti_t noti;
   bStatus_t status = SUCCESS;
 
   // Verify input parameters
@@ -164,6 +243,7 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
     return ( INVALIDPARAMETER );
   }
   
+  // Find the subscribed link with the largest MTU
   for ( i = 0; i < linkDBNumConns; i++ )
   {
     gattCharCfg_t *pItem = &(charCfgTbl[i]);
@@ -171,27 +251,117 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
     if ( ( pItem->connHandle != INVALID_CONNHANDLE ) &&
          ( pItem->value != GATT_CFG_NO_OPERATION ) )
     {
-      gattAttribute_t *pAttr;
+      uint16 linkMtu = ATT_GetMTU( pItem->connHandle );
 
-      // Find the characteristic value attribute
-      pAttr = GATTServApp_FindAttr( attrTbl, numAttrs, pValue );
-      if ( pAttr != NULL )
+      if ( ( first == linkDBNumConns ) || ( linkMtu > mtu ) )
       {
-        if ( pItem->value & GATT_CLIENT_CFG_NOTIFY )
-        {
-           status |= gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_NOTIFY, 
-                                              authenticated, pAttr, taskId, pfnReadAttrCB );
-        }
-        
-        if ( pItem->value & GATT_CLIENT_CFG_INDICATE )
-        {
-           status |= gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_INDICATE, 
-                                              authenticated, pAttr, taskId, pfnReadAttrCB );
-        }
+        first = i;
+        mtu = linkMtu;
+      }
+    }
+  }
+
+  if ( first == linkDBNumConns )
+  {
+    // No one subscribed
+    return ( SUCCESS );
+  }
+
+  // Find the characteristic value attribute
+  req.pAttr = GATTServApp_FindAttr( attrTbl, numAttrs, pValue );
+  if ( req.pAttr == NULL )
+  {
+    return ( SUCCESS );
+  }
+
+  req.authenticated = authenticated;
+  req.taskId = taskId;
+  req.pfnReadAttrCB = pfnReadAttrCB;
+
+  // If the attribute value is longer than (ATT_MTU - 3) octets, then
+  // only the first (ATT_MTU - 3) octets of this attributes value can
+  // be sent in a notification.
+  noti.pValue = (uint8 *)GATT_bm_alloc( charCfgTbl[first].connHandle,
+                                        ATT_HANDLE_VALUE_NOTI, GATT_MAX_MTU, &len );
+  if ( noti.pValue == NULL )
+  {
+    if ( gattServApp_NotiCredits( charCfgTbl[first].connHandle ) == NULL )
+    {
+      return ( bleNoResources );
+    }
+
+    // Send to every link at its next connection event
+    for ( i = 0; i < linkDBNumConns; i++ )
+    {
+      gattCharCfg_t *pItem = &(charCfgTbl[i]);
+
+      if ( ( pItem->connHandle != INVALID_CONNHANDLE ) &&
+           ( pItem->value != GATT_CFG_NO_OPERATION ) )
+      {
+        req.connHandle = pItem->connHandle;
+        req.cccValue = pItem->value;
+        status |= gattServApp_EnqueueNoti( &req );
+      }
+    }
+
+    return ( status );
+  }
+
+  status = (*pfnReadAttrCB)( charCfgTbl[first].connHandle, req.pAttr, noti.pValue,
+                             &noti.len, 0, len, GATT_LOCAL_READ );
+  if ( status != SUCCESS )
+  {
+    GATT_bm_free( (gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI );
+
+    return ( status );
+  }
+
+  noti.handle = req.pAttr->handle;
+
+  // The buffer read into goes with the last message to its own link
+  if ( charCfgTbl[first].value & GATT_CLIENT_CFG_INDICATE )
+  {
+    lastCfg = GATT_CLIENT_CFG_INDICATE;
+  }
+  else
+  {
+    lastCfg = GATT_CLIENT_CFG_NOTIFY;
+  }
+
+  for ( i = 0; i < linkDBNumConns; i++ )
+  {
+    gattCharCfg_t *pItem = &(charCfgTbl[i]);
+
+    if ( ( pItem->connHandle != INVALID_CONNHANDLE ) &&
+         ( pItem->value != GATT_CFG_NO_OPERATION ) )
+    {
+      uint8 value = pItem->value;
+
+      if ( i == first )
+      {
+        value &= ~lastCfg;
+      }
+
+      req.connHandle = pItem->connHandle;
+
+      if ( value & GATT_CLIENT_CFG_NOTIFY )
+      {
+         req.cccValue = GATT_CLIENT_CFG_NOTIFY;
+         status |= gattServApp_SendNotiInd( &req, &noti, TRUE );
+      }
+      
+      if ( value & GATT_CLIENT_CFG_INDICATE )
+      {
+         req.cccValue = GATT_CLIENT_CFG_INDICATE;
+         status |= gattServApp_SendNotiInd( &req, &noti, TRUE );
       }
     }
   } // for
   
+  req.connHandle = charCfgTbl[first].connHandle;
+  req.cccValue = lastCfg;
+  status |= gattServApp_SendNotiInd( &req, &noti, FALSE );
+
   return ( status );
 }
 
@@ -199,7 +369,8 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
  * @fn          GATTServApp_FindAttr
  *
  * @brief       Find the attribute record within a service attribute
- *              table for a given attribute value pointer.
+ *              table for a given attribute value pointer. Indexed
+ *              tables are searched by halving, others one by one.
  *
  * @param       pAttrTbl - pointer to attribute table
  * @param       numAttrs - number of attributes in attribute table
@@ -210,7 +381,42 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
 gattAttribute_t *GATTServApp_FindAttr( gattAttribute_t *pAttrTbl, 
                                        uint16 numAttrs, uint8 *pValue )
 {
+  gattServAppAttrIdx_t *pIdx = NULL;
   uint16  i;
+
+  if ( numAttrs >= GATT_SERV_APP_MIN_ATTR_IDX )
+  {
+    pIdx = gattServApp_FindAttrIdx( pAttrTbl );
+  }
+
+  if ( ( pIdx != NULL ) && ( pIdx->numAttrs == numAttrs ) )
+  {
+    uint8 lo = 0;
+    uint8 hi = (uint8)numAttrs;
+
+    // Find the first position whose value pointer is not below pValue
+    while ( lo < hi )
+    {
+      uint8 mid = (uint8)( ( lo + hi ) >> 1 );
+
+      if ( pAttrTbl[pIdx->pOrder[mid]].pValue < pValue )
+      {
+        lo = mid + 1;
+      }
+      else
+      {
+        hi = mid;
+      }
+    }
+
+    if ( ( lo < numAttrs ) && ( pAttrTbl[pIdx->pOrder[lo]].pValue == pValue ) )
+    {
+      return ( &(pAttrTbl[pIdx->pOrder[lo]]) );
+    }
+
+    return ( (gattAttribute_t *)NULL );
+  }
+
   for ( i = 0; i < numAttrs; i++ )
   {
     if ( pAttrTbl[i].pValue == pValue )
@@ -223,6 +429,226 @@ gattAttribute_t *GATTServApp_FindAttr( gattAttribute_t *pAttrTbl,
   return ( (gattAttribute_t *)NULL );
 }
 
+/*********************************************************************
+ * @fn          GATTServApp_IndexAttrTbl
+ *
+ * @brief       Build an index of a service attribute table sorted by
+ *              attribute value pointer for GATTServApp_FindAttr(). An
+ *              existing index of the table is rebuilt. Tables shorter
+ *              than GATT_SERV_APP_MIN_ATTR_IDX are left unindexed.
+ *
+ * @param       pAttrTbl - pointer to attribute table
+ * @param       numAttrs - number of attributes in attribute table
+ *
+ * @return      SUCCESS: Table indexed, or too short to need it.
+ *              bleInvalidRange: More than 255 attributes.
+ *              bleNoResources: No free index.
+ *              bleMemAllocError: Memory allocation error occurred.
+ */
+bStatus_t GATTServApp_IndexAttrTbl( gattAttribute_t *pAttrTbl, uint16 numAttrs )
+{
+  gattServAppAttrIdx_t *pIdx;
+  uint8 i;
+
+  if ( ( pAttrTbl == NULL ) || ( numAttrs > 0xFF ) )
+  {
+    return ( bleInvalidRange );
+  }
+
+  GATTServApp_UnindexAttrTbl( pAttrTbl );
+
+  if ( numAttrs < GATT_SERV_APP_MIN_ATTR_IDX )
+  {
+    return ( SUCCESS );
+  }
+
+  // Take a free index
+  pIdx = gattServApp_FindAttrIdx( NULL );
+  if ( pIdx == NULL )
+  {
+    return ( bleNoResources );
+  }
+
+  pIdx->pOrder = (uint8 *)osal_mem_alloc( (uint16)numAttrs );
+  if ( pIdx->pOrder == NULL )
+  {
+    return ( bleMemAllocError );
+  }
+
+  // Insertion sort, run once per service; inserting in table order keeps
+  // attributes that share a value pointer in table order, so the first
+  // one is found as by a linear search
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    uint8 j = i;
+
+    while ( ( j > 0 ) &&
+            ( pAttrTbl[i].pValue < pAttrTbl[pIdx->pOrder[j-1]].pValue ) )
+    {
+      pIdx->pOrder[j] = pIdx->pOrder[j-1];
+      j--;
+    }
+
+    pIdx->pOrder[j] = i;
+  }
+
+  pIdx->numAttrs = numAttrs;
+  pIdx->pAttrTbl = pAttrTbl;
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn          GATTServApp_UnindexAttrTbl
+ *
+ * @brief       Free the index of a service attribute table.
+ *
+ * @param       pAttrTbl - pointer to attribute table
+ *
+ * @return      none
+ */
+void GATTServApp_UnindexAttrTbl( gattAttribute_t *pAttrTbl )
+{
+  gattServAppAttrIdx_t *pIdx;
+
+  if ( pAttrTbl == NULL )
+  {
+    return;
+  }
+
+  pIdx = gattServApp_FindAttrIdx( pAttrTbl );
+  if ( pIdx != NULL )
+  {
+    osal_mem_free( pIdx->pOrder );
+
+    pIdx->pOrder = NULL;
+    pIdx->pAttrTbl = NULL;
+    pIdx->numAttrs = 0;
+  }
+}
+
+/*********************************************************************
+ * @fn          GATTServApp_InitNotiQ
+ *
+ * @brief       Turn on the notification queue. Notifications and
+ *              indications that find no buffers wait in the queue, and
+ *              each link is handed at most GATT_SERV_APP_NOTI_CREDITS
+ *              of them per connection event. The task is sent the event
+ *              at the end of a connection event while a link has sends
+ *              waiting or credits used, and calls
+ *              GATTServApp_ProcessNotiQ().
+ *
+ * @param       taskId - task to be sent the event.
+ * @param       event - event to be sent.
+ *
+ * @return      SUCCESS: Queue on.
+ *              bleMemAllocError: Memory allocation error occurred.
+ */
+bStatus_t GATTServApp_InitNotiQ( uint8 taskId, uint16 event )
+{
+  uint8 i;
+
+  if ( gattServAppNotiCredits == NULL )
+  {
+    gattServAppNotiCredits = (uint8 *)osal_mem_alloc( linkDBNumConns );
+    if ( gattServAppNotiCredits == NULL )
+    {
+      return ( bleMemAllocError );
+    }
+
+    // Drop what waits for a link once it goes down
+    VOID linkDB_Register( gattServApp_NotiLinkCB );
+  }
+
+  gattServAppNotiTaskId = taskId;
+  gattServAppNotiEvent = event;
+  gattServAppNotiNotice = 0;
+  gattServAppNotiHold = 0;
+
+  for ( i = 0; i < GATT_SERV_APP_NOTI_Q_LEN; i++ )
+  {
+    gattServAppNotiQ[i].connHandle = INVALID_CONNHANDLE;
+  }
+
+  for ( i = 0; i < linkDBNumConns; i++ )
+  {
+    gattServAppNotiCredits[i] = GATT_SERV_APP_NOTI_CREDITS;
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn          GATTServApp_ProcessNotiQ
+ *
+ * @brief       Give the links new credits and send what waits in the
+ *              notification queue, reading each value as it is sent.
+ *              Called on the event passed to GATTServApp_InitNotiQ().
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+void GATTServApp_ProcessNotiQ( void )
+{
+  uint8 i;
+
+  if ( gattServAppNotiCredits == NULL )
+  {
+    return;
+  }
+
+  // A connection event ended and the link layer buffers drained
+  for ( i = 0; i < linkDBNumConns; i++ )
+  {
+    gattServAppNotiCredits[i] = GATT_SERV_APP_NOTI_CREDITS;
+  }
+
+  for ( i = 0; i < GATT_SERV_APP_NOTI_Q_LEN; i++ )
+  {
+    if ( gattServAppNotiQ[i].connHandle != INVALID_CONNHANDLE )
+    {
+      gattServApp_SendQueuedNoti( &(gattServAppNotiQ[i]) );
+    }
+  }
+
+  for ( i = 0; i < linkDBNumConns; i++ )
+  {
+    gattServApp_UpdateNotice( i );
+  }
+}
+
+/*********************************************************************
+ * @fn          GATTServApp_HoldNotiQ
+ *
+ * @brief       Keep the connection event notice of a link on, for a
+ *              task that streams notifications itself and sends more
+ *              on the event passed to GATTServApp_InitNotiQ().
+ *
+ * @param       connHandle - link.
+ * @param       hold - TRUE to keep the notice on, FALSE to release it.
+ *
+ * @return      none
+ */
+void GATTServApp_HoldNotiQ( uint16 connHandle, uint8 hold )
+{
+  if ( gattServApp_NotiCredits( connHandle ) == NULL )
+  {
+    return;
+  }
+
+  if ( hold )
+  {
+    gattServAppNotiHold |= BV( connHandle );
+  }
+  else
+  {
+    gattServAppNotiHold &= ~BV( connHandle );
+  }
+
+  gattServApp_UpdateNotice( connHandle );
+}
+
 /*********************************************************************
  * @fn      GATTServApp_ProcessCCCWriteReq
  *
@@ -378,50 +804,104 @@ static gattCharCfg_t *gattServApp_FindCharCfgItem( uint16 connHandle,
   return ( (gattCharCfg_t *)NULL );
 }
 
+/*********************************************************************
+ * @fn      gattServApp_FindAttrIdx
+ *
+ * @brief   Find the index of an attribute table.
+ *
+ * @param   pAttrTbl - attribute table (NULL for a free index)
+ *
+ * @return  pointer to the found index. NULL, otherwise.
+ */
+static gattServAppAttrIdx_t *gattServApp_FindAttrIdx( gattAttribute_t *pAttrTbl )
+{
+  uint8 i;
+  for ( i = 0; i < GATT_SERV_APP_MAX_ATTR_IDX; i++ )
+  {
+    if ( gattServAppAttrIdx[i].pAttrTbl == pAttrTbl )
+    {
+      // Index found
+      return ( &(gattServAppAttrIdx[i]) );
+    }
+  }
+
+  return ( (gattServAppAttrIdx_t *)NULL );
+}
+
  /*********************************************************************
  * @fn      gattServApp_SendNotiInd
  *
- * @brief   Send an ATT Notification/Indication.
+ * @brief   Send an ATT Notification/Indication, either of the value
+ *          buffer itself, which is then owned by the stack, or of a
+ *          copy of it allocated for the link. With the notification
+ *          queue on, the send is queued instead when the link has no
+ *          credits left, the value already waits for the link, or no
+ *          buffers are available.
  *
- * @param   connHandle - connection handle to use.
- * @param   cccValue - client characteristic configuration value.
- * @param   authenticated - whether an authenticated link is required.
- * @param   pAttr - pointer to attribute record.
- * @param   taskId - task to be notified of confirmation.
- * @param   pfnReadAttrCB - read callback function pointer.
+ * @param   pReq - link, configuration value and attribute to send.
+ * @param   pNoti - pointer to notification holding the value buffer.
+ * @param   copy - whether to send a copy of the value buffer.
  *
  * @return  Success or Failure
  */
-static bStatus_t gattServApp_SendNotiInd( uint16 connHandle, uint8 cccValue,
-                                          uint8 authenticated, gattAttribute_t *pAttr,
-                                          uint8 taskId, pfnGATTReadAttrCB_t pfnReadAttrCB )
+static bStatus_t gattServApp_SendNotiInd( gattServAppNoti_t *pReq,
+                                          attHandleValueNoti_t *pNoti, uint8 copy )
 {
   attHandleValueNoti_t noti;
+  uint8 *pCredits = gattServApp_NotiCredits( pReq->connHandle );
   uint16 len;
   bStatus_t status;
 
-  // If the attribute value is longer than (ATT_MTU - 3) octets, then
-  // only the first (ATT_MTU - 3) octets of this attributes value can
-  // be sent in a notification.
-  noti.pValue = (uint8 *)GATT_bm_alloc( connHandle, ATT_HANDLE_VALUE_NOTI,
-                                        GATT_MAX_MTU, &len );
-  if ( noti.pValue != NULL )
+  if ( ( pCredits != NULL ) &&
+       ( ( *pCredits == 0 ) ||
+         ( gattServApp_FindNoti( pReq->connHandle, pReq->pAttr ) != NULL ) ) )
   {
-    status = (*pfnReadAttrCB)( connHandle, pAttr, noti.pValue, &noti.len, 
-                               0, len, GATT_LOCAL_READ );
-    if ( status == SUCCESS )
+    if ( !copy )
     {
-      noti.handle = pAttr->handle;
-      
-      if ( cccValue & GATT_CLIENT_CFG_NOTIFY )
-      {
-        status = GATT_Notification( connHandle, &noti, authenticated );
-      }
-      else // GATT_CLIENT_CFG_INDICATE
-      {
-        status = GATT_Indication( connHandle, (attHandleValueInd_t *)&noti,
-                                  authenticated, taskId );
-      }
+      GATT_bm_free( (gattMsg_t *)pNoti, ATT_HANDLE_VALUE_NOTI );
+    }
+
+    // Send the latest value at the next connection event
+    return ( gattServApp_EnqueueNoti( pReq ) );
+  }
+
+  noti.handle = pNoti->handle;
+
+  if ( copy )
+  {
+    // Sized to the value, or (ATT_MTU - 3) of this link if that is less
+    noti.pValue = (uint8 *)GATT_bm_alloc( pReq->connHandle, ATT_HANDLE_VALUE_NOTI,
+                                          pNoti->len, &len );
+    if ( noti.pValue == NULL )
+    {
+      status = bleNoResources;
+    }
+    else
+    {
+      noti.len = (uint8)MIN( len, pNoti->len );
+      VOID osal_memcpy( noti.pValue, pNoti->pValue, noti.len );
+
+      status = SUCCESS;
+    }
+  }
+  else
+  {
+    noti.pValue = pNoti->pValue;
+    noti.len = pNoti->len;
+
+    status = SUCCESS;
+  }
+
+  if ( status == SUCCESS )
+  {
+    if ( pReq->cccValue & GATT_CLIENT_CFG_NOTIFY )
+    {
+      status = GATT_Notification( pReq->connHandle, &noti, pReq->authenticated );
+    }
+    else // GATT_CLIENT_CFG_INDICATE
+    {
+      status = GATT_Indication( pReq->connHandle, (attHandleValueInd_t *)&noti,
+                                pReq->authenticated, pReq->taskId );
     }
     
     if ( status != SUCCESS )
@@ -429,14 +909,236 @@ static bStatus_t gattServApp_SendNotiInd( uint16 connHandle, uint8 cccValue,
       GATT_bm_free( (gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI );
     }
   }
-  else
+
+  if ( pCredits != NULL )
   {
-    status = bleNoResources;
+    if ( status == SUCCESS )
+    {
+      (*pCredits)--;
+
+      gattServApp_UpdateNotice( pReq->connHandle );
+    }
+    else if ( gattServApp_NotiRetry( status ) )
+    {
+      // The link takes no more until its next connection event
+      *pCredits = 0;
+
+      status = gattServApp_EnqueueNoti( pReq );
+    }
   }
   
   return ( status );
 }
 
+/*********************************************************************
+ * @fn      gattServApp_SendQueuedNoti
+ *
+ * @brief   Send a queued notification and/or indication with the
+ *          current characteristic value. A send that has to wait again
+ *          is queued again.
+ *
+ * @param   pItem - queue entry.
+ *
+ * @return  none
+ */
+static void gattServApp_SendQueuedNoti( gattServAppNoti_t *pItem )
+{
+  gattServAppNoti_t req = *pItem;
+  attHandleValueNoti_t noti;
+  uint16 len;
+
+  // Free the entry; what has to wait again takes the first free one
+  pItem->connHandle = INVALID_CONNHANDLE;
+
+  noti.pValue = (uint8 *)GATT_bm_alloc( req.connHandle, ATT_HANDLE_VALUE_NOTI,
+                                        GATT_MAX_MTU, &len );
+  if ( noti.pValue == NULL )
+  {
+    *gattServApp_NotiCredits( req.connHandle ) = 0;
+
+    VOID gattServApp_EnqueueNoti( &req );
+
+    return;
+  }
+
+  if ( (*req.pfnReadAttrCB)( req.connHandle, req.pAttr, noti.pValue, &noti.len,
+                             0, len, GATT_LOCAL_READ ) != SUCCESS )
+  {
+    GATT_bm_free( (gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI );
+
+    return;
+  }
+
+  noti.handle = req.pAttr->handle;
+
+  if ( req.cccValue == ( GATT_CLIENT_CFG_NOTIFY | GATT_CLIENT_CFG_INDICATE ) )
+  {
+    req.cccValue = GATT_CLIENT_CFG_NOTIFY;
+    VOID gattServApp_SendNotiInd( &req, &noti, TRUE );
+
+    req.cccValue = GATT_CLIENT_CFG_INDICATE;
+  }
+
+  VOID gattServApp_SendNotiInd( &req, &noti, FALSE );
+}
+
+/*********************************************************************
+ * @fn      gattServApp_EnqueueNoti
+ *
+ * @brief   Queue a notification or indication, or add it to the entry
+ *          already queued for the same link and attribute.
+ *
+ * @param   pReq - link, configuration value and attribute to send.
+ *
+ * @return  SUCCESS: Queued.
+ *          bleNoResources: Queue full.
+ */
+static bStatus_t gattServApp_EnqueueNoti( gattServAppNoti_t *pReq )
+{
+  gattServAppNoti_t *pItem = gattServApp_FindNoti( pReq->connHandle, pReq->pAttr );
+
+  if ( pItem != NULL )
+  {
+    // The value is read when sent, so the entry covers this update too
+    pItem->cccValue |= pReq->cccValue;
+  }
+  else
+  {
+    pItem = gattServApp_FindNoti( INVALID_CONNHANDLE, NULL );
+    if ( pItem == NULL )
+    {
+      return ( bleNoResources );
+    }
+
+    *pItem = *pReq;
+  }
+
+  gattServApp_UpdateNotice( pReq->connHandle );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      gattServApp_FindNoti
+ *
+ * @brief   Find a notification queue entry.
+ *
+ * @param   connHandle - link (INVALID_CONNHANDLE for a free entry).
+ * @param   pAttr - attribute (NULL for any).
+ *
+ * @return  pointer to the found entry. NULL, otherwise.
+ */
+static gattServAppNoti_t *gattServApp_FindNoti( uint16 connHandle, gattAttribute_t *pAttr )
+{
+  uint8 i;
+  for ( i = 0; i < GATT_SERV_APP_NOTI_Q_LEN; i++ )
+  {
+    if ( ( gattServAppNotiQ[i].connHandle == connHandle ) &&
+         ( ( pAttr == NULL ) || ( gattServAppNotiQ[i].pAttr == pAttr ) ) )
+    {
+      // Entry found
+      return ( &(gattServAppNotiQ[i]) );
+    }
+  }
+
+  return ( (gattServAppNoti_t *)NULL );
+}
+
+/*********************************************************************
+ * @fn      gattServApp_NotiCredits
+ *
+ * @brief   Find the credits of a link.
+ *
+ * @param   connHandle - link.
+ *
+ * @return  pointer to the credits. NULL if the notification queue is
+ *          off or the link is unknown.
+ */
+static uint8 *gattServApp_NotiCredits( uint16 connHandle )
+{
+  if ( ( gattServAppNotiCredits == NULL ) || ( connHandle >= linkDBNumConns ) )
+  {
+    return ( (uint8 *)NULL );
+  }
+
+  return ( &(gattServAppNotiCredits[connHandle]) );
+}
+
+/*********************************************************************
+ * @fn      gattServApp_UpdateNotice
+ *
+ * @brief   Keep the connection event notice of a link on while it has
+ *          sends waiting, credits used or a hold, and off otherwise.
+ *          The CC254x allows at most three links, so they fit in a bit
+ *          mask.
+ *
+ * @param   connHandle - link.
+ *
+ * @return  none
+ */
+static void gattServApp_UpdateNotice( uint16 connHandle )
+{
+  uint8 *pCredits = gattServApp_NotiCredits( connHandle );
+  uint8 on;
+
+  if ( pCredits == NULL )
+  {
+    return;
+  }
+
+  on = ( ( *pCredits < GATT_SERV_APP_NOTI_CREDITS ) ||
+         ( gattServAppNotiHold & BV( connHandle ) ) ||
+         ( gattServApp_FindNoti( connHandle, NULL ) != NULL ) );
+
+  if ( on && !( gattServAppNotiNotice & BV( connHandle ) ) )
+  {
+    VOID HCI_EXT_ConnEventNoticeCmd( connHandle, gattServAppNotiTaskId,
+                                     gattServAppNotiEvent );
+
+    gattServAppNotiNotice |= BV( connHandle );
+  }
+  else if ( !on && ( gattServAppNotiNotice & BV( connHandle ) ) )
+  {
+    VOID HCI_EXT_ConnEventNoticeCmd( connHandle, gattServAppNotiTaskId, 0 );
+
+    gattServAppNotiNotice &= ~BV( connHandle );
+  }
+}
+
+/*********************************************************************
+ * @fn      gattServApp_NotiLinkCB
+ *
+ * @brief   Link database callback; drops what waits for a link that
+ *          went down.
+ *
+ * @param   connHandle - link.
+ * @param   changeType - type of change.
+ *
+ * @return  none
+ */
+static void gattServApp_NotiLinkCB( uint16 connHandle, uint8 changeType )
+{
+  uint8 *pCredits = gattServApp_NotiCredits( connHandle );
+  uint8 i;
+
+  if ( ( pCredits == NULL ) || ( changeType != LINKDB_STATUS_UPDATE_REMOVED ) )
+  {
+    return;
+  }
+
+  for ( i = 0; i < GATT_SERV_APP_NOTI_Q_LEN; i++ )
+  {
+    if ( gattServAppNotiQ[i].connHandle == connHandle )
+    {
+      gattServAppNotiQ[i].connHandle = INVALID_CONNHANDLE;
+    }
+  }
+
+  // The notice ended with the connection
+  *pCredits = GATT_SERV_APP_NOTI_CREDITS;
+  gattServAppNotiNotice &= ~BV( connHandle );
+  gattServAppNotiHold &= ~BV( connHandle );
+}
 
 /****************************************************************************
 ****************************************************************************/
@@ -617,6 +617,12 @@ bStatus_t HidKbd_AddService( void )
   status = GATTServApp_RegisterService( hidAttrTbl, GATT_NUM_ATTRS( hidAttrTbl ),
                                         GATT_MAX_ENCRYPT_KEY_SIZE, &hidKbdCBs );
 
+  // Index the attribute table for notifications
+  if ( status == SUCCESS )
+  {
+    VOID GATTServApp_IndexAttrTbl( hidAttrTbl, GATT_NUM_ATTRS( hidAttrTbl ) );
+  }
+
   // Set up included service
   Batt_GetParameter( BATT_PARAM_SERVICE_HANDLE,
                      &GATT_INCLUDED_HANDLE( hidAttrTbl, HID_INCLUDED_SERVICE_IDX ) );
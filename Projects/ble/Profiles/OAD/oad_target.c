@@ -66,6 +66,7 @@
 #include "oad.h"
 #include "oad_target.h"
 #include "OSAL.h"
+#include "osal_snv.h"
 
 /*********************************************************************
  * CONSTANTS
@@ -294,6 +295,8 @@ static uint8 checkDL(void);
  */
 bStatus_t OADTarget_AddService(void)
 {
+  bStatus_t status;
+
   // Allocate Client Characteristic Configuration table
   oadImgIdentifyConfig = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
                                                           linkDBNumConns);
@@ -318,8 +321,16 @@ bStatus_t OADTarget_AddService(void)
   GATTServApp_InitCharCfg( INVALID_CONNHANDLE, oadImgIdentifyConfig );
   GATTServApp_InitCharCfg( INVALID_CONNHANDLE, oadImgBlockConfig );
 
-  return GATTServApp_RegisterService(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl),
-                                     GATT_MAX_ENCRYPT_KEY_SIZE, &oadCBs);
+  status = GATTServApp_RegisterService(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl),
+                                       GATT_MAX_ENCRYPT_KEY_SIZE, &oadCBs);
+
+  // Resolve the 128-bit attribute types of the table like 16-bit ones
+  if (status == SUCCESS)
+  {
+    VOID GATT_RegisterUUIDRecs(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl));
+  }
+
+  return status;
 }
 
 /*********************************************************************
@@ -506,6 +517,11 @@ static bStatus_t oadImgBlockWrite( uint16 connHandle, uint8 *pValue )
 
   if (oadBlkNum == oadBlkTot)  // If the OAD Image is complete.
   {
+#if OSAL_SNV_WRITE_BACK
+    // Don't lose the items still held in the SNV write-back cache
+    (void)osal_snv_flush();
+#endif
+
 #if defined FEATURE_OAD_SECURE
     HAL_SYSTEM_RESET();  // Only the secure OAD boot loader has the security key to decrypt.
 #else
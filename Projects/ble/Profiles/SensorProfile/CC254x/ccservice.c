@@ -298,10 +298,18 @@ bStatus_t CcService_AddService( void )
   }
 
   // Register GATT attribute list and CBs with GATT Server App
-  return GATTServApp_RegisterService( ccServiceAttrTbl,
-                                      GATT_NUM_ATTRS (ccServiceAttrTbl),
-                                      GATT_MAX_ENCRYPT_KEY_SIZE,
-                                      &ccServiceCBs );
+  ret = GATTServApp_RegisterService( ccServiceAttrTbl,
+                                     GATT_NUM_ATTRS (ccServiceAttrTbl),
+                                     GATT_MAX_ENCRYPT_KEY_SIZE,
+                                     &ccServiceCBs );
+
+  // Resolve the 128-bit attribute types of the table like 16-bit ones
+  if (ret == SUCCESS)
+  {
+    VOID GATT_RegisterUUIDRecs( ccServiceAttrTbl, GATT_NUM_ATTRS (ccServiceAttrTbl) );
+  }
+
+  return ret;
 }
 
 
@@ -310,10 +310,18 @@ bStatus_t Humidity_AddService( void )
   }
 
   // Register GATT attribute list and CBs with GATT Server App
-  return GATTServApp_RegisterService( sensorAttrTable,
-                                      GATT_NUM_ATTRS (sensorAttrTable),
-                                      GATT_MAX_ENCRYPT_KEY_SIZE,
-                                      &sensorCBs );
+  ret = GATTServApp_RegisterService( sensorAttrTable,
+                                     GATT_NUM_ATTRS (sensorAttrTable),
+                                     GATT_MAX_ENCRYPT_KEY_SIZE,
+                                     &sensorCBs );
+
+  // Resolve the 128-bit attribute types of the table like 16-bit ones
+  if (ret == SUCCESS)
+  {
+    VOID GATT_RegisterUUIDRecs( sensorAttrTable, GATT_NUM_ATTRS (sensorAttrTable) );
+  }
+
+  return ret;
 }
 
 
@@ -238,11 +238,21 @@ CONST gattServiceCBs_t testCBs =
  */
 bStatus_t Test_AddService(void)
 {
+  bStatus_t ret;
+
   // Register GATT attribute list and CBs with GATT Server App
-  return GATTServApp_RegisterService( testAttrTable,
-                                      GATT_NUM_ATTRS (testAttrTable),
-                                      GATT_MAX_ENCRYPT_KEY_SIZE,
-                                      &testCBs );
+  ret = GATTServApp_RegisterService( testAttrTable,
+                                     GATT_NUM_ATTRS (testAttrTable),
+                                     GATT_MAX_ENCRYPT_KEY_SIZE,
+                                     &testCBs );
+
+  // Resolve the 128-bit attribute types like 16-bit ones
+  if (ret == SUCCESS)
+  {
+    VOID GATT_RegisterUUIDRecs( testAttrTable, GATT_NUM_ATTRS (testAttrTable) );
+  }
+
+  return ret;
 }
 
 /*********************************************************************
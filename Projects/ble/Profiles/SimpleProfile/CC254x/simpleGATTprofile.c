@@ -70,7 +70,10 @@
  * CONSTANTS
  */
 
-#define SERVAPP_NUM_ATTR_SUPPORTED        17
+#define SERVAPP_NUM_ATTR_SUPPORTED        21
+
+// Position of Characteristic 6 value in the attribute table
+#define SIMPLEPROFILE_CHAR6_VALUE_POS     18
 
 /*********************************************************************
  * TYPEDEFS
@@ -115,6 +118,12 @@ CONST uint8 simpleProfilechar5UUID[ATT_BT_UUID_SIZE] =
   LO_UINT16(SIMPLEPROFILE_CHAR5_UUID), HI_UINT16(SIMPLEPROFILE_CHAR5_UUID)
 };
 
+// Characteristic 6 UUID: 0xFFF6
+CONST uint8 simpleProfilechar6UUID[ATT_BT_UUID_SIZE] =
+{ 
+  LO_UINT16(SIMPLEPROFILE_CHAR6_UUID), HI_UINT16(SIMPLEPROFILE_CHAR6_UUID)
+};
+
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -192,6 +201,19 @@ static uint8 simpleProfileChar5[SIMPLEPROFILE_CHAR5_LEN] = { 0, 0, 0, 0, 0 };
 // Simple Profile Characteristic 5 User Description
 static uint8 simpleProfileChar5UserDesp[17] = "Characteristic 5";
 
+
+// Simple Profile Characteristic 6 Properties
+static uint8 simpleProfileChar6Props = GATT_PROP_WRITE | GATT_PROP_NOTIFY;
+
+// Characteristic 6 Value, the sequence number a stream starts from
+static uint8 simpleProfileChar6[SIMPLEPROFILE_CHAR6_LEN] = { 0, 0 };
+
+// Simple Profile Characteristic 6 Configuration
+static gattCharCfg_t *simpleProfileChar6Config;
+
+// Simple Profile Characteristic 6 User Description
+static uint8 simpleProfileChar6UserDesp[17] = "Characteristic 6";
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -333,6 +355,38 @@ static gattAttribute_t simpleProfileAttrTbl[SERVAPP_NUM_ATTR_SUPPORTED] =
         0, 
         simpleProfileChar5UserDesp 
       },
+
+    // Characteristic 6 Declaration
+    { 
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ, 
+      0,
+      &simpleProfileChar6Props 
+    },
+
+      // Characteristic Value 6
+      { 
+        { ATT_BT_UUID_SIZE, simpleProfilechar6UUID },
+        GATT_PERMIT_WRITE, 
+        0, 
+        simpleProfileChar6 
+      },
+
+      // Characteristic 6 configuration
+      { 
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE, 
+        0, 
+        (uint8 *)&simpleProfileChar6Config 
+      },
+      
+      // Characteristic 6 User Description
+      { 
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ, 
+        0, 
+        simpleProfileChar6UserDesp 
+      },
 };
 
 /*********************************************************************
@@ -383,8 +437,16 @@ bStatus_t SimpleProfile_AddService( uint32 services )
     return ( bleMemAllocError );
   }
   
+  simpleProfileChar6Config = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
+                                                              linkDBNumConns );
+  if ( simpleProfileChar6Config == NULL )
+  {     
+    return ( bleMemAllocError );
+  }
+  
   // Initialize Client Characteristic Configuration attributes
   GATTServApp_InitCharCfg( INVALID_CONNHANDLE, simpleProfileChar4Config );
+  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, simpleProfileChar6Config );
   
   if ( services & SIMPLEPROFILE_SERVICE )
   {
@@ -393,6 +455,12 @@ bStatus_t SimpleProfile_AddService( uint32 services )
                                           GATT_NUM_ATTRS( simpleProfileAttrTbl ),
                                           GATT_MAX_ENCRYPT_KEY_SIZE,
                                           &simpleProfileCBs );
+
+    // Index the attribute table for notifications
+    if ( status == SUCCESS )
+    {
+      VOID GATTServApp_IndexAttrTbl( simpleProfileAttrTbl, GATT_NUM_ATTRS( simpleProfileAttrTbl ) );
+    }
   }
   else
   {
@@ -504,6 +572,17 @@ bStatus_t SimpleProfile_SetParameter( uint8 param, uint8 len, void *value )
         ret = bleInvalidRange;
       }
       break;
+
+    case SIMPLEPROFILE_CHAR6:
+      if ( len == SIMPLEPROFILE_CHAR6_LEN ) 
+      {
+        VOID memcpy( simpleProfileChar6, value, SIMPLEPROFILE_CHAR6_LEN );
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
       
     default:
       ret = INVALIDPARAMETER;
@@ -550,6 +629,10 @@ bStatus_t SimpleProfile_GetParameter( uint8 param, void *value )
     case SIMPLEPROFILE_CHAR5:
       VOID memcpy( value, simpleProfileChar5, SIMPLEPROFILE_CHAR5_LEN );
       break;      
+
+    case SIMPLEPROFILE_CHAR6:
+      *((uint16*)value) = BUILD_UINT16( simpleProfileChar6[0], simpleProfileChar6[1] );
+      break;
       
     default:
       ret = INVALIDPARAMETER;
@@ -559,6 +642,36 @@ bStatus_t SimpleProfile_GetParameter( uint8 param, void *value )
   return ( ret );
 }
 
+/*********************************************************************
+ * @fn      SimpleProfile_StreamSend
+ *
+ * @brief   Send a notification of Characteristic 6. The caller
+ *          allocates the notification with GATT_bm_alloc() and frees
+ *          it if the send fails.
+ *
+ * @param   connHandle - connection handle
+ * @param   pNoti - pointer to notification structure
+ *
+ * @return  Success or Failure; bleNotReady if the client has not
+ *          enabled notifications
+ */
+bStatus_t SimpleProfile_StreamSend( uint16 connHandle, attHandleValueNoti_t *pNoti )
+{
+  uint16 value = GATTServApp_ReadCharCfg( connHandle, simpleProfileChar6Config );
+
+  // If notifications enabled
+  if ( value & GATT_CLIENT_CFG_NOTIFY )
+  {
+    // Set the handle
+    pNoti->handle = simpleProfileAttrTbl[SIMPLEPROFILE_CHAR6_VALUE_POS].handle;
+
+    // Send the notification
+    return ( GATT_Notification( connHandle, pNoti, FALSE ) );
+  }
+
+  return ( bleNotReady );
+}
+
 /*********************************************************************
  * @fn          simpleProfile_ReadAttrCB
  *
@@ -705,6 +818,32 @@ static bStatus_t simpleProfile_WriteAttrCB( uint16 connHandle, gattAttribute_t *
              
         break;
 
+      case SIMPLEPROFILE_CHAR6_UUID:
+
+        //Validate the value
+        // Make sure it's not a blob oper
+        if ( offset == 0 )
+        {
+          if ( len != SIMPLEPROFILE_CHAR6_LEN )
+          {
+            status = ATT_ERR_INVALID_VALUE_SIZE;
+          }
+        }
+        else
+        {
+          status = ATT_ERR_ATTR_NOT_LONG;
+        }
+
+        //Write the value
+        if ( status == SUCCESS )
+        {
+          VOID memcpy( pAttr->pValue, pValue, SIMPLEPROFILE_CHAR6_LEN );
+
+          notifyApp = SIMPLEPROFILE_CHAR6;
+        }
+
+        break;
+
       case GATT_CLIENT_CHAR_CFG_UUID:
         status = GATTServApp_ProcessCCCWriteReq( connHandle, pAttr, pValue, len,
                                                  offset, GATT_CLIENT_CFG_NOTIFY );
@@ -67,6 +67,7 @@ extern "C"
 #define SIMPLEPROFILE_CHAR3                   2  // RW uint8 - Profile Characteristic 3 value
 #define SIMPLEPROFILE_CHAR4                   3  // RW uint8 - Profile Characteristic 4 value
 #define SIMPLEPROFILE_CHAR5                   4  // RW uint8 - Profile Characteristic 4 value
+#define SIMPLEPROFILE_CHAR6                   5  // RW uint16 - Stream start sequence number
   
 // Simple Profile Service UUID
 #define SIMPLEPROFILE_SERV_UUID               0xFFF0
@@ -77,6 +78,7 @@ extern "C"
 #define SIMPLEPROFILE_CHAR3_UUID            0xFFF3
 #define SIMPLEPROFILE_CHAR4_UUID            0xFFF4
 #define SIMPLEPROFILE_CHAR5_UUID            0xFFF5
+#define SIMPLEPROFILE_CHAR6_UUID            0xFFF6
   
 // Simple Keys Profile Services bit fields
 #define SIMPLEPROFILE_SERVICE               0x00000001
@@ -84,6 +86,9 @@ extern "C"
 // Length of Characteristic 5 in bytes
 #define SIMPLEPROFILE_CHAR5_LEN           5  
 
+// Length of Characteristic 6 in bytes
+#define SIMPLEPROFILE_CHAR6_LEN           2
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -153,6 +158,15 @@ extern bStatus_t SimpleProfile_SetParameter( uint8 param, uint8 len, void *value
  */
 extern bStatus_t SimpleProfile_GetParameter( uint8 param, void *value );
 
+/*
+ * SimpleProfile_StreamSend - Send a notification of Characteristic 6, the
+ *          stream a client starts by writing the characteristic.
+ *
+ *    connHandle - connection handle
+ *    pNoti - pointer to notification structure
+ */
+extern bStatus_t SimpleProfile_StreamSend( uint16 connHandle, attHandleValueNoti_t *pNoti );
+
 
 /*********************************************************************
 *********************************************************************/
@@ -110,6 +110,7 @@ const pTaskEventHandlerFn tasksArr[] =
 };
 
 const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+OSAL_TASKS_ASSERT_CNT( tasksArr );
 uint16 *tasksEvents;
 
 /*********************************************************************
@@ -55,6 +55,7 @@
 #include "hal_timer.h"
 #include "hal_drivers.h"
 #include "hal_led.h"
+#include "hal_assert.h"
 
 /* OSAL */
 #include "OSAL.h"
@@ -94,7 +95,12 @@ int main(void)
   /* Initialize LL */
 
   /* Initialize the operating system */
-  osal_init_system();
+  if ( osal_init_system() != SUCCESS )
+  {
+    /* No heap for the task queues; never start the tasks without them */
+    HAL_ASSERT_FORCED();
+    while ( 1 );
+  }
 
   /* Enable interrupts */
   HAL_ENABLE_INTERRUPTS();
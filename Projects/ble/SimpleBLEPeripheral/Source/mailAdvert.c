@@ -0,0 +1,326 @@
+/******************************************************************************
+
+ @file  mailAdvert.c
+
+ @brief This file contains the advertising policy of the SmartMailBox
+        application, which steps the advertising interval down after
+        mailbox activity and goes quiet after failed connections.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "gap.h"
+
+#include "peripheral.h"
+
+#include "mailAdvert.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Policy steps
+#define MA_STEP_FAST                  0
+#define MA_STEP_MEDIUM                1
+#define MA_STEP_SLOW                  2
+#define MA_STEP_QUIET                 3   // Off after failed connections
+#define MA_STEP_OFF                   4   // Off until the next kick
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint16 interval;  // Advertising interval (units of 625us)
+  uint32 time;      // Time until the next step (ms), 0 to stay
+} maStep_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static CONST maStep_t maSteps[] =
+{
+  { MAIL_ADVERT_FAST_INT,   MAIL_ADVERT_FAST_TIME },
+  { MAIL_ADVERT_MEDIUM_INT, MAIL_ADVERT_MEDIUM_TIME },
+  { MAIL_ADVERT_SLOW_INT,   0 }
+};
+
+// Task and event for the step timer
+static uint8 maTaskId;
+static uint16 maEvent;
+
+static uint8 maStep = MA_STEP_OFF;
+
+// Failed connections in a row
+static uint8 maFails;
+
+// Last GAP Peripheral Role state and osal_GetSystemClock() on connecting
+static uint8 maState = GAPROLE_INIT;
+static uint32 maConnStart;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void maSetStep( uint8 step );
+
+/*********************************************************************
+ * @fn      maSetStep
+ *
+ * @brief   Enter a policy step: set its advertising interval and
+ *          timer, and restart advertising if it has to change.
+ *
+ * @param   step - MA_STEP_FAST to MA_STEP_OFF
+ *
+ * @return  none
+ */
+static void maSetStep( uint8 step )
+{
+  uint8 oldStep = maStep;
+  uint8 advEnabled;
+
+  maStep = step;
+
+  VOID osal_stop_timerEx( maTaskId, maEvent );
+
+  if ( step <= MA_STEP_SLOW )
+  {
+    uint16 advInt = maSteps[step].interval;
+
+    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MIN, advInt );
+    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MAX, advInt );
+    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MIN, advInt );
+    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MAX, advInt );
+
+    if ( maSteps[step].time )
+    {
+      VOID osal_start_timerEx( maTaskId, maEvent, maSteps[step].time );
+    }
+  }
+  else if ( step == MA_STEP_QUIET )
+  {
+    VOID osal_start_timerEx( maTaskId, maEvent, MAIL_ADVERT_QUIET_TIME );
+  }
+
+  GAPRole_GetParameter( GAPROLE_ADVERT_ENABLED, &advEnabled );
+
+  if ( step > MA_STEP_SLOW )
+  {
+    advEnabled = FALSE;
+  }
+  else if ( (maState == GAPROLE_ADVERTISING) && (step != oldStep) &&
+            ((oldStep > MA_STEP_SLOW) ||
+             (maSteps[step].interval != maSteps[oldStep].interval)) )
+  {
+    // The interval is only read when advertising starts; it is turned
+    // back on by mailAdvert_StateChange() once GAPROLE_WAITING is reached.
+    // Leaving QUIET or OFF before advertising has stopped restarts it too.
+    advEnabled = FALSE;
+  }
+  else
+  {
+    advEnabled = TRUE;
+  }
+
+  GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &advEnabled );
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_Init
+ *
+ * @brief   Start the policy. If the application enabled advertising,
+ *          it starts with a fast burst, otherwise it stays off until
+ *          mailAdvert_Kick().
+ *
+ * @param   taskId - task to receive the step timer event
+ * @param   event - step timer event; the task must then call
+ *                  mailAdvert_ProcessEvent()
+ *
+ * @return  none
+ */
+void mailAdvert_Init( uint8 taskId, uint16 event )
+{
+  uint8 advEnabled;
+
+  maTaskId = taskId;
+  maEvent = event;
+
+  GAPRole_GetParameter( GAPROLE_ADVERT_ENABLED, &advEnabled );
+
+  maSetStep( advEnabled ? MA_STEP_FAST : MA_STEP_OFF );
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_Kick
+ *
+ * @brief   Start a fast advertising burst after a mail event or key
+ *          press, also ending a quiet period.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailAdvert_Kick( void )
+{
+  maFails = 0;
+
+  maSetStep( MA_STEP_FAST );
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_Suspend
+ *
+ * @brief   Stop advertising until the next mailAdvert_Kick().
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailAdvert_Suspend( void )
+{
+  maSetStep( MA_STEP_OFF );
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_Enabled
+ *
+ * @brief   Check whether the policy has advertising enabled.
+ *
+ * @param   none
+ *
+ * @return  TRUE unless quiet or suspended, FALSE otherwise
+ */
+uint8 mailAdvert_Enabled( void )
+{
+  return ( maStep <= MA_STEP_SLOW );
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_StateChange
+ *
+ * @brief   Follow a GAP Peripheral Role state change: count failed
+ *          connections, and turn advertising back on in the waiting
+ *          state unless quiet or suspended.
+ *
+ * @param   newState - new gaprole_States_t
+ *
+ * @return  none
+ */
+void mailAdvert_StateChange( uint8 newState )
+{
+  uint8 oldState = maState;
+
+  maState = newState;
+
+  switch ( newState )
+  {
+    case GAPROLE_CONNECTED:
+      if ( oldState != GAPROLE_CONNECTED_ADV )
+      {
+        maConnStart = osal_GetSystemClock();
+      }
+      break;
+
+    case GAPROLE_WAITING:
+    case GAPROLE_WAITING_AFTER_TIMEOUT:
+      if ( (oldState == GAPROLE_CONNECTED) || (oldState == GAPROLE_CONNECTED_ADV) )
+      {
+        if ( (newState == GAPROLE_WAITING_AFTER_TIMEOUT) ||
+             ((osal_GetSystemClock() - maConnStart) < MAIL_ADVERT_MIN_CONN_TIME) )
+        {
+          if ( (maStep <= MA_STEP_SLOW) && (++maFails >= MAIL_ADVERT_MAX_FAILS) )
+          {
+            maFails = 0;
+
+            maSetStep( MA_STEP_QUIET );
+          }
+        }
+        else
+        {
+          maFails = 0;
+        }
+      }
+
+      if ( maStep <= MA_STEP_SLOW )
+      {
+        uint8 advEnabled = TRUE;
+
+        GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &advEnabled );
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*********************************************************************
+ * @fn      mailAdvert_ProcessEvent
+ *
+ * @brief   Step the advertising interval back when the step timer
+ *          expires, or resume at the slow interval after a quiet
+ *          period.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailAdvert_ProcessEvent( void )
+{
+  if ( maStep < MA_STEP_SLOW )
+  {
+    maSetStep( maStep + 1 );
+  }
+  else if ( maStep == MA_STEP_QUIET )
+  {
+    maSetStep( MA_STEP_SLOW );
+  }
+}
+
+/*********************************************************************
+*********************************************************************/
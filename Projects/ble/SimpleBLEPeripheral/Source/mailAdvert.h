@@ -0,0 +1,161 @@
+/******************************************************************************
+
+ @file  mailAdvert.h
+
+ @brief This file contains the mailbox advertising policy definitions
+        and prototypes.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+#ifndef MAILADVERT_H
+#define MAILADVERT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * The advertising interval follows the mailbox instead of staying at a
+ * fixed fast rate. A mail event or key press (mailAdvert_Kick()) starts
+ * a burst at MAIL_ADVERT_FAST_INT, which steps back to
+ * MAIL_ADVERT_MEDIUM_INT and then to MAIL_ADVERT_SLOW_INT for as long as
+ * nothing happens. After MAIL_ADVERT_MAX_FAILS connections in a row that
+ * were lost to a supervision timeout or lasted less than
+ * MAIL_ADVERT_MIN_CONN_TIME, advertising stops for MAIL_ADVERT_QUIET_TIME
+ * and then resumes at the slow interval.
+ *
+ * The interval only takes effect when advertising starts, so a step
+ * turns advertising off and back on from the GAPROLE_WAITING state. The
+ * application passes every GAP Role state change to
+ * mailAdvert_StateChange() and must not enable advertising itself.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Advertising intervals (units of 625us) and how long the fast and
+// medium steps last (ms). The slow step lasts until the next kick.
+#if !defined MAIL_ADVERT_FAST_INT
+#define MAIL_ADVERT_FAST_INT          48    // 30ms
+#endif
+
+#if !defined MAIL_ADVERT_FAST_TIME
+#define MAIL_ADVERT_FAST_TIME         30000
+#endif
+
+#if !defined MAIL_ADVERT_MEDIUM_INT
+#define MAIL_ADVERT_MEDIUM_INT        338   // 211.25ms
+#endif
+
+#if !defined MAIL_ADVERT_MEDIUM_TIME
+#define MAIL_ADVERT_MEDIUM_TIME       90000
+#endif
+
+#if !defined MAIL_ADVERT_SLOW_INT
+#define MAIL_ADVERT_SLOW_INT          1636  // 1022.5ms
+#endif
+
+// Failed connections in a row before advertising goes quiet
+#if !defined MAIL_ADVERT_MAX_FAILS
+#define MAIL_ADVERT_MAX_FAILS         3
+#endif
+
+// Shortest connection that does not count as failed (ms)
+#if !defined MAIL_ADVERT_MIN_CONN_TIME
+#define MAIL_ADVERT_MIN_CONN_TIME     1000
+#endif
+
+// How long advertising stays off once quiet (ms)
+#if !defined MAIL_ADVERT_QUIET_TIME
+#define MAIL_ADVERT_QUIET_TIME        600000
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Set up the fast advertising interval. The step timer sets 'event' for
+ * task 'taskId', which must then call mailAdvert_ProcessEvent().
+ */
+extern void mailAdvert_Init( uint8 taskId, uint16 event );
+
+/*
+ * Start a fast advertising burst after a mail event or key press.
+ */
+extern void mailAdvert_Kick( void );
+
+/*
+ * Stop advertising until the next mailAdvert_Kick().
+ */
+extern void mailAdvert_Suspend( void );
+
+/*
+ * TRUE while advertising is enabled by the policy.
+ */
+extern uint8 mailAdvert_Enabled( void );
+
+/*
+ * Follow a GAP Peripheral Role state change (gaprole_States_t).
+ */
+extern void mailAdvert_StateChange( uint8 newState );
+
+/*
+ * Move on to the next step when the step timer expires.
+ */
+extern void mailAdvert_ProcessEvent( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILADVERT_H */
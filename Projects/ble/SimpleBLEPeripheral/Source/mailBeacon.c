@@ -0,0 +1,278 @@
+/******************************************************************************
+
+ @file  mailBeacon.c
+
+ @brief This file keeps the mailbox state in the advertising data of
+        the SmartMailBox application, for gateways that scan passively.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "gap.h"
+#include "hal_adc.h"
+
+#include "peripheral.h"
+
+#include "mailJournal.h"
+#include "mailSensor.h"
+#include "mailBeacon.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Offsets of the fields after the company identifier
+#define MB_FORMAT                     0
+#define MB_COUNT                      1
+#define MB_AGE                        2
+#define MB_BATT                       4
+#define MB_SEQ                        5
+#define MB_FIELDS_LEN                 7
+
+// VDD/3 readings at 3.0V and 2.0V with the 1.25V reference at 10 bits,
+// as in battservice.c
+#define MB_ADC_LEVEL_3V               409
+#define MB_ADC_LEVEL_2V               273
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Task and event for the refresh timer
+static uint8 mbTaskId;
+static uint16 mbEvent;
+
+// Advertising data and the fields in it, NULL if there are none
+static uint8 *mbAdvData;
+static uint8 mbAdvLen;
+static uint8 *mbFields;
+
+// Fields last handed to the GAP Role
+static uint8 mbSent[MB_FIELDS_LEN];
+
+// Battery level (%) and refreshes until the next measurement
+static uint8 mbBatt = 0xFF;
+static uint8 mbBattWait;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 mbReadBattery( void );
+
+/*********************************************************************
+ * @fn      mbReadBattery
+ *
+ * @brief   Measure the battery level, with the same scale as the
+ *          Battery Service: 0% at 2.0V and 100% at 3.0V.
+ *
+ * @param   none
+ *
+ * @return  Battery level (%), 0xFF without an ADC.
+ */
+static uint8 mbReadBattery( void )
+{
+#if (defined HAL_ADC) && (HAL_ADC == TRUE)
+  uint16 adc;
+
+  HalAdcSetReference( HAL_ADC_REF_125V );
+  adc = HalAdcRead( HAL_ADC_CHANNEL_VDD, HAL_ADC_RESOLUTION_10 );
+
+  if ( adc >= MB_ADC_LEVEL_3V )
+  {
+    return ( 100 );
+  }
+
+  if ( adc <= MB_ADC_LEVEL_2V )
+  {
+    return ( 0 );
+  }
+
+  return ( (uint8)(((uint32)(adc - MB_ADC_LEVEL_2V) * 100) /
+                   (MB_ADC_LEVEL_3V - MB_ADC_LEVEL_2V)) );
+#else
+  return ( 0xFF );
+#endif
+}
+
+/*********************************************************************
+ * @fn      mailBeacon_Init
+ *
+ * @brief   Find the mailbox AD structure in the advertising data, hand
+ *          the advertising data with the current state to the GAP
+ *          Role, and start the refresh timer.
+ *
+ * @param   taskId - task to receive the refresh timer event
+ * @param   event - refresh timer event; the task must then call
+ *                  mailBeacon_ProcessEvent()
+ * @param   pAdvData - advertising data, which is updated in place
+ * @param   len - length of the advertising data
+ *
+ * @return  none
+ */
+void mailBeacon_Init( uint8 taskId, uint16 event, uint8 *pAdvData, uint8 len )
+{
+  uint8 idx = 0;
+
+  mbTaskId = taskId;
+  mbEvent = event;
+
+  mbAdvData = pAdvData;
+  mbAdvLen = len;
+  mbFields = NULL;
+
+  // Walk the AD structures: length, type, data
+  while ( (idx + 1 < len) && (pAdvData[idx] != 0) )
+  {
+    if ( (pAdvData[idx] == MAIL_BEACON_AD_LEN) &&
+         (idx + 1 + MAIL_BEACON_AD_LEN <= len) &&
+         (pAdvData[idx + 1] == GAP_ADTYPE_MANUFACTURER_SPECIFIC) &&
+         (pAdvData[idx + 2] == LO_UINT16( MAIL_BEACON_COMPANY_ID )) &&
+         (pAdvData[idx + 3] == HI_UINT16( MAIL_BEACON_COMPANY_ID )) &&
+         (pAdvData[idx + 4] == MAIL_BEACON_FORMAT) )
+    {
+      mbFields = &pAdvData[idx + 4];
+      break;
+    }
+
+    idx += pAdvData[idx] + 1;
+  }
+
+  if ( mbFields != NULL )
+  {
+    mbBatt = mbReadBattery();
+    mbBattWait = MAIL_BEACON_BATT_REFRESH;
+
+    // Make sure the first update goes out
+    mbSent[MB_FORMAT] = ~MAIL_BEACON_FORMAT;
+    mailBeacon_Update();
+
+    VOID osal_start_reload_timer( mbTaskId, mbEvent, MAIL_BEACON_AGE_UNIT );
+  }
+}
+
+/*********************************************************************
+ * @fn      mailBeacon_Update
+ *
+ * @brief   Refresh the fields from the mail sensor and journal, and
+ *          hand the advertising data to the GAP Role if one of them
+ *          changed. The GAP Role starts advertising once new advertising
+ *          data is set, so while connected the update waits for the
+ *          link to end.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailBeacon_Update( void )
+{
+  uint32 age;
+  uint16 seq;
+  uint8 state;
+
+  if ( mbFields == NULL )
+  {
+    return;
+  }
+
+  age = mailSensor_LastEventAge();
+
+  if ( age != MAIL_SENSOR_AGE_UNKNOWN )
+  {
+    age /= MAIL_BEACON_AGE_UNIT / 1000;
+  }
+
+  if ( age > 0xFFFF )
+  {
+    age = 0xFFFF;
+  }
+
+  seq = mailJournal_LastSeq();
+
+  mbFields[MB_COUNT] = mailSensor_MailCount();
+  mbFields[MB_AGE] = LO_UINT16( (uint16)age );
+  mbFields[MB_AGE + 1] = HI_UINT16( (uint16)age );
+  mbFields[MB_BATT] = mbBatt;
+  mbFields[MB_SEQ] = LO_UINT16( seq );
+  mbFields[MB_SEQ + 1] = HI_UINT16( seq );
+
+  if ( osal_memcmp( mbFields, mbSent, MB_FIELDS_LEN ) )
+  {
+    return;
+  }
+
+  GAPRole_GetParameter( GAPROLE_STATE, &state );
+
+  if ( (state != GAPROLE_CONNECTED) && (state != GAPROLE_CONNECTED_ADV) &&
+       (GAPRole_SetParameter( GAPROLE_ADVERT_DATA, mbAdvLen, mbAdvData ) == SUCCESS) )
+  {
+    VOID osal_memcpy( mbSent, mbFields, MB_FIELDS_LEN );
+  }
+}
+
+/*********************************************************************
+ * @fn      mailBeacon_ProcessEvent
+ *
+ * @brief   Refresh the event age, and the battery level every
+ *          MAIL_BEACON_BATT_REFRESH refreshes.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailBeacon_ProcessEvent( void )
+{
+  if ( --mbBattWait == 0 )
+  {
+    mbBatt = mbReadBattery();
+    mbBattWait = MAIL_BEACON_BATT_REFRESH;
+  }
+
+  mailBeacon_Update();
+}
+
+/*********************************************************************
+*********************************************************************/
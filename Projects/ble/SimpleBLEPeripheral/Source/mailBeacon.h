@@ -0,0 +1,142 @@
+/******************************************************************************
+
+ @file  mailBeacon.h
+
+ @brief This file contains the definitions and prototypes of the mailbox
+        state carried in the advertising data.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+#ifndef MAILBEACON_H
+#define MAILBEACON_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * The advertising data carries a manufacturer specific AD structure with
+ * the state of the mailbox, so that a gateway can follow many mailboxes
+ * by passive scanning, without connecting:
+ *
+ *   0-1  company identifier, MAIL_BEACON_COMPANY_ID
+ *   2    MAIL_BEACON_FORMAT
+ *   3    mail drops since the door was last opened
+ *   4-5  minutes since the last lid or door event, 0xFFFF if unknown
+ *   6    battery level (%), 0xFF if unknown
+ *   7-8  sequence number of the last event in the mail journal
+ *
+ * Multi-byte fields are little endian. The application lists the
+ * structure in its advertising data with MAIL_BEACON_AD_LEN and
+ * GAP_ADTYPE_MANUFACTURER_SPECIFIC, followed by MAIL_BEACON_AD_INIT.
+ * The fields are refreshed every MAIL_BEACON_AGE_UNIT ms and after every
+ * mailbox event, and the advertising data is only rewritten when one of
+ * them changed. Changes made while connected go out after the link ends.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Company identifier: Texas Instruments Inc. (13)
+#if !defined MAIL_BEACON_COMPANY_ID
+#define MAIL_BEACON_COMPANY_ID        0x000D
+#endif
+
+// Layout of the fields after the company identifier
+#define MAIL_BEACON_FORMAT            0x01
+
+// Length byte of the AD structure: type, company identifier and fields
+#define MAIL_BEACON_AD_LEN            10
+
+// Initial content of the AD structure after the type
+#define MAIL_BEACON_AD_INIT           LO_UINT16( MAIL_BEACON_COMPANY_ID ), \
+                                      HI_UINT16( MAIL_BEACON_COMPANY_ID ), \
+                                      MAIL_BEACON_FORMAT,                  \
+                                      0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00
+
+// Unit of the event age and refresh period (ms)
+#if !defined MAIL_BEACON_AGE_UNIT
+#define MAIL_BEACON_AGE_UNIT          60000
+#endif
+
+// Refreshes between battery measurements
+#if !defined MAIL_BEACON_BATT_REFRESH
+#define MAIL_BEACON_BATT_REFRESH      60
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Find the mailbox AD structure in the advertising data, which the
+ * GAP Role gets from here on, and start the refresh timer, which sets
+ * 'event' for task 'taskId', which must then call
+ * mailBeacon_ProcessEvent().
+ */
+extern void mailBeacon_Init( uint8 taskId, uint16 event, uint8 *pAdvData, uint8 len );
+
+/*
+ * Refresh the fields, and the advertising data if one changed.
+ */
+extern void mailBeacon_Update( void );
+
+/*
+ * Refresh on the timer, measuring the battery now and then.
+ */
+extern void mailBeacon_ProcessEvent( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILBEACON_H */
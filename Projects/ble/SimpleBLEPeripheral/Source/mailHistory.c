@@ -0,0 +1,308 @@
+/******************************************************************************
+
+ @file  mailHistory.c
+
+ @brief This file streams the mail journal of the SmartMailBox
+        application to a client, packed into MTU sized notifications.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "linkdb.h"
+#include "gatt.h"
+#include "gattservapp.h"
+
+#include "simpleGATTprofile.h"
+
+#include "mailJournal.h"
+#include "mailHistory.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Task and event to send more on
+static uint8 mhTaskId;
+static uint16 mhEvent;
+
+// Link streamed to, INVALID_CONNHANDLE when there is no stream
+static uint16 mhConnHandle = INVALID_CONNHANDLE;
+
+// Sequence numbers of the last event sent and of the last one packed
+static uint16 mhSent;
+static uint16 mhPacked;
+
+// Events read from the journal and not packed yet, and the sequence
+// number of the last one read
+static mailEvt_t mhBuf[MAIL_HISTORY_CHUNK];
+static uint8 mhBufIdx;
+static uint8 mhBufCnt;
+static uint16 mhRead;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 mhPack( uint8 *pBuf, uint8 maxLen );
+static void mhRewind( void );
+static void mhPump( void );
+
+/*********************************************************************
+ * @fn      mhPack
+ *
+ * @brief   Pack the next events into a notification, reading them from
+ *          the journal MAIL_HISTORY_CHUNK at a time.
+ *
+ * @param   pBuf - notification value
+ * @param   maxLen - room in the notification value
+ *
+ * @return  Length packed, 0 if there are no more events.
+ */
+static uint8 mhPack( uint8 *pBuf, uint8 maxLen )
+{
+  uint8 len = 0;
+
+  while ( (len + MAIL_HISTORY_REC_LEN) <= maxLen )
+  {
+    mailEvt_t *pEvt;
+
+    if ( mhBufIdx == mhBufCnt )
+    {
+      mhBufIdx = 0;
+      mhBufCnt = mailJournal_Read( mhRead, mhBuf, MAIL_HISTORY_CHUNK );
+      if ( mhBufCnt == 0 )
+      {
+        break;
+      }
+
+      mhRead = mhBuf[mhBufCnt - 1].seq;
+    }
+
+    pEvt = &mhBuf[mhBufIdx++];
+
+    pBuf[len++] = LO_UINT16( pEvt->seq );
+    pBuf[len++] = HI_UINT16( pEvt->seq );
+    pBuf[len++] = pEvt->type;
+    pBuf[len++] = pEvt->data;
+    pBuf[len++] = BREAK_UINT32( pEvt->time, 0 );
+    pBuf[len++] = BREAK_UINT32( pEvt->time, 1 );
+    pBuf[len++] = BREAK_UINT32( pEvt->time, 2 );
+    pBuf[len++] = BREAK_UINT32( pEvt->time, 3 );
+
+    mhPacked = pEvt->seq;
+  }
+
+  return ( len );
+}
+
+/*********************************************************************
+ * @fn      mhRewind
+ *
+ * @brief   Go back to the event after the last one sent, for the next
+ *          notification to start from.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void mhRewind( void )
+{
+  mhRead = mhSent;
+  mhPacked = mhSent;
+  mhBufIdx = 0;
+  mhBufCnt = 0;
+}
+
+/*********************************************************************
+ * @fn      mhPump
+ *
+ * @brief   Send notifications until the stream ends or the link layer
+ *          has no buffers left.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void mhPump( void )
+{
+  while ( mhConnHandle != INVALID_CONNHANDLE )
+  {
+    attHandleValueNoti_t noti;
+    uint16 len;
+    uint8 bufIdx = mhBufIdx;
+    uint8 bufCnt = mhBufCnt;
+    uint16 read = mhRead;
+    bStatus_t status;
+
+    noti.pValue = (uint8 *)GATT_bm_alloc( mhConnHandle, ATT_HANDLE_VALUE_NOTI,
+                                          GATT_MAX_MTU, &len );
+    if ( noti.pValue == NULL )
+    {
+      // Wait for the next connection event
+      return;
+    }
+
+    noti.len = mhPack( noti.pValue, (uint8)MIN( len, 0xFF ) );
+
+    status = SimpleProfile_StreamSend( mhConnHandle, &noti );
+    if ( status == SUCCESS )
+    {
+      if ( noti.len == 0 )
+      {
+        // End of stream sent
+        mailHistory_Stop();
+      }
+      else
+      {
+        mhSent = mhPacked;
+      }
+    }
+    else
+    {
+      GATT_bm_free( (gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI );
+
+      if ( (status != MSG_BUFFER_NOT_AVAIL) && (status != bleNoResources) &&
+           (status != bleMemAllocError) )
+      {
+        // Notifications turned off or link gone
+        mailHistory_Stop();
+      }
+      else if ( (mhRead == read) && (mhBufCnt == bufCnt) )
+      {
+        // Pack the same events again at the next connection event
+        mhBufIdx = bufIdx;
+        mhPacked = mhSent;
+      }
+      else
+      {
+        // Some of them are no longer in mhBuf
+        mhRewind();
+      }
+
+      return;
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      mailHistory_Init
+ *
+ * @brief   Set the task and event the notification queue sends after
+ *          each connection event of a link streamed to.
+ *
+ * @param   taskId - task passed to GATTServApp_InitNotiQ()
+ * @param   event - event passed to GATTServApp_InitNotiQ(); the task
+ *                  must then call mailHistory_ProcessEvent()
+ *
+ * @return  none
+ */
+void mailHistory_Init( uint8 taskId, uint16 event )
+{
+  mhTaskId = taskId;
+  mhEvent = event;
+}
+
+/*********************************************************************
+ * @fn      mailHistory_Start
+ *
+ * @brief   Stream the events from a sequence number on, ending any
+ *          stream in progress. Events older than the journal start
+ *          from its oldest event.
+ *
+ * @param   connHandle - link to stream to
+ * @param   startSeq - sequence number of the first event to send
+ *
+ * @return  none
+ */
+void mailHistory_Start( uint16 connHandle, uint16 startSeq )
+{
+  mailHistory_Stop();
+
+  mhConnHandle = connHandle;
+  mhSent = startSeq - 1;
+  mhRewind();
+
+  // Get the connection event of the link while streaming
+  GATTServApp_HoldNotiQ( connHandle, TRUE );
+
+  VOID osal_set_event( mhTaskId, mhEvent );
+}
+
+/*********************************************************************
+ * @fn      mailHistory_Stop
+ *
+ * @brief   End the stream in progress, if any.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailHistory_Stop( void )
+{
+  if ( mhConnHandle != INVALID_CONNHANDLE )
+  {
+    GATTServApp_HoldNotiQ( mhConnHandle, FALSE );
+
+    mhConnHandle = INVALID_CONNHANDLE;
+  }
+}
+
+/*********************************************************************
+ * @fn      mailHistory_ProcessEvent
+ *
+ * @brief   Send more of the stream after a connection event.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailHistory_ProcessEvent( void )
+{
+  mhPump();
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,126 @@
+/******************************************************************************
+
+ @file  mailHistory.h
+
+ @brief This file contains the definitions and prototypes of the mail
+        journal stream over the Simple GATT Profile.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+#ifndef MAILHISTORY_H
+#define MAILHISTORY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * A client reads the mail journal through Characteristic 6 of the Simple
+ * GATT Profile: it enables notifications, then writes the sequence number
+ * to start from. The events from that number on follow as notifications,
+ * each packed with as many records as fit in ATT_MTU - 3 bytes, so a
+ * client that exchanged a larger ATT MTU gets more records per
+ * notification. An empty notification ends the stream. A record is
+ * MAIL_HISTORY_REC_LEN bytes, little endian:
+ *
+ *   0-1  sequence number
+ *   2    type, MAIL_EVT_OPEN, MAIL_EVT_CLOSE or MAIL_EVT_DROP
+ *   3    event specific data
+ *   4-7  osal_getClock() when the event was logged
+ *
+ * Notifications are sent until the link layer has no buffers left, then
+ * again after each connection event, on the event the application passed
+ * to GATTServApp_InitNotiQ().
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Length of a record in a notification
+#define MAIL_HISTORY_REC_LEN          8
+
+// Events read from the journal at a time
+#if !defined MAIL_HISTORY_CHUNK
+#define MAIL_HISTORY_CHUNK            8
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Set the connection event of the notification queue, which the task
+ * 'taskId' gets as 'event' and must then call mailHistory_ProcessEvent().
+ */
+extern void mailHistory_Init( uint8 taskId, uint16 event );
+
+/*
+ * Stream the events from 'startSeq' on to a link, ending any stream
+ * in progress.
+ */
+extern void mailHistory_Start( uint16 connHandle, uint16 startSeq );
+
+/*
+ * End the stream in progress.
+ */
+extern void mailHistory_Stop( void );
+
+/*
+ * Send more of the stream after a connection event.
+ */
+extern void mailHistory_ProcessEvent( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILHISTORY_H */
@@ -0,0 +1,410 @@
+/******************************************************************************
+
+ @file  mailJournal.c
+
+ @brief This file contains the mail event journal of the SmartMailBox
+        application, kept in SNV.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+
+#include "mailJournal.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+#define MJ_NVID( blk )            ((osalSnvId_t)(MAIL_JOURNAL_NVID_START + (blk)))
+
+// TRUE if sequence number 'a' comes after 'b'
+#define MJ_SEQ_AFTER( a, b )      ((int16)((uint16)(a) - (uint16)(b)) > 0)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Task and event for the commit timer
+static uint8 mjTaskId;
+static uint16 mjEvent;
+
+// Commit policy
+static uint8 mjBatch = MAIL_JOURNAL_BATCH;
+static uint32 mjDelay = MAIL_JOURNAL_DELAY;
+
+// Events waiting for a commit
+static mailEvt_t mjPending[MAIL_JOURNAL_RAM_EVTS];
+static uint8 mjPendHead;
+static uint8 mjPendCnt;
+
+// Block being filled and the number of events committed to it
+static uint8 mjBlk;
+static uint8 mjBlkCnt;
+
+static uint16 mjLastSeq;
+
+// Block image for SNV reads and writes
+static mailEvt_t mjBuf[MAIL_JOURNAL_BLOCK_EVTS];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 mjReadBlock( uint8 blk );
+
+/*********************************************************************
+ * @fn      mjReadBlock
+ *
+ * @brief   Read a journal block into mjBuf.
+ *
+ * @param   blk - block number
+ *
+ * @return  Number of events in the block, 0 if it was never written.
+ */
+static uint8 mjReadBlock( uint8 blk )
+{
+  uint8 cnt;
+
+  if ( osal_snv_read( MJ_NVID( blk ), sizeof( mjBuf ), mjBuf ) != SUCCESS )
+  {
+    return ( 0 );
+  }
+
+  for ( cnt = 0; cnt < MAIL_JOURNAL_BLOCK_EVTS; cnt++ )
+  {
+    if ( mjBuf[cnt].type == MAIL_EVT_NONE )
+    {
+      break;
+    }
+  }
+
+  return ( cnt );
+}
+
+/*********************************************************************
+ * @fn      mailJournal_Init
+ *
+ * @brief   Load the journal from SNV: the block holding the newest
+ *          event is the one to continue filling.
+ *
+ * @param   taskId - task to receive the commit timer event
+ * @param   event - commit timer event; the task must then call
+ *                  mailJournal_Commit()
+ *
+ * @return  none
+ */
+void mailJournal_Init( uint8 taskId, uint16 event )
+{
+  uint8 found = FALSE;
+  uint8 blk;
+
+  mjTaskId = taskId;
+  mjEvent = event;
+
+  mjPendHead = 0;
+  mjPendCnt = 0;
+  mjBlk = 0;
+  mjBlkCnt = 0;
+  mjLastSeq = 0;
+
+  for ( blk = 0; blk < MAIL_JOURNAL_NV_BLOCKS; blk++ )
+  {
+    uint8 cnt = mjReadBlock( blk );
+
+    if ( cnt != 0 )
+    {
+      uint16 seq = mjBuf[cnt-1].seq;
+
+      if ( !found || MJ_SEQ_AFTER( seq, mjLastSeq ) )
+      {
+        found = TRUE;
+        mjLastSeq = seq;
+        mjBlk = blk;
+        mjBlkCnt = cnt;
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      mailJournal_SetCommitPolicy
+ *
+ * @brief   Set when pending events are committed to SNV.
+ *
+ * @param   batch - pending events that trigger a commit, 1 commits
+ *                  every event
+ * @param   delay - longest time an event waits in RAM (ms), 0 to
+ *                  commit on 'batch' only
+ *
+ * @return  none
+ */
+void mailJournal_SetCommitPolicy( uint8 batch, uint32 delay )
+{
+  if ( batch == 0 )
+  {
+    batch = 1;
+  }
+  else if ( batch > MAIL_JOURNAL_RAM_EVTS )
+  {
+    batch = MAIL_JOURNAL_RAM_EVTS;
+  }
+
+  mjBatch = batch;
+  mjDelay = delay;
+
+  if ( mjPendCnt >= mjBatch )
+  {
+    VOID mailJournal_Commit();
+  }
+  else if ( mjPendCnt != 0 )
+  {
+    if ( mjDelay != 0 )
+    {
+      VOID osal_start_timerEx( mjTaskId, mjEvent, mjDelay );
+    }
+    else
+    {
+      VOID osal_stop_timerEx( mjTaskId, mjEvent );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      mailJournal_Log
+ *
+ * @brief   Append an event to the journal. It is committed according
+ *          to the commit policy; if events cannot be committed and RAM
+ *          is full, the oldest pending event is dropped.
+ *
+ * @param   type - MAIL_EVT_OPEN, MAIL_EVT_CLOSE or MAIL_EVT_DROP
+ * @param   data - event specific data
+ *
+ * @return  Sequence number of the event.
+ */
+uint16 mailJournal_Log( uint8 type, uint8 data )
+{
+  mailEvt_t *pEvt;
+
+  if ( mjPendCnt == MAIL_JOURNAL_RAM_EVTS )
+  {
+    VOID mailJournal_Commit();
+
+    if ( mjPendCnt == MAIL_JOURNAL_RAM_EVTS )
+    {
+      mjPendHead = (mjPendHead + 1) % MAIL_JOURNAL_RAM_EVTS;
+      mjPendCnt--;
+    }
+  }
+
+  pEvt = &mjPending[(mjPendHead + mjPendCnt) % MAIL_JOURNAL_RAM_EVTS];
+  pEvt->seq = ++mjLastSeq;
+  pEvt->type = type;
+  pEvt->data = data;
+  pEvt->time = osal_getClock();
+
+  if ( ++mjPendCnt >= mjBatch )
+  {
+    VOID mailJournal_Commit();
+  }
+  else if ( (mjPendCnt == 1) && (mjDelay != 0) )
+  {
+    VOID osal_start_timerEx( mjTaskId, mjEvent, mjDelay );
+  }
+
+  return ( mjLastSeq );
+}
+
+/*********************************************************************
+ * @fn      mailJournal_Commit
+ *
+ * @brief   Commit the pending events to SNV, adding them to the current
+ *          block and moving on to the next block in the ring when it is
+ *          full. On failure the remaining events stay pending and the
+ *          commit is retried after the commit delay.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS or NV_OPER_FAILED
+ */
+uint8 mailJournal_Commit( void )
+{
+  while ( mjPendCnt != 0 )
+  {
+    uint8 blk = mjBlk;
+    uint8 cnt = mjBlkCnt;
+    uint8 num;
+
+    if ( cnt == MAIL_JOURNAL_BLOCK_EVTS )
+    {
+      blk = (blk + 1) % MAIL_JOURNAL_NV_BLOCKS;
+      cnt = 0;
+    }
+
+    if ( (cnt == 0) || (mjReadBlock( blk ) < cnt) )
+    {
+      VOID osal_memset( mjBuf, 0, sizeof( mjBuf ) );
+      cnt = 0;
+    }
+
+    for ( num = 0; ((cnt + num) < MAIL_JOURNAL_BLOCK_EVTS) && (num < mjPendCnt); num++ )
+    {
+      mjBuf[cnt + num] = mjPending[(mjPendHead + num) % MAIL_JOURNAL_RAM_EVTS];
+    }
+
+    if ( osal_snv_write( MJ_NVID( blk ), sizeof( mjBuf ), mjBuf ) != SUCCESS )
+    {
+      if ( mjDelay != 0 )
+      {
+        VOID osal_start_timerEx( mjTaskId, mjEvent, mjDelay );
+      }
+
+      return ( NV_OPER_FAILED );
+    }
+
+    mjPendHead = (mjPendHead + num) % MAIL_JOURNAL_RAM_EVTS;
+    mjPendCnt -= num;
+    mjBlk = blk;
+    mjBlkCnt = cnt + num;
+  }
+
+  VOID osal_stop_timerEx( mjTaskId, mjEvent );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      mailJournal_Read
+ *
+ * @brief   Copy events logged after a sequence number, oldest first,
+ *          from SNV and then from the pending events. Pass the last
+ *          sequence number returned to continue reading.
+ *
+ * @param   sinceSeq - sequence number to read after; use
+ *                     mailJournal_FirstSeq() - 1 to read all events
+ * @param   pBuf - where to copy the events
+ * @param   maxCnt - most events to copy
+ *
+ * @return  Number of events copied.
+ */
+uint8 mailJournal_Read( uint16 sinceSeq, mailEvt_t *pBuf, uint8 maxCnt )
+{
+  uint8 num = 0;
+  uint8 idx;
+
+  for ( idx = 1; (idx <= MAIL_JOURNAL_NV_BLOCKS) && (num < maxCnt); idx++ )
+  {
+    uint8 cnt = mjReadBlock( (mjBlk + idx) % MAIL_JOURNAL_NV_BLOCKS );
+    uint8 evt;
+
+    for ( evt = 0; (evt < cnt) && (num < maxCnt); evt++ )
+    {
+      if ( MJ_SEQ_AFTER( mjBuf[evt].seq, sinceSeq ) )
+      {
+        pBuf[num++] = mjBuf[evt];
+      }
+    }
+  }
+
+  for ( idx = 0; (idx < mjPendCnt) && (num < maxCnt); idx++ )
+  {
+    mailEvt_t *pEvt = &mjPending[(mjPendHead + idx) % MAIL_JOURNAL_RAM_EVTS];
+
+    if ( MJ_SEQ_AFTER( pEvt->seq, sinceSeq ) )
+    {
+      pBuf[num++] = *pEvt;
+    }
+  }
+
+  return ( num );
+}
+
+/*********************************************************************
+ * @fn      mailJournal_FirstSeq
+ *
+ * @brief   Get the sequence number of the oldest event in the journal.
+ *
+ * @param   none
+ *
+ * @return  Oldest sequence number, or mailJournal_LastSeq() + 1 if the
+ *          journal is empty.
+ */
+uint16 mailJournal_FirstSeq( void )
+{
+  uint8 idx;
+
+  for ( idx = 1; idx <= MAIL_JOURNAL_NV_BLOCKS; idx++ )
+  {
+    if ( mjReadBlock( (mjBlk + idx) % MAIL_JOURNAL_NV_BLOCKS ) != 0 )
+    {
+      return ( mjBuf[0].seq );
+    }
+  }
+
+  if ( mjPendCnt != 0 )
+  {
+    return ( mjPending[mjPendHead].seq );
+  }
+
+  return ( mjLastSeq + 1 );
+}
+
+/*********************************************************************
+ * @fn      mailJournal_LastSeq
+ *
+ * @brief   Get the sequence number of the last event logged.
+ *
+ * @param   none
+ *
+ * @return  Last sequence number, 0 if no event was ever logged.
+ */
+uint16 mailJournal_LastSeq( void )
+{
+  return ( mjLastSeq );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,179 @@
+/******************************************************************************
+
+ @file  mailJournal.h
+
+ @brief This file contains the mail event journal definitions and
+        prototypes.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+#ifndef MAILJOURNAL_H
+#define MAILJOURNAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * The journal records mailbox events with a sequence number and the OSAL
+ * clock. Events are collected in RAM and committed to SNV in blocks of
+ * MAIL_JOURNAL_BLOCK_EVTS, kept in a ring of MAIL_JOURNAL_NV_BLOCKS items
+ * from MAIL_JOURNAL_NVID_START, so the oldest block is overwritten once
+ * the ring is full.
+ *
+ * A commit happens once 'batch' events are pending, or 'delay' ms after
+ * the first pending event (see mailJournal_SetCommitPolicy()). Larger
+ * batches and delays mean fewer flash writes and less energy, at the
+ * cost of losing more events on a reset. Each commit rewrites the
+ * current block, so a batch of MAIL_JOURNAL_BLOCK_EVTS costs about the
+ * same flash as a single event.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+#include "OSAL_Clock.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Mail event types
+#define MAIL_EVT_NONE                 0x00  // Unused journal slot
+#define MAIL_EVT_OPEN                 0x01  // Mailbox door opened
+#define MAIL_EVT_CLOSE                0x02  // Mailbox door closed
+#define MAIL_EVT_DROP                 0x03  // Mail dropped through the slot
+
+// First SNV item used by the journal
+#if !defined MAIL_JOURNAL_NVID_START
+#define MAIL_JOURNAL_NVID_START       BLE_NVID_CUST_START
+#endif
+
+// Number of SNV items in the journal ring
+#if !defined MAIL_JOURNAL_NV_BLOCKS
+#define MAIL_JOURNAL_NV_BLOCKS        8
+#endif
+
+// Events per SNV item
+#if !defined MAIL_JOURNAL_BLOCK_EVTS
+#define MAIL_JOURNAL_BLOCK_EVTS       8
+#endif
+
+// Events that can wait in RAM for a commit
+#if !defined MAIL_JOURNAL_RAM_EVTS
+#define MAIL_JOURNAL_RAM_EVTS         16
+#endif
+
+// Default commit policy: pending events that trigger a commit, and the
+// longest an event waits in RAM (ms, 0 to commit on batch only)
+#if !defined MAIL_JOURNAL_BATCH
+#define MAIL_JOURNAL_BATCH            8
+#endif
+
+#if !defined MAIL_JOURNAL_DELAY
+#define MAIL_JOURNAL_DELAY            60000
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Journal record
+typedef struct
+{
+  uint16  seq;   // Sequence number, one more than the previous event
+  uint8   type;  // MAIL_EVT_OPEN, MAIL_EVT_CLOSE or MAIL_EVT_DROP
+  uint8   data;  // Event specific data
+  UTCTime time;  // osal_getClock() when the event was logged
+} mailEvt_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Load the journal from SNV. The commit timer sets 'event' for task
+ * 'taskId', which must then call mailJournal_Commit().
+ */
+extern void mailJournal_Init( uint8 taskId, uint16 event );
+
+/*
+ * Set the number of pending events that trigger a commit and the longest
+ * an event waits in RAM (ms, 0 for no limit).
+ */
+extern void mailJournal_SetCommitPolicy( uint8 batch, uint32 delay );
+
+/*
+ * Append an event to the journal.
+ */
+extern uint16 mailJournal_Log( uint8 type, uint8 data );
+
+/*
+ * Commit the pending events to SNV.
+ */
+extern uint8 mailJournal_Commit( void );
+
+/*
+ * Copy up to 'maxCnt' events logged after 'sinceSeq', oldest first.
+ */
+extern uint8 mailJournal_Read( uint16 sinceSeq, mailEvt_t *pBuf, uint8 maxCnt );
+
+/*
+ * Sequence number of the oldest event still in the journal.
+ */
+extern uint16 mailJournal_FirstSeq( void );
+
+/*
+ * Sequence number of the last event logged.
+ */
+extern uint16 mailJournal_LastSeq( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILJOURNAL_H */
@@ -0,0 +1,253 @@
+/******************************************************************************
+
+ @file  mailSensor.c
+
+ @brief This file contains the mailbox lid and door sensor of the
+        SmartMailBox application.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "OSAL_Clock.h"
+
+#include "mailJournal.h"
+#include "mailSensor.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Unit of the lid open time logged with MAIL_EVT_DROP (ms)
+#define MAIL_SENSOR_LID_UNIT          100
+
+// Journal events read at a time when restoring the mail count
+#define MAIL_SENSOR_READ_EVTS         4
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Switches open at the last KEY_CHANGE
+static uint8 msOpen;
+
+// osal_GetSystemClock() when the lid opened
+static uint32 msLidOpened;
+
+// Mail drops since the door was last opened
+static uint8 msMailCount;
+
+// osal_getClock() at the last event, if msEventSeen
+static UTCTime msLastEvent;
+static uint8 msEventSeen;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void msCountMail( uint8 type );
+
+/*********************************************************************
+ * @fn      msCountMail
+ *
+ * @brief   Follow the mail waiting in the box: a drop adds one, and
+ *          opening the door empties the box.
+ *
+ * @param   type - MAIL_EVT_OPEN, MAIL_EVT_CLOSE or MAIL_EVT_DROP
+ *
+ * @return  none
+ */
+static void msCountMail( uint8 type )
+{
+  if ( type == MAIL_EVT_OPEN )
+  {
+    msMailCount = 0;
+  }
+  else if ( (type == MAIL_EVT_DROP) && (msMailCount < 0xFF) )
+  {
+    msMailCount++;
+  }
+}
+
+/*********************************************************************
+ * @fn      mailSensor_Init
+ *
+ * @brief   Take the current state of the switches without logging
+ *          events, so a reset with the door open does not log an
+ *          opening, and count the mail waiting from the journal,
+ *          which must already be loaded.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void mailSensor_Init( void )
+{
+  mailEvt_t evts[MAIL_SENSOR_READ_EVTS];
+  uint16 seq = mailJournal_FirstSeq() - 1;
+  uint8 num;
+
+  msOpen = HalKeyRead() & HAL_KEY_MAIL;
+  msLidOpened = osal_GetSystemClock();
+
+  msMailCount = 0;
+  msEventSeen = FALSE;
+
+  while ( (num = mailJournal_Read( seq, evts, MAIL_SENSOR_READ_EVTS )) != 0 )
+  {
+    uint8 idx;
+
+    for ( idx = 0; idx < num; idx++ )
+    {
+      msCountMail( evts[idx].type );
+    }
+
+    seq = evts[num - 1].seq;
+  }
+}
+
+/*********************************************************************
+ * @fn      mailSensor_HandleKeys
+ *
+ * @brief   Log the changes of the switches in the mail journal: an
+ *          opening and closing of the door, and a mail drop once the
+ *          lid closes, with how long it was open.
+ *
+ * @param   keys - keys from the KEY_CHANGE message or HalKeyRead()
+ *
+ * @return  TRUE if a switch changed, FALSE otherwise
+ */
+uint8 mailSensor_HandleKeys( uint8 keys )
+{
+  uint8 changed;
+
+  keys &= HAL_KEY_MAIL;
+  changed = keys ^ msOpen;
+
+  if ( changed & HAL_KEY_MAIL_DOOR )
+  {
+    uint8 type = (keys & HAL_KEY_MAIL_DOOR) ? MAIL_EVT_OPEN : MAIL_EVT_CLOSE;
+
+    VOID mailJournal_Log( type, 0 );
+    msCountMail( type );
+  }
+
+  if ( changed & HAL_KEY_MAIL_LID )
+  {
+    if ( keys & HAL_KEY_MAIL_LID )
+    {
+      msLidOpened = osal_GetSystemClock();
+    }
+    else
+    {
+      uint32 open = (osal_GetSystemClock() - msLidOpened) / MAIL_SENSOR_LID_UNIT;
+
+      VOID mailJournal_Log( MAIL_EVT_DROP, (open > 0xFF) ? 0xFF : (uint8)open );
+      msCountMail( MAIL_EVT_DROP );
+    }
+  }
+
+  if ( changed )
+  {
+    msLastEvent = osal_getClock();
+    msEventSeen = TRUE;
+  }
+
+  msOpen = keys;
+
+  return ( changed != 0 );
+}
+
+/*********************************************************************
+ * @fn      mailSensor_Pending
+ *
+ * @brief   Check whether the lid or the door is open.
+ *
+ * @param   none
+ *
+ * @return  TRUE while the lid or the door is open, FALSE otherwise
+ */
+uint8 mailSensor_Pending( void )
+{
+  return ( msOpen != 0 );
+}
+
+/*********************************************************************
+ * @fn      mailSensor_MailCount
+ *
+ * @brief   Get the mail drops since the door was last opened.
+ *
+ * @param   none
+ *
+ * @return  Number of drops, at most 255.
+ */
+uint8 mailSensor_MailCount( void )
+{
+  return ( msMailCount );
+}
+
+/*********************************************************************
+ * @fn      mailSensor_LastEventAge
+ *
+ * @brief   Get the time since the last lid or door event. Events from
+ *          before a reset are not counted, as the clock restarts.
+ *
+ * @param   none
+ *
+ * @return  Seconds since the last event, MAIL_SENSOR_AGE_UNKNOWN if
+ *          there was none since the reset.
+ */
+uint32 mailSensor_LastEventAge( void )
+{
+  if ( !msEventSeen )
+  {
+    return ( MAIL_SENSOR_AGE_UNKNOWN );
+  }
+
+  return ( osal_getClock() - msLastEvent );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,116 @@
+/******************************************************************************
+
+ @file  mailSensor.h
+
+ @brief This file contains the mailbox lid and door sensor definitions
+        and prototypes.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2010-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:56
+ *****************************************************************************/
+
+#ifndef MAILSENSOR_H
+#define MAILSENSOR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * The lid and door switches are read by the key driver as HAL_KEY_MAIL_LID
+ * and HAL_KEY_MAIL_DOOR, which interrupt on both edges and are debounced
+ * for HAL_KEY_DEBOUNCE_VALUE ms. The application passes every KEY_CHANGE
+ * to mailSensor_HandleKeys(), which logs door openings and closings and,
+ * when the lid closes, a mail drop in the mail journal. It also counts the
+ * drops since the door was last opened, which is the mail waiting in the
+ * box, and restores that count from the journal after a reset.
+ */
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_key.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Returned by mailSensor_LastEventAge() before the first event
+#define MAIL_SENSOR_AGE_UNKNOWN       0xFFFFFFFF
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Take the current state of the switches without logging events.
+ */
+extern void mailSensor_Init( void );
+
+/*
+ * Log the changes of the switches in a KEY_CHANGE.
+ */
+extern uint8 mailSensor_HandleKeys( uint8 keys );
+
+/*
+ * TRUE while the lid or the door is open.
+ */
+extern uint8 mailSensor_Pending( void );
+
+/*
+ * Mail drops since the door was last opened.
+ */
+extern uint8 mailSensor_MailCount( void );
+
+/*
+ * Seconds since the last lid or door event, MAIL_SENSOR_AGE_UNKNOWN if
+ * there was none since the reset.
+ */
+extern uint32 mailSensor_LastEventAge( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAILSENSOR_H */
@@ -78,6 +78,15 @@
 #include "gapbondmgr.h"
 
 #include "simpleBLEPeripheral.h"
+#include "mailJournal.h"
+#include "mailSensor.h"
+#include "mailAdvert.h"
+#include "mailBeacon.h"
+#include "mailHistory.h"
+
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+  #include "npi.h"
+#endif
 
 #if defined FEATURE_OAD
   #include "oad.h"
@@ -95,9 +104,6 @@
 // How often to perform periodic event
 #define SBP_PERIODIC_EVT_PERIOD                   5000
 
-// What is the advertising interval when device is discoverable (units of 625us, 160=100ms)
-#define DEFAULT_ADVERTISING_INTERVAL          64//80//160
-
 // Limited discoverable mode advertises for 30.72s, and then stops
 // General discoverable mode advertises indefinitely
 
@@ -214,6 +220,11 @@ static uint8 advertData[] =
   LO_UINT16( SIMPLEPROFILE_SERV_UUID ),
   HI_UINT16( SIMPLEPROFILE_SERV_UUID ),
 
+  // mailbox state for gateways that scan passively, kept up to date by
+  // mailBeacon_Update()
+  MAIL_BEACON_AD_LEN,   // length of this data
+  GAP_ADTYPE_MANUFACTURER_SPECIFIC,
+  MAIL_BEACON_AD_INIT
 };
 
 // GAP GATT Attributes
@@ -232,6 +243,10 @@ static void simpleProfileChangeCB( uint8 paramID );
 static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys );
 #endif
 
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+static void simpleBLEPeripheral_HandleMail( uint8 keys );
+#endif
+
 #if (defined HAL_LCD) && (HAL_LCD == TRUE)
 static char *bdAddr2Str ( uint8 *pAddr );
 #endif // (defined HAL_LCD) && (HAL_LCD == TRUE)
@@ -324,15 +339,8 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   // Set the GAP Characteristics
   GGS_SetParameter( GGS_DEVICE_NAME_ATT, GAP_DEVICE_NAME_LEN, attDeviceName );
 
-  // Set advertising interval
-  {
-    uint16 advInt = DEFAULT_ADVERTISING_INTERVAL;
-
-    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MIN, advInt );
-    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MAX, advInt );
-    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MIN, advInt );
-    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MAX, advInt );
-  }
+  // Set advertising interval, which then follows the mailbox activity
+  mailAdvert_Init( simpleBLEPeripheral_TaskID, SBP_ADVERT_STEP_EVT );
 
   // Setup the GAP Bond Manager
   {
@@ -357,6 +365,10 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   VOID OADTarget_AddService();                    // OAD Profile
 #endif
 
+  // Hold notifications that find no buffers until the next connection event
+  VOID GATTServApp_InitNotiQ( simpleBLEPeripheral_TaskID, SBP_NOTI_Q_EVT );
+  mailHistory_Init( simpleBLEPeripheral_TaskID, SBP_NOTI_Q_EVT );
+
   // Setup the SimpleProfile Characteristic Values
   {
     uint8 charValue1 = 1;
@@ -392,7 +404,11 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
 
   P0DIR = 0xFC; // Port 0 pins P0.0 and P0.1 as input (buttons),
                 // all others (P0.2-P0.7) as output
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+  P1DIR = 0xFF & ~(MAIL_LID_BV | MAIL_DOOR_BV); // Port 1 as output but for the mailbox switches
+#else
   P1DIR = 0xFF; // All port 1 pins (P1.0-P1.7) as output
+#endif
   P2DIR = 0x1F; // All port 1 pins (P2.0-P2.4) as output
 
   P0 = 0x03; // All pins on port 0 to low except for P0.0 and P0.1 (buttons)
@@ -418,6 +434,20 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   // Register callback with SimpleGATTprofile
   VOID SimpleProfile_RegisterAppCBs( &simpleBLEPeripheral_SimpleProfileCBs );
 
+  // Load the mail event journal
+  mailJournal_Init( simpleBLEPeripheral_TaskID, SBP_JOURNAL_COMMIT_EVT );
+
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+  // The lid and door switches come in as key changes
+  mailSensor_Init();
+#if !defined( CC2540_MINIDK )
+  RegisterForKeys( simpleBLEPeripheral_TaskID );
+#endif
+#endif
+
+  // Carry the mailbox state in the advertising data
+  mailBeacon_Init( simpleBLEPeripheral_TaskID, SBP_BEACON_EVT, advertData, sizeof( advertData ) );
+
   // Enable clock divide on halt
   // This reduces active current while radio is active and CC254x MCU
   // is halted
@@ -430,6 +460,11 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
 
 #endif // defined ( DC_DC_P0_7 )
 
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+  // Answer the trace dump commands on the NPI port (needs HAL_UART=TRUE)
+  NPI_InitTransport( NPI_DumpCBack );
+#endif
+
   // Setup a delayed profile startup
   osal_set_event( simpleBLEPeripheral_TaskID, SBP_START_DEVICE_EVT );
 
@@ -477,26 +512,74 @@ uint16 SimpleBLEPeripheral_ProcessEvent( uint8 task_id, uint16 events )
     // Start Bond Manager
     VOID GAPBondMgr_Register( &simpleBLEPeripheral_BondMgrCBs );
 
-    // Set timer for first periodic event
-    osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_PERIODIC_EVT, SBP_PERIODIC_EVT_PERIOD );
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+    // The periodic event only runs while the lid or door is open
+    if ( mailSensor_Pending() )
+#endif
+    {
+      // Set timer for first periodic event
+      osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_PERIODIC_EVT, SBP_PERIODIC_EVT_PERIOD );
+    }
 
     return ( events ^ SBP_START_DEVICE_EVT );
   }
 
   if ( events & SBP_PERIODIC_EVT )
   {
+    // Perform periodic application task
+    performPeriodicTask();
+
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+    // Catch a switch edge that was missed while open
+    simpleBLEPeripheral_HandleMail( HalKeyRead() );
+
+    // Restart timer while the lid or door is still open
+    if ( SBP_PERIODIC_EVT_PERIOD && mailSensor_Pending() )
+#else
     // Restart timer
     if ( SBP_PERIODIC_EVT_PERIOD )
+#endif
     {
       osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_PERIODIC_EVT, SBP_PERIODIC_EVT_PERIOD );
     }
 
-    // Perform periodic application task
-    performPeriodicTask();
-
     return (events ^ SBP_PERIODIC_EVT);
   }
 
+  if ( events & SBP_JOURNAL_COMMIT_EVT )
+  {
+    // Commit the mail events waiting in RAM
+    VOID mailJournal_Commit();
+
+    return (events ^ SBP_JOURNAL_COMMIT_EVT);
+  }
+
+  if ( events & SBP_ADVERT_STEP_EVT )
+  {
+    // Step the advertising interval back
+    mailAdvert_ProcessEvent();
+
+    return (events ^ SBP_ADVERT_STEP_EVT);
+  }
+
+  if ( events & SBP_BEACON_EVT )
+  {
+    // Refresh the mailbox state in the advertising data
+    mailBeacon_ProcessEvent();
+
+    return (events ^ SBP_BEACON_EVT);
+  }
+
+  if ( events & SBP_NOTI_Q_EVT )
+  {
+    // A connection event ended; send the notifications held back and
+    // more of the mail history stream
+    GATTServApp_ProcessNotiQ();
+    mailHistory_ProcessEvent();
+
+    return (events ^ SBP_NOTI_Q_EVT);
+  }
+
   // Discard unknown events
   return 0;
 }
@@ -514,12 +597,17 @@ static void simpleBLEPeripheral_ProcessOSALMsg( osal_event_hdr_t *pMsg )
 {
   switch ( pMsg->event )
   {     
-  #if defined( CC2540_MINIDK )
+  #if defined( CC2540_MINIDK ) || ((defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE))
     case KEY_CHANGE:
+    #if defined( CC2540_MINIDK )
       simpleBLEPeripheral_HandleKeys( ((keyChange_t *)pMsg)->state, 
                                       ((keyChange_t *)pMsg)->keys );
+    #endif // #if defined( CC2540_MINIDK )
+    #if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+      simpleBLEPeripheral_HandleMail( ((keyChange_t *)pMsg)->keys );
+    #endif
       break;
-  #endif // #if defined( CC2540_MINIDK )
+  #endif
  
     case GATT_MSG_EVENT:
       // Process GATT message
@@ -554,6 +642,9 @@ static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys )
   if ( keys & HAL_KEY_SW_1 )
   {
     SK_Keys |= SK_KEY_LEFT;
+
+    // Advertise fast for a while
+    mailAdvert_Kick();
   }
 
   if ( keys & HAL_KEY_SW_2 )
@@ -569,23 +660,16 @@ static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys )
     if( gapProfileState != GAPROLE_CONNECTED )
     {
 #endif // PLUS_BROADCASTER
-      uint8 current_adv_enabled_status;
-      uint8 new_adv_enabled_status;
-
-      //Find the current GAP advertisement status
-      GAPRole_GetParameter( GAPROLE_ADVERT_ENABLED, &current_adv_enabled_status );
-
-      if( current_adv_enabled_status == FALSE )
+      //change the GAP advertisement status to opposite of current status,
+      //starting with a fast burst
+      if( mailAdvert_Enabled() )
       {
-        new_adv_enabled_status = TRUE;
+        mailAdvert_Suspend();
       }
       else
       {
-        new_adv_enabled_status = FALSE;
+        mailAdvert_Kick();
       }
-
-      //change the GAP advertisement status to opposite of current status
-      GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &new_adv_enabled_status );
 #ifndef PLUS_BROADCASTER
     }
 #endif // PLUS_BROADCASTER
@@ -597,6 +681,36 @@ static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys )
 }
 #endif // #if defined( CC2540_MINIDK )
 
+#if (defined HAL_KEY_MAIL_SENSOR) && (HAL_KEY_MAIL_SENSOR == TRUE)
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_HandleMail
+ *
+ * @brief   Handles the mailbox lid and door switches. Any change
+ *          starts a fast advertising burst, and the periodic event
+ *          runs only while one of them is open.
+ *
+ * @param   keys - bit field for key events, of which
+ *                 HAL_KEY_MAIL_LID and HAL_KEY_MAIL_DOOR are used
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_HandleMail( uint8 keys )
+{
+  if ( mailSensor_HandleKeys( keys ) )
+  {
+    // Advertise the new state, fast while someone is at the mailbox
+    mailBeacon_Update();
+    mailAdvert_Kick();
+
+    if ( mailSensor_Pending() &&
+         (osal_get_timeoutEx( simpleBLEPeripheral_TaskID, SBP_PERIODIC_EVT ) == 0) )
+    {
+      osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_PERIODIC_EVT, SBP_PERIODIC_EVT_PERIOD );
+    }
+  }
+}
+#endif
+
 /*********************************************************************
  * @fn      simpleBLEPeripheral_ProcessGATTMsg
  *
@@ -729,12 +843,8 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
         #if (defined HAL_LCD) && (HAL_LCD == TRUE)
           HalLcdWriteString( "Advertising",  HAL_LCD_LINE_3 );
         #endif // (defined HAL_LCD) && (HAL_LCD == TRUE)
-          
-        uint8 advertEnabled = TRUE;
-      
-        // Enabled connectable advertising.
-        GAPRole_SetParameter(GAPROLE_ADVERT_ENABLED, sizeof(uint8),
-                             &advertEnabled);
+
+        // Connectable advertising is enabled again by mailAdvert_StateChange()
       }
       break;
 
@@ -769,6 +879,16 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
 
   }
 
+  // Let the advertising policy follow connections and restarts
+  mailAdvert_StateChange( newState );
+
+  // Advertise mailbox state changes held back during a connection
+  if ( (newState == GAPROLE_WAITING) || (newState == GAPROLE_WAITING_AFTER_TIMEOUT) )
+  {
+    mailHistory_Stop();
+    mailBeacon_Update();
+  }
+
   gapProfileState = newState;
 
 #if !defined( CC2540_MINIDK )
@@ -784,7 +904,8 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
  *
  * @brief   Perform a periodic application task. This function gets
  *          called every five seconds as a result of the SBP_PERIODIC_EVT
- *          OSAL event. In this example, the value of the third
+ *          OSAL event, which with HAL_KEY_MAIL_SENSOR only runs while the
+ *          mailbox lid or door is open. In this example, the value of the third
  *          characteristic in the SimpleGATTProfile service is retrieved
  *          from the profile, and then copied into the value of the
  *          the fourth characteristic.
@@ -846,6 +967,19 @@ static void simpleProfileChangeCB( uint8 paramID )
 
       break;
 
+    case SIMPLEPROFILE_CHAR6:
+      {
+        uint16 startSeq;
+        uint16 connHandle;
+
+        // Stream the mail history to the client from the sequence number
+        SimpleProfile_GetParameter( SIMPLEPROFILE_CHAR6, &startSeq );
+        GAPRole_GetParameter( GAPROLE_CONNHANDLE, &connHandle );
+
+        mailHistory_Start( connHandle, startSeq );
+      }
+      break;
+
     default:
       // should not reach here!
       break;
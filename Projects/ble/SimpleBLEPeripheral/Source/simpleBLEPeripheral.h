@@ -66,6 +66,10 @@ extern "C"
 // Simple BLE Peripheral Task Events
 #define SBP_START_DEVICE_EVT                              0x0001
 #define SBP_PERIODIC_EVT                                  0x0002
+#define SBP_JOURNAL_COMMIT_EVT                            0x0004
+#define SBP_ADVERT_STEP_EVT                               0x0008
+#define SBP_BEACON_EVT                                    0x0010
+#define SBP_NOTI_Q_EVT                                    0x0020
 
 /*********************************************************************
  * MACROS
@@ -291,8 +291,10 @@ void OnBoard_KeyCallback ( uint8 keys, uint8 state )
   }
 
   /* If any key is currently pressed down and interrupt
-     is still enabled, disable interrupt and switch to polling */
-  if( keys != 0 )
+     is still enabled, disable interrupt and switch to polling.
+     The mailbox switches interrupt on both edges, so an open
+     lid or door does not need polling. */
+  if( (keys & ~HAL_KEY_MAIL) != 0 )
   {
     if( OnboardKeyIntEnable == HAL_KEY_INTERRUPT_ENABLE )
     {
@@ -324,6 +326,11 @@ void OnBoard_KeyCallback ( uint8 keys, uint8 state )
  *********************************************************************/
 __near_func void Onboard_soft_reset( void )
 {
+#if OSAL_SNV_WRITE_BACK
+  // Don't lose the items still held in the SNV write-back cache
+  (void)osal_snv_flush();
+#endif
+
   HAL_DISABLE_INTERRUPTS();
   asm("LJMP 0x0");
 }
@@ -52,6 +52,7 @@
 #include "hal_mcu.h"
 #include "hal_sleep.h"
 #include "osal.h"
+#include "osal_snv.h"
 
 /*********************************************************************
  */
@@ -112,8 +113,11 @@ extern void _itoa(uint16 num, uint8 *buf, uint8 radix);
 /* system restart and boot loader used from MTEL.c */
 // Restart system from absolute beginning
 // Disables interrupts, forces WatchDog reset
+// Writes the SNV write-back cache to flash first
 #if _lint
   #define SystemReset()
+#elif OSAL_SNV_WRITE_BACK
+  #define SystemReset()      st( (void)osal_snv_flush(); HAL_SYSTEM_RESET(); )
 #else
   #define SystemReset()      HAL_SYSTEM_RESET();
 #endif
@@ -0,0 +1,298 @@
+/******************************************************************************
+
+ @file  OnBoard.c
+
+ @brief Board support for the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+
+#include "OnBoard.h"
+#include "OSAL.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define NO_TASK_ID 0xFF
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+uint8 OnboardKeyIntEnable;
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Seed of the deterministic random number generator.
+static uint32 onboardRandSeed = 1;
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+// Registered keys task ID, initialized to NOT USED.
+static uint8 registeredKeysTaskID = NO_TASK_ID;
+#endif
+
+/*********************************************************************
+ * @fn      InitBoard()
+ * @brief   Initialize the simulated board.
+ * @return  none
+ */
+void InitBoard( uint8 level )
+{
+  if ( level == OB_COLD )
+  {
+    onboardRandSeed = 1;
+  }
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+  else  // !OB_COLD
+  {
+    /* Initialize Key stuff */
+    OnboardKeyIntEnable = HAL_KEY_INTERRUPT_ENABLE;
+    HalKeyConfig( OnboardKeyIntEnable, OnBoard_KeyCallback );
+  }
+#endif
+}
+
+/*********************************************************************
+ * @fn        Onboard_rand
+ *
+ * @brief    Deterministic random number generator, so that simulation
+ *           runs are repeatable.
+ *
+ * @param   none
+ *
+ * @return  uint16 - new random number
+ */
+uint16 Onboard_rand( void )
+{
+  onboardRandSeed = (onboardRandSeed * 1103515245) + 12345;
+
+  return ( (uint16)(onboardRandSeed >> 16) );
+}
+
+/*********************************************************************
+ * @fn      TimerElapsed
+ *
+ * @brief   The host has no OSAL hardware timer; time comes from
+ *          ll_McuPrecisionCount() via osalTimeUpdate().
+ *
+ * @return  0
+ */
+uint32 TimerElapsed( void )
+{
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      _itoa
+ *
+ * @brief   convert a 16bit number to ASCII
+ *
+ * @param   num -
+ *          buf -
+ *          radix -
+ *
+ * @return  void
+ *
+ *********************************************************************/
+void _itoa(uint16 num, uint8 *buf, uint8 radix)
+{
+  char c,i;
+  uint8 *p, rst[5];
+
+  p = rst;
+  for ( i=0; i<5; i++,p++ )
+  {
+    c = num % radix;  // Isolate a digit
+    *p = c + (( c < 10 ) ? '0' : '7');  // Convert to Ascii
+    num /= radix;
+    if ( !num )
+      break;
+  }
+
+  for ( c=0 ; c<=i; c++ )
+    *buf++ = *p--;  // Reverse character order
+
+  *buf = '\0';
+}
+
+/*********************************************************************
+ * @fn      ltoa
+ *
+ * @brief   convert a 32bit number to ASCII (decimal or hexadecimal)
+ *
+ * @param   l - number to convert
+ *          buf - buffer of at least 11 bytes
+ *          radix - 10 or 16
+ *
+ * @return  buf
+ *
+ *********************************************************************/
+char *ltoa(uint32 l, uint8 *buf, uint8 radix)
+{
+  (void)sprintf( (char *)buf, (radix == 16) ? "%X" : "%u", l );
+
+  return ( (char *)buf );
+}
+
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+/*********************************************************************
+ *                        "Keyboard" Support
+ *********************************************************************/
+
+/*********************************************************************
+ * Keyboard Register function
+ *
+ * The keyboard handler is setup to send all keyboard changes to
+ * one task (if a task is registered).
+ *********************************************************************/
+uint8 RegisterForKeys( uint8 task_id )
+{
+  // Allow only the first task
+  if ( registeredKeysTaskID == NO_TASK_ID )
+  {
+    registeredKeysTaskID = task_id;
+    return ( true );
+  }
+  else
+    return ( false );
+}
+
+/*********************************************************************
+ * @fn      OnBoard_SendKeys
+ *
+ * @brief   Send "Key Pressed" message to application.
+ *
+ * @param   keys  - keys that were pressed
+ *          state - shifted
+ *
+ * @return  status
+ *********************************************************************/
+uint8 OnBoard_SendKeys( uint8 keys, uint8 state )
+{
+  keyChange_t *msgPtr;
+
+  if ( registeredKeysTaskID != NO_TASK_ID )
+  {
+    // Send the address to the task
+    msgPtr = (keyChange_t *)osal_msg_allocate( sizeof(keyChange_t) );
+    if ( msgPtr )
+    {
+      msgPtr->hdr.event = KEY_CHANGE;
+      msgPtr->state = state;
+      msgPtr->keys = keys;
+
+      osal_msg_send( registeredKeysTaskID, (uint8 *)msgPtr );
+    }
+    return ( SUCCESS );
+  }
+  else
+    return ( FAILURE );
+}
+
+/*********************************************************************
+ * @fn      OnBoard_KeyCallback
+ *
+ * @brief   Callback service for keys, switching between interrupts
+ *          and polling as the CC2540 board does.
+ *
+ * @param   keys  - keys that were pressed
+ *          state - shifted
+ *
+ * @return  void
+ *********************************************************************/
+void OnBoard_KeyCallback ( uint8 keys, uint8 state )
+{
+  (void)state;
+
+  (void)OnBoard_SendKeys( keys, false );
+
+  /* Poll while a key other than the mailbox switches is pressed */
+  if ( (keys & ~HAL_KEY_MAIL) != 0 )
+  {
+    if ( OnboardKeyIntEnable == HAL_KEY_INTERRUPT_ENABLE )
+    {
+      OnboardKeyIntEnable = HAL_KEY_INTERRUPT_DISABLE;
+      HalKeyConfig( OnboardKeyIntEnable, OnBoard_KeyCallback );
+    }
+  }
+  else
+  {
+    if ( OnboardKeyIntEnable == HAL_KEY_INTERRUPT_DISABLE )
+    {
+      OnboardKeyIntEnable = HAL_KEY_INTERRUPT_ENABLE;
+      HalKeyConfig( OnboardKeyIntEnable, OnBoard_KeyCallback );
+    }
+  }
+}
+#endif
+
+/*********************************************************************
+ * @fn      Onboard_soft_reset
+ *
+ * @brief   Effect a soft reset, which terminates the simulation.
+ *
+ * @param   none
+ *
+ * @return  none
+ *
+ *********************************************************************/
+void Onboard_soft_reset( void )
+{
+#if OSAL_SNV_WRITE_BACK
+  // Don't lose the items still held in the SNV write-back cache
+  (void)osal_snv_flush();
+#endif
+
+  HAL_SYSTEM_RESET();
+}
+
+/*********************************************************************
+*********************************************************************/
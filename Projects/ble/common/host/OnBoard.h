@@ -0,0 +1,153 @@
+/******************************************************************************
+
+ @file  OnBoard.h
+
+ @brief Board definitions for the host (Linux/GCC) simulation target.
+
+ Group: WCS, BTS
+ Target Device: Host (Linux)
+
+ ******************************************************************************
+ 
+ Copyright (c) 2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.5.1.1
+ Release Date: 2020-01-30 19:28:55
+ *****************************************************************************/
+
+#ifndef ONBOARD_H
+#define ONBOARD_H
+
+#include "hal_mcu.h"
+#include "hal_sleep.h"
+#include "hal_key.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+
+/*********************************************************************
+ */
+
+// Internal (MCU) heap size
+#if !defined( INT_HEAP_LEN )
+  #define INT_HEAP_LEN  3072  // Default CC2540 BLE application heap
+#endif
+
+// Memory Allocation Heap
+#define MAXMEMHEAP INT_HEAP_LEN
+
+// Initialization levels
+#define OB_COLD  0
+#define OB_WARM  1
+#define OB_READY 2
+
+#define SystemResetSoft()  Onboard_soft_reset()
+
+typedef struct
+{
+  osal_event_hdr_t hdr;
+  uint8             state; // shift
+  uint8             keys;  // keys
+} keyChange_t;
+
+// Timer clock and power-saving definitions
+#define TIMER_DECR_TIME    1  // 1ms - has to be matched with TC_OCC
+#define RETUNE_THRESHOLD   1  // Threshold for power saving algorithm
+
+/* OSAL timer defines */
+#define TICK_TIME   1000   /* Timer per tick - in micro-sec */
+#define TICK_COUNT  1
+
+extern void _itoa(uint16 num, uint8 *buf, uint8 radix);
+
+/* glibc has no ltoa(), which OSAL's _ltoa() uses with GCC */
+extern char *ltoa(uint32 l, uint8 *buf, uint8 radix);
+
+/* system restart, writing the SNV write-back cache to flash first */
+#if OSAL_SNV_WRITE_BACK
+  #define SystemReset()      st( (void)osal_snv_flush(); HAL_SYSTEM_RESET(); )
+#else
+  #define SystemReset()      HAL_SYSTEM_RESET();
+#endif
+
+#define BootLoader()
+
+/* Reset reason for reset indication */
+#define ResetReason()      0
+
+/* sleep macros required by OSAL_PwrMgr.c */
+#define SLEEP_DEEP                  0             /* value not used */
+#define SLEEP_LITE                  0             /* value not used */
+#define MIN_SLEEP_TIME              14            /* minimum time to sleep */
+#define OSAL_SET_CPU_INTO_SLEEP(m)  halSleep(m)   /* interface to simulated sleep */
+
+/*
+ * Board specific random number generator
+ */
+extern uint16 Onboard_rand( void );
+
+/*
+ * Get elapsed timer clock counts
+ */
+extern uint32 TimerElapsed( void );
+
+/*
+ * Initialize the Peripherals
+ *    level: 0=cold, 1=warm, 2=ready
+ */
+extern void InitBoard( uint8 level );
+
+/*
+ * Register for all key events (HAL_KEY builds)
+ */
+extern uint8 RegisterForKeys( uint8 task_id );
+
+/*
+ * Send "Key Pressed" message to application
+ */
+extern uint8 OnBoard_SendKeys( uint8 keys, uint8 shift );
+
+/*
+ * Callback routine to handle keys
+ */
+extern void OnBoard_KeyCallback( uint8 keys, uint8 state );
+
+/*
+ * Perform a soft reset
+ */
+extern void Onboard_soft_reset( void );
+
+
+/*********************************************************************
+ */
+
+#endif
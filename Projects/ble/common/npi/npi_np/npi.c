@@ -56,6 +56,8 @@
 #include "hal_types.h"
 #include "hal_board.h"
 #include "npi.h"
+#include "bcomdef.h"
+#include "OSAL_Tasks.h"
 
 /*******************************************************************************
  * MACROS
@@ -73,6 +75,26 @@
  * LOCAL VARIABLES
  */
 
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+// HCI command packet header received so far, and the number of its
+// parameter bytes still to be discarded.
+static uint8 npiCmdHdr[NPI_HCI_CMD_HDR_LEN];
+static uint8 npiCmdHdrLen = 0;
+static uint8 npiCmdSkip = 0;
+
+// Opcode of the dump in progress, zero if none.
+static uint16 npiDumpCmd = 0;
+
+// Dump event packet built but not yet accepted by the transport.
+static uint8 npiDumpBuf[NPI_DUMP_HDR_LEN + NPI_DUMP_DATA_LEN];
+static uint8 npiDumpLen = 0;
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+// Next task whose statistics the task statistics dump takes.
+static uint8 npiTaskStatsNext = 0;
+#endif
+
 /*******************************************************************************
  * GLOBAL VARIABLES
  */
@@ -81,6 +103,15 @@
  * PROTOTYPES
  */
 
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+static uint8 npiReadCmd( void );
+static void  npiBuildDumpEvent( void );
+static void  npiRunDump( void );
+#endif
+#if ( OSAL_EVENT_TRACE )
+static uint8 npiReadTaskStats( uint8 *buf );
+#endif
+
 /*******************************************************************************
  * FUNCTIONS
  */
@@ -233,5 +264,264 @@ uint16 NPI_GetMaxTxBufSize( void )
 }
 
 
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+/*******************************************************************************
+ * @fn          NPI_DumpCBack
+ *
+ * @brief       This routine is the transport callback of a port that serves
+ *              the trace dumps, to be passed to NPI_InitTransport(). It reads
+ *              the HCI vendor specific commands NPI_DUMP_*_CMD and answers
+ *              each with the dump framed in NPI_DUMP_EVENT events (see npi.h).
+ *              Commands are taken one at a time; an event the transport
+ *              doesn't accept is sent again when its transmit buffer empties.
+ *
+ * input parameters
+ *
+ * @param       port  - UART port.
+ * @param       event - UART event.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None.
+ */
+void NPI_DumpCBack( uint8 port, uint8 event )
+{
+  (void)port;
+  (void)event;
+
+  npiRunDump();
+}
+
+
+/*******************************************************************************
+ * @fn          npiRunDump
+ *
+ * @brief       This routine writes the dump events to the transport until it
+ *              stops accepting them or no command is left to answer.
+ *
+ * input parameters
+ *
+ * @param       None.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None.
+ */
+static void npiRunDump( void )
+{
+  for (;;)
+  {
+    if ( npiDumpLen != 0 )
+    {
+      // The transport writes all or none of the event.
+      if ( NPI_WriteTransport( npiDumpBuf, npiDumpLen ) == 0 )
+      {
+        return;
+      }
+
+      npiDumpLen = 0;
+    }
+
+    if ( (npiDumpCmd == 0) && !npiReadCmd() )
+    {
+      return;
+    }
+
+    npiBuildDumpEvent();
+  }
+}
+
+
+/*******************************************************************************
+ * @fn          npiReadCmd
+ *
+ * @brief       This routine reads received bytes until a whole HCI command
+ *              packet is in, and makes its opcode the dump in progress. Bytes
+ *              outside of a command packet are dropped.
+ *
+ * input parameters
+ *
+ * @param       None.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      Returns TRUE if a command was read.
+ */
+static uint8 npiReadCmd( void )
+{
+  uint8 b;
+
+  while ( NPI_ReadTransport( &b, 1 ) == 1 )
+  {
+    if ( npiCmdSkip != 0 )
+    {
+      npiCmdSkip--;
+    }
+    else if ( (npiCmdHdrLen != 0) || (b == NPI_HCI_CMD_PACKET) )
+    {
+      npiCmdHdr[npiCmdHdrLen++] = b;
+
+      if ( npiCmdHdrLen == NPI_HCI_CMD_HDR_LEN )
+      {
+        npiCmdHdrLen = 0;
+        npiCmdSkip = npiCmdHdr[3];
+        npiDumpCmd = BUILD_UINT16( npiCmdHdr[1], npiCmdHdr[2] );
+      }
+    }
+
+    if ( (npiDumpCmd != 0) && (npiCmdSkip == 0) )
+    {
+      return( TRUE );
+    }
+  }
+
+  return( FALSE );
+}
+
+
+/*******************************************************************************
+ * @fn          npiBuildDumpEvent
+ *
+ * @brief       This routine builds the next event of the dump in progress,
+ *              and ends the dump with the event that takes its last record.
+ *
+ * input parameters
+ *
+ * @param       None.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None.
+ */
+static void npiBuildDumpEvent( void )
+{
+  uint8 *pData = npiDumpBuf + NPI_DUMP_HDR_LEN;
+  uint8 status = SUCCESS;
+  uint8 len = 0;
+
+  switch ( npiDumpCmd )
+  {
+#if ( OSALMEM_TRACE )
+    case NPI_DUMP_HEAP_TRACE_CMD:
+      len = (uint8)osal_mem_trace_read( pData, NPI_DUMP_DATA_LEN );
+
+      // A full event may leave records behind.
+      if ( len > NPI_DUMP_DATA_LEN - OSALMEM_TRACE_REC_SZ )
+      {
+        status = blePending;
+      }
+      break;
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+    case NPI_DUMP_EVENT_TRACE_CMD:
+      len = (uint8)osal_event_trace_read( pData, NPI_DUMP_DATA_LEN );
+
+      // A full event may leave records behind.
+      if ( len > NPI_DUMP_DATA_LEN - OSAL_EVENT_TRACE_REC_SZ )
+      {
+        status = blePending;
+      }
+      break;
+
+    case NPI_DUMP_TASK_STATS_CMD:
+      while ( (npiTaskStatsNext < tasksCnt) &&
+              (len <= NPI_DUMP_DATA_LEN - NPI_TASK_STATS_REC_SZ) )
+      {
+        len += npiReadTaskStats( pData + len );
+      }
+
+      if ( npiTaskStatsNext < tasksCnt )
+      {
+        status = blePending;
+      }
+      else
+      {
+        npiTaskStatsNext = 0;
+      }
+      break;
+#endif
+
+    default:
+      status = INVALIDPARAMETER;
+      break;
+  }
+
+  npiDumpBuf[0] = NPI_HCI_EVENT_PACKET;
+  npiDumpBuf[1] = NPI_HCI_VE_EVENT_CODE;
+  npiDumpBuf[2] = NPI_DUMP_HDR_LEN - 3 + len;
+  npiDumpBuf[3] = LO_UINT16( NPI_DUMP_EVENT );
+  npiDumpBuf[4] = HI_UINT16( NPI_DUMP_EVENT );
+  npiDumpBuf[5] = status;
+  npiDumpBuf[6] = LO_UINT16( npiDumpCmd );
+  npiDumpBuf[7] = HI_UINT16( npiDumpCmd );
+
+  npiDumpLen = NPI_DUMP_HDR_LEN + len;
+
+  if ( status != blePending )
+  {
+    npiDumpCmd = 0;
+  }
+}
+#endif
+
+
+#if ( OSAL_EVENT_TRACE )
+/*******************************************************************************
+ * @fn          npiReadTaskStats
+ *
+ * @brief       This routine copies the run time and queueing delay statistics
+ *              of the next task into a task statistics record.
+ *
+ * input parameters
+ *
+ * @param       buf - Pointer to NPI_TASK_STATS_REC_SZ bytes for the record.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      Returns the number of bytes copied, NPI_TASK_STATS_REC_SZ.
+ */
+static uint8 npiReadTaskStats( uint8 *buf )
+{
+  osal_task_stats_t stats;
+  uint8 *p = buf;
+
+  (void)osal_task_stats( npiTaskStatsNext, &stats );
+
+  *p++ = npiTaskStatsNext++;
+  *p++ = LO_UINT16( stats.count );
+  *p++ = HI_UINT16( stats.count );
+  *p++ = LO_UINT16( stats.run.min );
+  *p++ = HI_UINT16( stats.run.min );
+  *p++ = LO_UINT16( stats.run.avg );
+  *p++ = HI_UINT16( stats.run.avg );
+  *p++ = LO_UINT16( stats.run.max );
+  *p++ = HI_UINT16( stats.run.max );
+  *p++ = LO_UINT16( stats.run.p99 );
+  *p++ = HI_UINT16( stats.run.p99 );
+  *p++ = LO_UINT16( stats.wait.min );
+  *p++ = HI_UINT16( stats.wait.min );
+  *p++ = LO_UINT16( stats.wait.avg );
+  *p++ = HI_UINT16( stats.wait.avg );
+  *p++ = LO_UINT16( stats.wait.max );
+  *p++ = HI_UINT16( stats.wait.max );
+  *p++ = LO_UINT16( stats.wait.p99 );
+  *p   = HI_UINT16( stats.wait.p99 );
+
+  return( NPI_TASK_STATS_REC_SZ );
+}
+#endif
+
+
 /*******************************************************************************
  ******************************************************************************/
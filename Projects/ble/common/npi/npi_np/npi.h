@@ -64,6 +64,7 @@ extern "C"
 #include "hal_types.h"
 #include "hal_board.h"
 #include "hal_uart.h"
+#include "OSAL.h"
 
 /*******************************************************************************
  * MACROS
@@ -107,6 +108,48 @@ extern "C"
 #define NPI_UART_BR                    HAL_UART_BR_115200
 #endif // !NPI_UART_BR
 
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+/* Trace dumps of NPI_DumpCBack(). The host asks for a dump with an HCI vendor
+ * specific command packet:
+ *   [0]    NPI_HCI_CMD_PACKET
+ *   [1..2] command opcode, NPI_DUMP_*_CMD, little endian
+ *   [3]    parameter length, parameters are ignored
+ * and gets the dump in one or more HCI vendor specific event packets:
+ *   [0]    NPI_HCI_EVENT_PACKET
+ *   [1]    NPI_HCI_VE_EVENT_CODE
+ *   [2]    length of the rest of the packet
+ *   [3..4] NPI_DUMP_EVENT, little endian
+ *   [5]    status: blePending while more events of the dump follow, SUCCESS
+ *          on its last event, INVALIDPARAMETER for an unknown opcode
+ *   [6..7] command opcode answered, little endian
+ *   [8..]  whole records, up to NPI_DUMP_DATA_LEN bytes
+ */
+#define NPI_HCI_CMD_PACKET             0x01
+#define NPI_HCI_EVENT_PACKET           0x04
+#define NPI_HCI_VE_EVENT_CODE          0xFF
+
+#define NPI_HCI_CMD_HDR_LEN            4
+#define NPI_DUMP_HDR_LEN               8
+#define NPI_DUMP_DATA_LEN              96
+
+#define NPI_DUMP_EVENT                 0x07C0
+
+#define NPI_DUMP_HEAP_TRACE_CMD        0xFFC0  // OSALMEM_TRACE_REC_SZ records
+#define NPI_DUMP_EVENT_TRACE_CMD       0xFFC1  // OSAL_EVENT_TRACE_REC_SZ records
+#define NPI_DUMP_TASK_STATS_CMD        0xFFC2  // NPI_TASK_STATS_REC_SZ records
+#endif
+
+#if ( OSAL_EVENT_TRACE )
+/* Task statistics record of NPI_DUMP_TASK_STATS_CMD, 19 bytes, multi-byte
+ * fields little endian (see osal_task_stats_t):
+ *   [0]      task ID
+ *   [1..2]   count
+ *   [3..10]  run min, avg, max, p99
+ *   [11..18] wait min, avg, max, p99
+ */
+#define NPI_TASK_STATS_REC_SZ          19
+#endif
+
 /*******************************************************************************
  * TYPEDEFS
  */
@@ -135,6 +178,9 @@ extern uint16 NPI_WriteTransport( uint8 *, uint16 );
 extern uint16 NPI_RxBufLen( void );
 extern uint16 NPI_GetMaxRxBufSize( void );
 extern uint16 NPI_GetMaxTxBufSize( void );
+#if ( OSALMEM_TRACE ) || ( OSAL_EVENT_TRACE )
+extern void   NPI_DumpCBack( uint8 port, uint8 event );
+#endif
 
 /*******************************************************************************
 */